@@ -0,0 +1,49 @@
+/*  =========================================================================
+    asset_conversion_binary - asset/conversion/binary
+
+    Copyright (C) 2016 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// message metadata selecting the encoding of asset payloads (JSON when missing)
+static constexpr const char* METADATA_FORMAT        = "FORMAT";
+static constexpr const char* METADATA_FORMAT_BINARY = "BINARY";
+
+// fwd declaration
+namespace fty {
+class Asset;
+} // namespace fty
+
+namespace fty { namespace conversion {
+    // Compact binary encoding of a list of assets:
+    //   header       "FTYA" + format version (1 byte)
+    //   string table count, then each string (keytags, parent and link inames are interned)
+    //   assets       count, then each asset record prefixed with its length
+    // Integers are unsigned LEB128 varints, strings are length-prefixed. Asset type and subtype are coded
+    // with the ids of t_bios_asset_element_type and t_bios_asset_device_type, status with AssetStatus.
+    std::string toBinary(const std::vector<Asset>& assets);
+    std::string toBinary(const Asset& asset);
+
+    // throws std::runtime_error on malformed input
+    std::vector<Asset> fromBinary(const std::string& data);
+    void               fromBinary(const std::string& data, fty::Asset& asset);
+}} // namespace fty::conversion
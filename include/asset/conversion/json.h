@@ -26,9 +26,17 @@
 // fwd declaration
 namespace fty {
 class Asset;
+class AssetLink;
+class ExtMapElement;
 } // namespace fty
 
 namespace fty { namespace conversion {
     std::string toJson(const Asset& asset);
     void        fromJson(const std::string& json, fty::Asset& asset);
+
+    // append to buffer the same output as the cxxtools JSON serializer, without intermediate
+    // cxxtools::SerializationInfo tree
+    void appendJson(std::string& buffer, const Asset& asset);
+    void appendJson(std::string& buffer, const AssetLink& link);
+    void appendJson(std::string& buffer, const ExtMapElement& element);
 }} // namespace fty::conversion
@@ -273,6 +273,7 @@ public:
     void setExtEntry(const std::string& key, const std::string& value, bool readOnly = false);
     void setLinkedAssets(const std::vector<AssetLink>& assets);
     void setSecondaryID(const std::string& secondaryID);
+    void setParentsList(const std::vector<Asset>& parentsList);
     // dump
     void dump(std::ostream& os);
 
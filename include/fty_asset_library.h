@@ -95,6 +95,8 @@ typedef struct _fty_asset_dto_t fty_asset_dto_t;
 #define FTY_ASSET_DTO_T_DEFINED
 typedef struct _asset_conversion_json_t asset_conversion_json_t;
 #define ASSET_CONVERSION_JSON_T_DEFINED
+typedef struct _asset_conversion_binary_t asset_conversion_binary_t;
+#define ASSET_CONVERSION_BINARY_T_DEFINED
 typedef struct _asset_conversion_proto_t asset_conversion_proto_t;
 #define ASSET_CONVERSION_PROTO_T_DEFINED
 typedef struct _asset_conversion_full_asset_t asset_conversion_full_asset_t;
@@ -107,6 +109,7 @@ typedef struct _asset_conversion_full_asset_t asset_conversion_full_asset_t;
 #include "fty_asset_inventory.h"
 #include "fty_asset_dto.h"
 #include "asset/conversion/json.h"
+#include "asset/conversion/binary.h"
 #include "asset/conversion/proto.h"
 #include "asset/conversion/full-asset.h"
 
@@ -21,17 +21,28 @@
 
 #include "asset-server.h"
 #include "asset/asset-utils.h"
+#include "include/asset/conversion/binary.h"
 #include "include/asset/conversion/json.h"
 #include "include/fty_asset_dto.h"
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <dirent.h>
+#include <fstream>
 #include <cxxtools/serializationinfo.h>
 #include <fty_common_messagebus.h>
 #include <functional>
+#include <future>
 #include <malamute.h>
 #include <mlm_client.h>
+#include <openssl/sha.h>
 #include <sstream>
 #include <stdlib.h>
+#include <sys/stat.h>
 #include <time.h>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace std::placeholders;
 
@@ -40,6 +51,10 @@ using namespace std::placeholders;
 void send_create_or_update_asset(
     const fty::AssetServer& config, const std::string& asset_name, const char* operation, bool read_only);
 
+// fwd declaration, keeps the resident topology model in sync with local writes
+void refresh_topology_model(const std::string& asset_name);
+void reset_topology_model();
+
 namespace fty {
 // ===========================================================================================================
 
@@ -62,7 +77,11 @@ static V value(const std::map<K, V>& map, const typename identify<K>::type& key,
 
 // ===========================================================================================================
 
-
+// asset payloads of replies are encoded in binary format if requested
+static bool isBinaryFormat(const messagebus::Message& msg)
+{
+    return value(msg.metaData(), METADATA_FORMAT) == METADATA_FORMAT_BINARY;
+}
 
 // ===========================================================================================================
 
@@ -134,6 +153,38 @@ void AssetServer::createPublisherClientNg()
         messagebus::MlmMessageBus(m_mailboxEndpoint, m_agentNameNg + "-delete-light"));
     log_debug("New publisher client registered to endpoint %s with name %s", m_mailboxEndpoint.c_str(),
         (m_agentNameNg + "-delete-light").c_str());
+
+    if (m_binaryNotifications) {
+        createBinaryPublishers();
+    }
+}
+
+void AssetServer::createBinaryPublishers()
+{
+    m_publisherCreateBinary.reset(
+        messagebus::MlmMessageBus(m_mailboxEndpoint, m_agentNameNg + "-create-binary"));
+    log_debug("New publisher client registered to endpoint %s with name %s", m_mailboxEndpoint.c_str(),
+        (m_agentNameNg + "-create-binary").c_str());
+
+    m_publisherUpdateBinary.reset(
+        messagebus::MlmMessageBus(m_mailboxEndpoint, m_agentNameNg + "-update-binary"));
+    log_debug("New publisher client registered to endpoint %s with name %s", m_mailboxEndpoint.c_str(),
+        (m_agentNameNg + "-update-binary").c_str());
+}
+
+void AssetServer::setBinaryNotifications(bool enabled)
+{
+    m_binaryNotifications = enabled;
+
+    if (!enabled) {
+        m_publisherCreateBinary.reset();
+        m_publisherUpdateBinary.reset();
+    } else if (m_publisherCreate && !m_publisherCreateBinary) {
+        // publishers are already connected, add the binary ones
+        createBinaryPublishers();
+        m_publisherCreateBinary->connect();
+        m_publisherUpdateBinary->connect();
+    }
 }
 
 void AssetServer::resetPublisherClientNg()
@@ -144,6 +195,8 @@ void AssetServer::resetPublisherClientNg()
     m_publisherCreateLight.reset();
     m_publisherUpdateLight.reset();
     m_publisherDeleteLight.reset();
+    m_publisherCreateBinary.reset();
+    m_publisherUpdateBinary.reset();
 }
 
 void AssetServer::connectPublisherClientNg()
@@ -154,6 +207,10 @@ void AssetServer::connectPublisherClientNg()
     m_publisherCreateLight->connect();
     m_publisherUpdateLight->connect();
     m_publisherDeleteLight->connect();
+    if (m_binaryNotifications) {
+        m_publisherCreateBinary->connect();
+        m_publisherUpdateBinary->connect();
+    }
 }
 
 // new generation asset manipulation handler
@@ -169,7 +226,8 @@ void AssetServer::handleAssetManipulationReq(const messagebus::Message& msg)
         { FTY_ASSET_SUBJECT_DELETE,       [&](const messagebus::Message& msg){ deleteAsset(msg); } },
         { FTY_ASSET_SUBJECT_GET,          [&](const messagebus::Message& msg){ getAsset(msg); } },
         { FTY_ASSET_SUBJECT_GET_BY_UUID,  [&](const messagebus::Message& msg){ getAsset(msg, true); } },
-        { FTY_ASSET_SUBJECT_LIST,         [&](const messagebus::Message& msg){ listAsset(msg); } }
+        { FTY_ASSET_SUBJECT_LIST,         [&](const messagebus::Message& msg){ listAsset(msg); } },
+        { FTY_ASSET_SUBJECT_GET_LIST,     [&](const messagebus::Message& msg){ getAssetList(msg); } }
     };
     // clang-format on
 
@@ -195,8 +253,13 @@ void AssetServer::handleAssetSrrReq(const messagebus::Message& msg)
         Query    query;
         data >> query;
 
+        // the base of an incremental save comes with the request
+        SrrQueryProcessor processor = m_srrProcessor;
+        processor.saveHandler =
+            std::bind(&AssetServer::handleSave, this, _1, value(msg.metaData(), METADATA_SRR_BASE));
+
         messagebus::UserData respData;
-        respData << (m_srrProcessor.processQuery(query));
+        respData << (processor.processQuery(query));
 
         auto response = assetutils::createMessage(msg.metaData().find(messagebus::Message::SUBJECT)->second,
             msg.metaData().find(messagebus::Message::CORRELATION_ID)->second, m_srrAgentName,
@@ -213,7 +276,7 @@ void AssetServer::handleAssetSrrReq(const messagebus::Message& msg)
     }
 }
 
-dto::srr::SaveResponse AssetServer::handleSave(const dto::srr::SaveQuery& query)
+dto::srr::SaveResponse AssetServer::handleSave(const dto::srr::SaveQuery& query, const std::string& base)
 {
     using namespace dto;
     using namespace dto::srr;
@@ -227,10 +290,12 @@ dto::srr::SaveResponse AssetServer::handleSave(const dto::srr::SaveQuery& query)
 
 
         if (featureName == FTY_ASSET_SRR_NAME) {
-            f1.set_version(SRR_ACTIVE_VERSION);
+            f1.set_version(m_srrVersion);
             try {
                 std::unique_lock<std::mutex> lock(m_srrLock);
-                f1.set_data(assetutils::serialize(saveAssets()));
+                std::stringstream data;
+                saveAssets(data, m_srrVersion, base);
+                f1.set_data(data.str());
                 fs1.mutable_status()->set_status(Status::SUCCESS);
             } catch (std::exception& e) {
                 fs1.mutable_status()->set_status(Status::FAILED);
@@ -268,11 +333,20 @@ dto::srr::RestoreResponse AssetServer::handleRestore(const dto::srr::RestoreQuer
             try {
                 std::unique_lock<std::mutex> lock(m_srrLock);
 
-                cxxtools::SerializationInfo si = assetutils::deserialize(feature.data());
-                log_debug("Si=\n%s", feature.data().c_str());
-                // clear database
-                AssetImpl::deleteAll();
-                restoreAssets(si);
+                if (feature.version() == SRR_COMPACT_VERSION) {
+                    std::istringstream data(feature.data());
+                    // clear database
+                    AssetImpl::deleteAll();
+                    m_jsonCache.clear();
+                    restoreAssets(data);
+                } else {
+                    cxxtools::SerializationInfo si = assetutils::deserialize(feature.data());
+                    log_debug("Si=\n%s", feature.data().c_str());
+                    // clear database
+                    AssetImpl::deleteAll();
+                    m_jsonCache.clear();
+                    restoreAssets(si);
+                }
 
                 featureStatus.set_status(Status::SUCCESS);
             } catch (std::exception& e) {
@@ -283,6 +357,8 @@ dto::srr::RestoreResponse AssetServer::handleRestore(const dto::srr::RestoreQuer
                 featureStatus.set_status(Status::FAILED);
                 featureStatus.set_error(e.what());
             }
+            // the tables were rewritten, by the restored assets or by the backup
+            reset_topology_model();
 
         } else {
             featureStatus.set_status(Status::FAILED);
@@ -303,12 +379,52 @@ dto::srr::ResetResponse AssetServer::handleReset(const dto::srr::ResetQuery& que
     log_debug("Reset assets");
     std::map<FeatureName, FeatureStatus> mapStatus;
 
-    const FeatureName& featureName = FTY_ASSET_SRR_NAME;
-    FeatureStatus      featureStatus;
-    featureStatus.set_status(Status::FAILED);
-    featureStatus.set_error("Feature is not supported!");
+    for (const auto& featureName : query.features()) {
+        FeatureStatus featureStatus;
+
+        if (featureName == FTY_ASSET_SRR_NAME) {
+            std::unique_lock<std::mutex> lock(m_srrLock);
+
+            DeleteStatus deleted = AssetImpl::deleteAll();
+
+            std::vector<std::string> assetsJson;
+            std::vector<std::string> inames;
+            std::string              error;
+            for (const auto& status : deleted) {
+                if (status.second != "OK") {
+                    error = status.second;
+                    continue;
+                }
+                assetsJson.push_back(m_jsonCache.toJson(status.first));
+                inames.push_back(status.first.getInternalName());
+            }
+            m_jsonCache.clear();
 
-    mapStatus[featureName] = featureStatus;
+            if (error.empty()) {
+                featureStatus.set_status(Status::SUCCESS);
+            } else {
+                featureStatus.set_status(Status::FAILED);
+                featureStatus.set_error(error);
+            }
+
+            // one notification for all the deleted assets, one frame per asset
+            if (!inames.empty()) {
+                m_publisherDelete->publish(FTY_ASSET_TOPIC_DELETED,
+                    assetutils::createMessage(
+                        FTY_ASSET_SUBJECT_DELETED, "", m_agentNameNg, "", messagebus::STATUS_OK, assetsJson));
+                m_publisherDeleteLight->publish(FTY_ASSET_TOPIC_DELETED_L,
+                    assetutils::createMessage(
+                        FTY_ASSET_SUBJECT_DELETED_L, "", m_agentNameNg, "", messagebus::STATUS_OK, inames));
+                reset_topology_model();
+            }
+            log_debug("Reset removed %zu assets", inames.size());
+        } else {
+            featureStatus.set_status(Status::FAILED);
+            featureStatus.set_error("Feature is not supported!");
+        }
+
+        mapStatus[featureName] = featureStatus;
+    }
 
     return (createResetResponse(mapStatus)).reset();
 }
@@ -325,6 +441,7 @@ void AssetServer::sendNotification(const messagebus::Message& msg) const
         // old interface
         fty::Asset asset;
         fty::conversion::fromJson(msg.userData().back(), asset);
+        refresh_topology_model(asset.getInternalName());
         send_create_or_update_asset(
             *this, asset.getInternalName(), "create", false /* read_only is not used */);
     } else if (subject == FTY_ASSET_SUBJECT_UPDATED) {
@@ -339,16 +456,25 @@ void AssetServer::sendNotification(const messagebus::Message& msg) const
         // old interface replies only with updated asset
         after >>= asset;
 
+        refresh_topology_model(asset.getInternalName());
         send_create_or_update_asset(
             *this, asset.getInternalName(), "update", false /* read_only is not used */);
     } else if (subject == FTY_ASSET_SUBJECT_DELETED) {
         m_publisherDelete->publish(FTY_ASSET_TOPIC_DELETED, msg);
+
+        fty::Asset asset;
+        fty::conversion::fromJson(msg.userData().back(), asset);
+        refresh_topology_model(asset.getInternalName());
     } else if (subject == FTY_ASSET_SUBJECT_CREATED_L) {
         m_publisherCreateLight->publish(FTY_ASSET_TOPIC_CREATED_L, msg);
     } else if (subject == FTY_ASSET_SUBJECT_UPDATED_L) {
         m_publisherUpdateLight->publish(FTY_ASSET_TOPIC_UPDATED_L, msg);
     } else if (subject == FTY_ASSET_SUBJECT_DELETED_L) {
         m_publisherDeleteLight->publish(FTY_ASSET_TOPIC_DELETED_L, msg);
+    } else if (subject == FTY_ASSET_SUBJECT_CREATED_B && m_publisherCreateBinary) {
+        m_publisherCreateBinary->publish(FTY_ASSET_TOPIC_CREATED_B, msg);
+    } else if (subject == FTY_ASSET_SUBJECT_UPDATED_B && m_publisherUpdateBinary) {
+        m_publisherUpdateBinary->publish(FTY_ASSET_TOPIC_UPDATED_B, msg);
     }
 }
 
@@ -360,7 +486,7 @@ void AssetServer::initSrr(const std::string& queue)
 
     m_srrClient->connect();
 
-    m_srrProcessor.saveHandler    = std::bind(&AssetServer::handleSave, this, _1);
+    m_srrProcessor.saveHandler    = std::bind(&AssetServer::handleSave, this, _1, std::string());
     m_srrProcessor.restoreHandler = std::bind(&AssetServer::handleRestore, this, _1);
     m_srrProcessor.resetHandler   = std::bind(&AssetServer::handleReset, this, _1);
 
@@ -420,18 +546,19 @@ void AssetServer::createAsset(const messagebus::Message& msg)
         // update asset data
         asset.load();
 
+        const std::string assetJson = m_jsonCache.toJson(asset);
+
         auto response = assetutils::createMessage(FTY_ASSET_SUBJECT_CREATE,
             msg.metaData().find(messagebus::Message::CORRELATION_ID)->second, m_agentNameNg,
-            msg.metaData().find(messagebus::Message::FROM)->second, messagebus::STATUS_OK,
-            fty::conversion::toJson(asset));
+            msg.metaData().find(messagebus::Message::FROM)->second, messagebus::STATUS_OK, assetJson);
 
         // send response
         log_debug("sending response to %s", msg.metaData().find(messagebus::Message::FROM)->second.c_str());
         m_assetMsgQueue->sendReply(msg.metaData().find(messagebus::Message::REPLY_TO)->second, response);
 
         // full notification
-        messagebus::Message notification = assetutils::createMessage(FTY_ASSET_SUBJECT_CREATED, "",
-            m_agentNameNg, "", messagebus::STATUS_OK, fty::conversion::toJson(asset));
+        messagebus::Message notification = assetutils::createMessage(
+            FTY_ASSET_SUBJECT_CREATED, "", m_agentNameNg, "", messagebus::STATUS_OK, assetJson);
         sendNotification(notification);
 
         // light notification
@@ -439,6 +566,14 @@ void AssetServer::createAsset(const messagebus::Message& msg)
             m_agentNameNg, "", messagebus::STATUS_OK, asset.getInternalName());
         sendNotification(notification_l);
 
+        // binary notification
+        if (m_binaryNotifications) {
+            messagebus::Message notification_b = assetutils::createMessage(FTY_ASSET_SUBJECT_CREATED_B, "",
+                m_agentNameNg, "", messagebus::STATUS_OK, fty::conversion::toBinary(asset));
+            notification_b.metaData().emplace(METADATA_FORMAT, METADATA_FORMAT_BINARY);
+            sendNotification(notification_b);
+        }
+
 
     } catch (std::exception& e) {
         log_error(e.what());
@@ -506,48 +641,40 @@ void AssetServer::updateAsset(const messagebus::Message& msg)
         // update data from db
         asset.load();
 
-        // build message
-        // serialization info which contains asset before and after update
-        cxxtools::SerializationInfo si;
-
-        // before update
-        cxxtools::SerializationInfo tmpSi;
-
-        tmpSi <<= currentAsset;
-
-        cxxtools::SerializationInfo& before = si.addMember("");
-        before.setCategory(cxxtools::SerializationInfo::Category::Object);
-        before = tmpSi;
-        before.setName("before");
-
-        // after update
-        tmpSi.clear();
-        tmpSi <<= asset;
-
-        cxxtools::SerializationInfo& after = si.addMember("");
-        after.setCategory(cxxtools::SerializationInfo::Category::Object);
-        after = tmpSi;
-        after.setName("after");
+        // asset before update is served from the cache, asset after update replaces it
+        const std::string beforeJson = m_jsonCache.toJson(currentAsset);
+        m_jsonCache.invalidate(asset.getInternalName());
+        const std::string afterJson = m_jsonCache.toJson(asset);
 
         // create response (ok)
         auto response = assetutils::createMessage(FTY_ASSET_SUBJECT_UPDATE,
             msg.metaData().find(messagebus::Message::CORRELATION_ID)->second, m_agentNameNg,
-            msg.metaData().find(messagebus::Message::FROM)->second, messagebus::STATUS_OK,
-            fty::conversion::toJson(asset));
+            msg.metaData().find(messagebus::Message::FROM)->second, messagebus::STATUS_OK, afterJson);
 
         // send response
         log_debug("sending response to %s", msg.metaData().find(messagebus::Message::FROM)->second.c_str());
         m_assetMsgQueue->sendReply(msg.metaData().find(messagebus::Message::REPLY_TO)->second, response);
 
         // full notification
+        // JSON object which contains asset before and after update
         messagebus::Message notification = assetutils::createMessage(FTY_ASSET_SUBJECT_UPDATED, "",
-            m_agentNameNg, "", messagebus::STATUS_OK, assetutils::serialize(si));
+            m_agentNameNg, "", messagebus::STATUS_OK,
+            "{\"before\":" + beforeJson + ",\"after\":" + afterJson + "}");
         sendNotification(notification);
 
         // light notification
         messagebus::Message notification_l = assetutils::createMessage(FTY_ASSET_SUBJECT_UPDATED_L, "",
             m_agentNameNg, "", messagebus::STATUS_OK, asset.getInternalName());
         sendNotification(notification_l);
+
+        // binary notification: list of two assets, before and after update
+        if (m_binaryNotifications) {
+            messagebus::Message notification_b = assetutils::createMessage(FTY_ASSET_SUBJECT_UPDATED_B, "",
+                m_agentNameNg, "", messagebus::STATUS_OK,
+                fty::conversion::toBinary(std::vector<Asset>{currentAsset, asset}));
+            notification_b.metaData().emplace(METADATA_FORMAT, METADATA_FORMAT_BINARY);
+            sendNotification(notification_b);
+        }
     } catch (const std::exception& e) {
         log_error(e.what());
         // create response (error)
@@ -605,9 +732,12 @@ void AssetServer::deleteAsset(const messagebus::Message& msg)
         // send one notification for each asset deleted
         for (const auto& status : deleted) {
             if (status.second == "OK") {
+                const std::string assetJson = m_jsonCache.toJson(status.first);
+                m_jsonCache.invalidate(status.first.getInternalName());
+
                 // full notification
-                messagebus::Message notification = assetutils::createMessage(FTY_ASSET_SUBJECT_DELETED, "",
-                    m_agentNameNg, "", messagebus::STATUS_OK, fty::conversion::toJson(status.first));
+                messagebus::Message notification = assetutils::createMessage(
+                    FTY_ASSET_SUBJECT_DELETED, "", m_agentNameNg, "", messagebus::STATUS_OK, assetJson);
                 sendNotification(notification);
 
                 // light notification
@@ -644,11 +774,16 @@ void AssetServer::getAsset(const messagebus::Message& msg, bool getFromUuid)
             asset.updateParentsList();
         }
 
+        bool binary = isBinaryFormat(msg);
+
         // create response (ok)
         auto response = assetutils::createMessage(FTY_ASSET_SUBJECT_GET,
             msg.metaData().find(messagebus::Message::CORRELATION_ID)->second, m_agentNameNg,
             msg.metaData().find(messagebus::Message::FROM)->second, messagebus::STATUS_OK,
-            fty::conversion::toJson(asset));
+            binary ? fty::conversion::toBinary(asset) : m_jsonCache.toJson(asset));
+        if (binary) {
+            response.metaData().emplace(METADATA_FORMAT, METADATA_FORMAT_BINARY);
+        }
 
         // send response
         log_debug("sending response to %s", msg.metaData().find(messagebus::Message::FROM)->second.c_str());
@@ -696,31 +831,143 @@ void AssetServer::listAsset(const messagebus::Message& msg)
         }
 
         std::vector<std::string> inameList = fty::AssetImpl::list(filters);
-        cxxtools::SerializationInfo si;
+        std::string              data;
+        bool                     binary = !idOnly && isBinaryFormat(msg);
 
         if (idOnly) {
+            cxxtools::SerializationInfo si;
             si <<= inameList;
+            data = assetutils::serialize(si);
+        } else if (binary) {
+            bool withParentsList = value(msg.metaData(), METADATA_WITH_PARENTS_LIST) == "true";
+
+            std::vector<Asset> assets;
+            assets.reserve(inameList.size());
+            for (const auto& iname : inameList) {
+                try {
+                    fty::AssetImpl asset(iname);
+                    if (withParentsList) {
+                        asset.updateParentsList();
+                    }
+                    assets.push_back(asset);
+                } catch (std::exception& e) {
+                    log_error("Could not retrieve asset %s: %s", iname.c_str(), e.what());
+                }
+            }
+            data = fty::conversion::toBinary(assets);
         } else {
             bool withParentsList = value(msg.metaData(), METADATA_WITH_PARENTS_LIST) == "true";
 
+            // JSON array of cached asset representations
+            data = "[";
             for (const auto& iname : inameList) {
                 try {
                     fty::AssetImpl asset(iname);
                     if (withParentsList) {
                         asset.updateParentsList();
                     }
-                    cxxtools::SerializationInfo& data = si.addMember("");
-                    data <<= asset;
-                    data.setCategory(cxxtools::SerializationInfo::Category::Object);
+                    const std::string assetJson = m_jsonCache.toJson(asset);
+                    if (data.size() > 1) {
+                        data += ",";
+                    }
+                    data += assetJson;
                 } catch (std::exception& e) {
                     log_error("Could not retrieve asset %s: %s", iname.c_str(), e.what());
                 }
             }
-            si.setCategory(cxxtools::SerializationInfo::Category::Array);
+            data += "]";
         }
 
         // create response (ok)
         auto response = assetutils::createMessage(FTY_ASSET_SUBJECT_LIST,
+            msg.metaData().find(messagebus::Message::CORRELATION_ID)->second, m_agentNameNg,
+            msg.metaData().find(messagebus::Message::FROM)->second, messagebus::STATUS_OK, data);
+        if (binary) {
+            response.metaData().emplace(METADATA_FORMAT, METADATA_FORMAT_BINARY);
+        }
+
+        // send response
+        log_debug("sending response to %s", msg.metaData().find(messagebus::Message::FROM)->second.c_str());
+        m_assetMsgQueue->sendReply(msg.metaData().find(messagebus::Message::REPLY_TO)->second, response);
+    } catch (std::exception& e) {
+        log_error(e.what());
+        // create response (error)
+        auto response = assetutils::createMessage(FTY_ASSET_SUBJECT_LIST,
+            msg.metaData().find(messagebus::Message::CORRELATION_ID)->second, m_agentNameNg,
+            msg.metaData().find(messagebus::Message::FROM)->second, messagebus::STATUS_KO,
+            std::string(e.what()));
+
+        // send response
+        log_debug("sending response to %s", msg.metaData().find(messagebus::Message::FROM)->second.c_str());
+        m_assetMsgQueue->sendReply(msg.metaData().find(messagebus::Message::REPLY_TO)->second, response);
+    }
+}
+
+// request:  { "inames": [ "iname", ... ], "uuids": [ "uuid", ... ] } (both members are optional)
+// response: [ { "id": "<requested iname or uuid>", "status": "OK", "asset": { ... } },
+//             { "id": "<requested iname or uuid>", "status": "<error>" }, ... ]
+void AssetServer::getAssetList(const messagebus::Message& msg)
+{
+    log_debug("subject GET_LIST");
+
+    try {
+        std::vector<std::string> inames;
+        std::vector<std::string> uuids;
+
+        if (!msg.userData().empty()) {
+            cxxtools::SerializationInfo si = assetutils::deserialize(msg.userData().front());
+
+            if (si.findMember("inames") != nullptr) {
+                si.getMember("inames") >>= inames;
+            }
+            if (si.findMember("uuids") != nullptr) {
+                si.getMember("uuids") >>= uuids;
+            }
+        }
+
+        bool withParentsList = value(msg.metaData(), METADATA_WITH_PARENTS_LIST) == "true";
+
+        // resolve all uuids at once
+        std::map<std::string, std::string> uuidToIname = AssetImpl::getInamesFromUuids(uuids);
+
+        std::vector<std::string> toLoad = inames;
+        for (const auto& u : uuidToIname) {
+            toLoad.push_back(u.second);
+        }
+
+        std::map<std::string, AssetImpl> loaded;
+        for (const auto& a : AssetImpl::getList(toLoad, withParentsList)) {
+            loaded.emplace(a.getInternalName(), a);
+        }
+
+        cxxtools::SerializationInfo si;
+
+        auto addItem = [&](const std::string& id, const std::string& iname) {
+            cxxtools::SerializationInfo& item = si.addMember("");
+            item.setCategory(cxxtools::SerializationInfo::Category::Object);
+            item.addMember("id") <<= id;
+
+            auto found = loaded.find(iname);
+            if (found != loaded.end()) {
+                item.addMember("status") <<= "OK";
+                item.addMember("asset") <<= found->second;
+            } else {
+                item.addMember("status") <<= "requested asset does not exist";
+            }
+        };
+
+        for (const auto& iname : inames) {
+            addItem(iname, iname);
+        }
+        for (const auto& uuid : uuids) {
+            auto found = uuidToIname.find(uuid);
+            addItem(uuid, found != uuidToIname.end() ? found->second : "");
+        }
+
+        si.setCategory(cxxtools::SerializationInfo::Category::Array);
+
+        // create response (ok)
+        auto response = assetutils::createMessage(FTY_ASSET_SUBJECT_GET_LIST,
             msg.metaData().find(messagebus::Message::CORRELATION_ID)->second, m_agentNameNg,
             msg.metaData().find(messagebus::Message::FROM)->second, messagebus::STATUS_OK,
             assetutils::serialize(si));
@@ -731,7 +978,7 @@ void AssetServer::listAsset(const messagebus::Message& msg)
     } catch (std::exception& e) {
         log_error(e.what());
         // create response (error)
-        auto response = assetutils::createMessage(FTY_ASSET_SUBJECT_LIST,
+        auto response = assetutils::createMessage(FTY_ASSET_SUBJECT_GET_LIST,
             msg.metaData().find(messagebus::Message::CORRELATION_ID)->second, m_agentNameNg,
             msg.metaData().find(messagebus::Message::FROM)->second, messagebus::STATUS_KO,
             std::string(e.what()));
@@ -743,100 +990,445 @@ void AssetServer::listAsset(const messagebus::Message& msg)
 }
 
 // SRR
-cxxtools::SerializationInfo AssetServer::saveAssets()
+// number of assets loaded and serialized by one save worker
+static constexpr size_t SRR_SAVE_BATCH_SIZE = 500;
+// number of batches being loaded at the same time
+static constexpr size_t SRR_SAVE_WORKERS = 4;
+
+static constexpr const char* SRR_COMPACT_HEADER  = "FTY-ASSET-SRR 2.0";
+static constexpr const char* SRR_COMPACT_TRAILER = "END ";
+static constexpr const char* SRR_SNAPSHOT_MARKER = "SNAPSHOT";
+static constexpr const char* SRR_DELTA_MARKER    = "DELTA";
+static constexpr const char* SRR_DELETED_PREFIX  = "DELETED ";
+
+static constexpr const char* SRR_MANIFEST_SUFFIX = ".manifest";
+// first record of the manifest files, a manifest of another version is not a base
+static constexpr const char* SRR_MANIFEST_MAGIC   = "FTY-ASSET-SRR-MANIFEST";
+static constexpr unsigned    SRR_MANIFEST_VERSION = 2;
+// number of saves which can be the base of an incremental save
+static constexpr size_t SRR_MANIFESTS_KEPT = 8;
+
+using SrrManifest = std::map<std::string, uint64_t>;
+
+struct SavedBatch
 {
-    using namespace fty::conversion;
+    std::string data;
+    size_t      count = 0;
+    // digest of every asset of the batch, saved or not
+    std::vector<std::pair<std::string, uint64_t>> digests;
+};
 
-    std::vector<std::string> assets = AssetImpl::listAll();
+static std::string sha256(const std::string& data)
+{
+    unsigned char md[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char*>(data.data()), data.size(), md);
+    return std::string(reinterpret_cast<const char*>(md), sizeof(md));
+}
 
-    cxxtools::SerializationInfo si;
+// digest of the SRR 2.0 record of an asset, changes whenever anything restored for the asset changes
+// 64 bits of SHA-256, a changed asset is not left out of a delta by a collision
+static uint64_t assetDigest(const AssetImpl& a)
+{
+    std::string md     = sha256(AssetImpl::assetsToSrrBlock({a}));
+    uint64_t    digest = 0;
+    for (size_t i = 0; i < 8; i++) {
+        digest |= uint64_t(static_cast<uint8_t>(md[i])) << (8 * i);
+    }
+    return digest;
+}
 
-    si.addMember("version") <<= SRR_ACTIVE_VERSION;
+// version, then name and digest (LE) of every saved asset, content of the manifest files
+static std::string encodeManifest(const SrrManifest& manifest)
+{
+    std::string all;
+    assetutils::writeString(all, SRR_MANIFEST_MAGIC);
+    assetutils::writeVarint(all, SRR_MANIFEST_VERSION);
+    for (const auto& item : manifest) {
+        assetutils::writeString(all, item.first);
+        for (size_t i = 0; i < 8; i++) {
+            all += char((item.second >> (8 * i)) & 0xFF);
+        }
+    }
+    return all;
+}
 
-    cxxtools::SerializationInfo& data = si.addMember("data");
+// marker of a save, SHA-256 of its manifest, so that a delta is only chained to its own base
+static std::string snapshotId(const SrrManifest& manifest)
+{
+    static const char hex[] = "0123456789abcdef";
 
-    for (const std::string assetName : assets) {
-        AssetImpl a(assetName);
+    std::string id;
+    for (char c : sha256(encodeManifest(manifest))) {
+        id += hex[static_cast<uint8_t>(c) >> 4];
+        id += hex[static_cast<uint8_t>(c) & 0x0F];
+    }
+    return id;
+}
 
-        if (a.isVirtual()) {
-            continue;
+static std::string manifestPath(const std::string& dir, const std::string& id)
+{
+    return dir + "/" + id + SRR_MANIFEST_SUFFIX;
+}
+
+// manifest of a previous save, false if it is not known
+static bool loadManifest(const std::string& dir, const std::string& id, SrrManifest& manifest)
+{
+    // snapshot ids are hexadecimal SHA-256, anything else does not name a manifest
+    if (id.size() != 2 * SHA256_DIGEST_LENGTH || id.find_first_not_of("0123456789abcdef") != std::string::npos) {
+        return false;
+    }
+
+    std::ifstream in(manifestPath(dir, id), std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    try {
+        size_t pos = 0;
+        if (assetutils::readString(data, pos) != SRR_MANIFEST_MAGIC ||
+            assetutils::readVarint(data, pos) != SRR_MANIFEST_VERSION) {
+            log_warning("Manifest of SRR snapshot %s has another version", id.c_str());
+            return false;
+        }
+        while (pos < data.size()) {
+            std::string iname = assetutils::readString(data, pos);
+            if (data.size() - pos < 8) {
+                throw std::runtime_error("truncated digest of " + iname);
+            }
+            uint64_t digest = 0;
+            for (size_t i = 0; i < 8; i++) {
+                digest |= uint64_t(static_cast<uint8_t>(data[pos++])) << (8 * i);
+            }
+            manifest[iname] = digest;
+        }
+    } catch (std::exception& e) {
+        log_warning("Invalid manifest of SRR snapshot %s: %s", id.c_str(), e.what());
+        manifest.clear();
+        return false;
+    }
+
+    // the snapshot id is the hash of its manifest
+    if (snapshotId(manifest) != id) {
+        log_warning("Manifest of SRR snapshot %s is corrupted", id.c_str());
+        manifest.clear();
+        return false;
+    }
+    return true;
+}
+
+// keep the manifest of a save, only the SRR_MANIFESTS_KEPT most recent ones stay
+static void storeManifest(const std::string& dir, const std::string& id, const SrrManifest& manifest)
+{
+    if (zsys_dir_create("%s", dir.c_str()) != 0) {
+        throw std::runtime_error("cannot create " + dir);
+    }
+
+    std::string path = manifestPath(dir, id);
+    std::string tmp  = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out << encodeManifest(manifest);
+        if (!out.flush()) {
+            throw std::runtime_error("cannot write " + tmp);
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("cannot write " + path);
+    }
+
+    // newest first
+    std::vector<std::pair<time_t, std::string>> saved;
+    if (DIR* d = opendir(dir.c_str())) {
+        const size_t suffix = strlen(SRR_MANIFEST_SUFFIX);
+        while (struct dirent* e = readdir(d)) {
+            std::string name = dir + "/" + e->d_name;
+            struct stat st;
+            if (name != path && name.size() > suffix &&
+                name.compare(name.size() - suffix, suffix, SRR_MANIFEST_SUFFIX) == 0 &&
+                stat(name.c_str(), &st) == 0) {
+                saved.emplace_back(st.st_mtime, name);
+            }
         }
+        closedir(d);
+    }
+    std::sort(saved.rbegin(), saved.rend());
+    for (size_t i = SRR_MANIFESTS_KEPT - 1; i < saved.size(); i++) {
+        std::remove(saved[i].second.c_str());
+    }
+}
 
+// serialize a batch of assets, as JSON objects separated by commas or as one SRR 2.0 block line
+// with a base manifest, only assets which are not in the base or whose digest changed are serialized
+static SavedBatch serializeBatch(const std::vector<std::string>& inames, bool compact, const SrrManifest* base)
+{
+    SavedBatch batch;
+
+    std::vector<AssetImpl> assets = AssetImpl::getList(inames);
+
+    if (compact) {
+        std::vector<AssetImpl> changed;
+        for (const AssetImpl& a : assets) {
+            uint64_t digest = assetDigest(a);
+            batch.digests.emplace_back(a.getInternalName(), digest);
+
+            auto found = base ? base->find(a.getInternalName()) : SrrManifest::const_iterator();
+            if (!base || found == base->end() || found->second != digest) {
+                changed.push_back(a);
+            }
+        }
+
+        batch.count = changed.size();
+        if (changed.empty()) {
+            return batch;
+        }
+        batch.data = AssetServer::encodeSrrBlock(changed) + "\n";
+        return batch;
+    }
+
+    batch.count = assets.size();
+    for (const AssetImpl& a : assets) {
         log_debug("Saving asset %s...", a.getInternalName().c_str());
 
-        cxxtools::SerializationInfo& siAsset = data.addMember("");
+        cxxtools::SerializationInfo siAsset;
         AssetImpl::assetToSrr(a, siAsset);
+
+        if (!batch.data.empty()) {
+            batch.data += ",";
+        }
+        batch.data += assetutils::serialize(siAsset);
     }
 
-    data.setCategory(cxxtools::SerializationInfo::Array);
+    return batch;
+}
 
-    return si;
+std::string AssetServer::encodeSrrBlock(const std::vector<AssetImpl>& assets)
+{
+    std::string raw = AssetImpl::assetsToSrrBlock(assets);
+
+    std::string block;
+    assetutils::writeVarint(block, raw.size());
+    uint32_t crc = assetutils::crc32(raw);
+    for (int i = 0; i < 4; i++) {
+        block += char((crc >> (8 * i)) & 0xFF);
+    }
+    block += assetutils::compress(raw);
+
+    return assetutils::base64Encode(block);
 }
 
-static void buildRestoreTree(std::vector<AssetImpl>& v)
+std::vector<AssetImpl> AssetServer::decodeSrrBlock(const std::string& line)
 {
-    std::map<std::string, std::vector<std::string>> ancestorMatrix;
+    std::string block = assetutils::base64Decode(line);
+
+    size_t        pos  = 0;
+    unsigned long size = assetutils::readVarint(block, pos);
+    if (block.size() - pos < 4) {
+        throw std::runtime_error("Truncated SRR block");
+    }
+    uint32_t crc = 0;
+    for (int i = 0; i < 4; i++) {
+        crc |= uint32_t(static_cast<uint8_t>(block[pos++])) << (8 * i);
+    }
 
-    for (const AssetImpl& a : v) {
-        // create node if doesn't exist
-        ancestorMatrix[a.getInternalName()];
-        if (!a.getParentIname().empty()) {
-            ancestorMatrix[a.getParentIname()].push_back(a.getInternalName());
+    std::string raw = assetutils::uncompress(block.substr(pos), size);
+    if (assetutils::crc32(raw) != crc) {
+        throw std::runtime_error("SRR block checksum mismatch");
+    }
+
+    return AssetImpl::srrBlockToAssets(raw);
+}
+
+void AssetServer::saveAssets(std::ostream& out, const std::string& version, const std::string& baseId)
+{
+    bool compact = (version == SRR_COMPACT_VERSION);
+    if (!compact && version != SRR_ACTIVE_VERSION) {
+        throw std::runtime_error("Version " + version + " is not supported");
+    }
+
+    // every asset is still read, unchanged assets are only left out of the output
+    SrrManifest baseManifest;
+    const SrrManifest* base = nullptr;
+    if (compact && !baseId.empty()) {
+        if (loadManifest(m_srrStateDir, baseId, baseManifest)) {
+            base = &baseManifest;
+        } else {
+            log_info("SRR snapshot %s is not known, saving all assets", baseId.c_str());
         }
     }
 
-    // iterate on each asset
-    for (const auto& a : ancestorMatrix) {
-        std::string id       = a.first;
-        const auto& children = a.second;
+    // the header carries the marker of the save, which is only known at the end
+    std::ostringstream body;
 
-        // find ancestors of asset a
-        for (auto& x : ancestorMatrix) {
-            auto& parentOf = x.second;
+    // batches are loaded by workers and written in order, at most SRR_SAVE_WORKERS batches are in memory
+    std::deque<std::future<SavedBatch>> pending;
 
-            auto found = std::find(parentOf.begin(), parentOf.end(), id);
-            // if x is parent of a, x inherits all children of a
-            if (found != parentOf.end()) {
-                for (const auto& child : children) {
-                    parentOf.push_back(child);
-                }
+    bool        first = true;
+    size_t      count = 0;
+    SrrManifest manifest;
+    auto        writeNext = [&]() {
+        SavedBatch batch = pending.front().get();
+        pending.pop_front();
+
+        count += batch.count;
+        manifest.insert(batch.digests.begin(), batch.digests.end());
+        if (!batch.data.empty()) {
+            (compact ? body : out) << (first || compact ? "" : ",") << batch.data;
+            first = false;
+        }
+    };
+
+    if (!compact) {
+        out << "{\"version\":\"" << SRR_ACTIVE_VERSION << "\",\"data\":[";
+    }
+
+    std::string after;
+    while (true) {
+        std::vector<std::string> page = AssetImpl::listPhysical(after, SRR_SAVE_BATCH_SIZE);
+        if (page.empty()) {
+            break;
+        }
+        after = page.back();
+
+        pending.push_back(std::async(std::launch::async, serializeBatch, std::move(page), compact, base));
+        if (pending.size() >= SRR_SAVE_WORKERS) {
+            writeNext();
+        }
+    }
+
+    while (!pending.empty()) {
+        writeNext();
+    }
+
+    if (!compact) {
+        out << "]}";
+        return;
+    }
+
+    std::string id = snapshotId(manifest);
+    if (base) {
+        out << SRR_COMPACT_HEADER << " " << SRR_DELTA_MARKER << " " << id << " " << baseId << "\n";
+        out << body.str();
+        for (const auto& item : *base) {
+            if (manifest.find(item.first) == manifest.end()) {
+                out << SRR_DELETED_PREFIX << item.first << "\n";
             }
         }
+        log_debug("Saved %zu changed assets since snapshot %s", count, baseId.c_str());
+    } else {
+        out << SRR_COMPACT_HEADER << " " << SRR_SNAPSHOT_MARKER << " " << id << "\n";
+        out << body.str();
     }
+    out << SRR_COMPACT_TRAILER << count << "\n";
 
-    std::sort(v.begin(), v.end(), [&](const AssetImpl& l, const AssetImpl& r) {
-        return ancestorMatrix[l.getInternalName()].size() > ancestorMatrix[r.getInternalName()].size();
-    });
+    // the save is complete, it can be the base of the next ones
+    try {
+        storeManifest(m_srrStateDir, id, manifest);
+    } catch (std::exception& e) {
+        log_error("Manifest of SRR snapshot %s not kept: %s", id.c_str(), e.what());
+    }
 }
 
-void AssetServer::restoreAssets(const cxxtools::SerializationInfo& si, bool tryActivate)
+cxxtools::SerializationInfo AssetServer::saveAssets()
 {
     using namespace fty::conversion;
 
-    // if database is not empty, can't load assets
-    if (AssetImpl::listAll().size() != 0) {
-        throw std::runtime_error("Database already contains assets, impossible to restore from SRR");
+    cxxtools::SerializationInfo si;
+
+    si.addMember("version") <<= SRR_ACTIVE_VERSION;
+
+    cxxtools::SerializationInfo& data = si.addMember("data");
+
+    std::string after;
+    while (true) {
+        std::vector<std::string> page = AssetImpl::listPhysical(after, SRR_SAVE_BATCH_SIZE);
+        if (page.empty()) {
+            break;
+        }
+        after = page.back();
+
+        for (const AssetImpl& a : AssetImpl::getList(page)) {
+            log_debug("Saving asset %s...", a.getInternalName().c_str());
+
+            cxxtools::SerializationInfo& siAsset = data.addMember("");
+            AssetImpl::assetToSrr(a, siAsset);
+        }
     }
 
-    std::string srrVersion;
-    si.getMember("version") >>= srrVersion;
+    data.setCategory(cxxtools::SerializationInfo::Array);
 
-    if (srrVersion != SRR_ACTIVE_VERSION) {
-        throw std::runtime_error("Version " + srrVersion + " is not supported");
+    return si;
+}
+
+/// order assets so that parents and link sources are restored before the assets which depend on them
+static void buildRestoreTree(std::vector<AssetImpl>& v)
+{
+    std::unordered_map<std::string, size_t> index;
+    for (size_t i = 0; i < v.size(); i++) {
+        index[v[i].getInternalName()] = i;
     }
 
-    const cxxtools::SerializationInfo& assets = si.getMember("data");
-    std::vector<AssetImpl>             assetsToRestore;
+    // dependents[i]: assets waiting for asset i, pending[i]: number of assets asset i is waiting for
+    std::vector<std::vector<size_t>> dependents(v.size());
+    std::vector<size_t>              pending(v.size(), 0);
 
-    for (auto it = assets.begin(); it != assets.end(); ++it) {
-        AssetImpl a;
-        AssetImpl::srrToAsset(*it, a);
+    auto addDependency = [&](size_t i, const std::string& on) {
+        auto found = index.find(on);
+        // dependencies outside of the backup are already satisfied (or never will be)
+        if (found == index.end() || found->second == i) {
+            return;
+        }
+        dependents[found->second].push_back(i);
+        pending[i]++;
+    };
 
-        assetsToRestore.push_back(a);
+    for (size_t i = 0; i < v.size(); i++) {
+        addDependency(i, v[i].getParentIname());
+        for (const auto& l : v[i].getLinkedAssets()) {
+            addDependency(i, l.sourceId);
+        }
     }
 
-    buildRestoreTree(assetsToRestore);
+    // Kahn's algorithm, the order vector is also the queue
+    std::vector<size_t> order;
+    order.reserve(v.size());
+    for (size_t i = 0; i < v.size(); i++) {
+        if (pending[i] == 0) {
+            order.push_back(i);
+        }
+    }
+    for (size_t head = 0; head < order.size(); head++) {
+        for (size_t d : dependents[order[head]]) {
+            if (--pending[d] == 0) {
+                order.push_back(d);
+            }
+        }
+    }
+
+    // assets left are part of (or depend on) a cycle: keep them, in backup order
+    if (order.size() != v.size()) {
+        std::string cycle;
+        for (size_t i = 0; i < v.size(); i++) {
+            if (pending[i] != 0) {
+                cycle += (cycle.empty() ? "" : ", ") + v[i].getInternalName();
+                order.push_back(i);
+            }
+        }
+        log_error("Dependency cycle in restored assets, restoring in backup order: %s", cycle.c_str());
+    }
 
+    std::vector<AssetImpl> sorted;
+    sorted.reserve(v.size());
+    for (size_t i : order) {
+        sorted.push_back(std::move(v[i]));
+    }
+    v.swap(sorted);
+}
+
+/// restore assets one transaction at a time, failing assets are reported and skipped
+static void restoreOneByOne(std::vector<AssetImpl>& assetsToRestore, bool tryActivate)
+{
     for (AssetImpl& a : assetsToRestore) {
         log_debug("Restoring asset %s...", a.getInternalName().c_str());
 
@@ -885,4 +1477,202 @@ void AssetServer::restoreAssets(const cxxtools::SerializationInfo& si, bool tryA
     }
 }
 
+void AssetServer::restoreAssets(const cxxtools::SerializationInfo& si, bool tryActivate)
+{
+    using namespace fty::conversion;
+
+    std::string srrVersion;
+    si.getMember("version") >>= srrVersion;
+
+    if (srrVersion != SRR_ACTIVE_VERSION) {
+        throw std::runtime_error("Version " + srrVersion + " is not supported");
+    }
+
+    const cxxtools::SerializationInfo& assets = si.getMember("data");
+    std::vector<AssetImpl>             assetsToRestore;
+
+    for (auto it = assets.begin(); it != assets.end(); ++it) {
+        AssetImpl a;
+        AssetImpl::srrToAsset(*it, a);
+
+        assetsToRestore.push_back(a);
+    }
+
+    restoreAssets(assetsToRestore, tryActivate);
+}
+
+std::vector<AssetImpl> AssetServer::readSrrData(std::istream& in)
+{
+    // the full save, then each delta replaces or removes assets, in the order of the previous section
+    std::vector<AssetImpl>                  assetsToRestore;
+    std::unordered_map<std::string, size_t> index;
+    std::string                             snapshot;
+
+    std::string line;
+    bool        full = true;
+    while (std::getline(in, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        if (line.compare(0, strlen(SRR_COMPACT_HEADER), SRR_COMPACT_HEADER) != 0) {
+            throw std::runtime_error("Invalid SRR " + std::string(SRR_COMPACT_VERSION) + " header");
+        }
+
+        std::istringstream header(line.substr(strlen(SRR_COMPACT_HEADER)));
+        std::string        kind, id, baseId;
+        header >> kind >> id >> baseId;
+
+        if (kind == SRR_DELTA_MARKER) {
+            if (full) {
+                throw std::runtime_error("SRR data starts with delta " + id + " instead of a full save");
+            }
+            if (baseId != snapshot) {
+                throw std::runtime_error("SRR delta " + id + " does not apply to snapshot " + snapshot);
+            }
+        } else if (!full) {
+            throw std::runtime_error("SRR data contains more than one full save");
+        }
+        full     = false;
+        snapshot = id;
+
+        size_t count    = 0;
+        bool   complete = false;
+        while (std::getline(in, line)) {
+            if (line.compare(0, strlen(SRR_COMPACT_TRAILER), SRR_COMPACT_TRAILER) == 0) {
+                if (line.substr(strlen(SRR_COMPACT_TRAILER)) != std::to_string(count)) {
+                    throw std::runtime_error("SRR data does not contain the expected number of assets");
+                }
+                complete = true;
+                break;
+            }
+
+            if (line.compare(0, strlen(SRR_DELETED_PREFIX), SRR_DELETED_PREFIX) == 0) {
+                index.erase(line.substr(strlen(SRR_DELETED_PREFIX)));
+                continue;
+            }
+
+            for (auto& a : decodeSrrBlock(line)) {
+                count++;
+                auto inserted = index.emplace(a.getInternalName(), assetsToRestore.size());
+                if (inserted.second) {
+                    assetsToRestore.push_back(std::move(a));
+                } else {
+                    assetsToRestore[inserted.first->second] = std::move(a);
+                }
+            }
+        }
+
+        if (!complete) {
+            throw std::runtime_error("Truncated SRR data");
+        }
+    }
+
+    if (full) {
+        throw std::runtime_error("Invalid SRR " + std::string(SRR_COMPACT_VERSION) + " header");
+    }
+
+    // drop the assets removed by a delta
+    std::vector<AssetImpl> remaining;
+    remaining.reserve(index.size());
+    for (size_t i = 0; i < assetsToRestore.size(); i++) {
+        auto found = index.find(assetsToRestore[i].getInternalName());
+        if (found != index.end() && found->second == i) {
+            remaining.push_back(std::move(assetsToRestore[i]));
+        }
+    }
+    log_debug("Read snapshot %s", snapshot.c_str());
+
+    return remaining;
+}
+
+void AssetServer::restoreAssets(std::istream& in, bool tryActivate)
+{
+    std::vector<AssetImpl> assetsToRestore = readSrrData(in);
+    restoreAssets(assetsToRestore, tryActivate);
+}
+
+// update the assets kept by the reset with their saved content, once the parents they may refer to are restored
+static void restoreKept(std::vector<AssetImpl>& keptAssets)
+{
+    for (AssetImpl& a : keptAssets) {
+        try {
+            a.update();
+        } catch (std::exception& e) {
+            log_error("Asset %s could not be restored: %s", a.getInternalName().c_str(), e.what());
+        }
+    }
+}
+
+void AssetServer::restoreAssets(std::vector<AssetImpl>& assetsToRestore, bool tryActivate)
+{
+    // if database contains more than RC-0 and its location, can't load assets
+    std::vector<std::string>        location = AssetImpl::rc0Location();
+    std::unordered_set<std::string> kept(location.begin(), location.end());
+    for (const std::string& iname : AssetImpl::listAll()) {
+        if (!kept.count(iname)) {
+            throw std::runtime_error("Database already contains assets, impossible to restore from SRR");
+        }
+    }
+
+    // the location of RC-0 was kept by the reset, the saved one updates it instead of being inserted again
+    auto located = std::stable_partition(assetsToRestore.begin(), assetsToRestore.end(), [&](const AssetImpl& a) {
+        return !kept.count(a.getInternalName());
+    });
+    std::vector<AssetImpl> keptAssets(located, assetsToRestore.end());
+    assetsToRestore.erase(located, assetsToRestore.end());
+
+    buildRestoreTree(assetsToRestore);
+
+    try {
+        AssetImpl::restoreList(assetsToRestore);
+    } catch (std::exception& e) {
+        // nothing was written, fall back to one transaction per asset to find and report the failing ones
+        log_warning("Bulk restore failed (%s), restoring assets one by one", e.what());
+        restoreOneByOne(assetsToRestore, tryActivate);
+        restoreKept(keptAssets);
+        return;
+    }
+    restoreKept(keptAssets);
+
+    // only devices consume the license, the other assets were inserted with their status,
+    // check activable devices one at a time
+    std::vector<std::string> notActivated;
+    for (AssetImpl& a : assetsToRestore) {
+        if (a.getAssetType() != TYPE_DEVICE || a.getAssetStatus() != AssetStatus::Active) {
+            continue;
+        }
+
+        try {
+            if (!a.isActivable()) {
+                if (tryActivate) {
+                    // asset was restored as non active
+                    a.setAssetStatus(fty::AssetStatus::Nonactive);
+                    continue;
+                }
+                throw std::runtime_error(
+                    "Licensing limitation hit - maximum amount of active power devices allowed in "
+                    "license reached.");
+            }
+            a.activate();
+        } catch (std::exception& e) {
+            log_error("Asset %s could not be activated: %s", a.getInternalName().c_str(), e.what());
+            notActivated.push_back(a.getInternalName());
+        }
+    }
+
+    // if activation fails, delete asset, its links were restored too and would block the deletion
+    if (!notActivated.empty()) {
+        try {
+            AssetImpl::unlinkSources(notActivated);
+        } catch (std::exception& e) {
+            log_error("%s", e.what());
+        }
+        for (const auto& status : AssetImpl::deleteList(notActivated, true)) {
+            if (status.second != "OK") {
+                log_error("%s: %s", status.first.getInternalName().c_str(), status.second.c_str());
+            }
+        }
+    }
+}
+
 } // namespace fty
@@ -20,10 +20,14 @@
 */
 
 #pragma once
+#include "asset/asset-json-cache.h"
 #include "asset/asset.h"
 #include <fty_srr_dto.h>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <istream>
+#include <ostream>
 
 static constexpr const char* FTY_ASSET_MAILBOX = "FTY.Q.ASSET.QUERY";
 // new interface mailbox subjects
@@ -34,6 +38,7 @@ static constexpr const char* FTY_ASSET_SUBJECT_DELETE_LIST = "DELETE_LIST";
 static constexpr const char* FTY_ASSET_SUBJECT_GET         = "GET";
 static constexpr const char* FTY_ASSET_SUBJECT_GET_BY_UUID = "GET_BY_UUID";
 static constexpr const char* FTY_ASSET_SUBJECT_LIST        = "LIST";
+static constexpr const char* FTY_ASSET_SUBJECT_GET_LIST    = "GET_LIST";
 
 // new interface topics
 static constexpr const char* FTY_ASSET_TOPIC_CREATED   = "FTY.T.ASSET.CREATED";
@@ -42,6 +47,8 @@ static constexpr const char* FTY_ASSET_TOPIC_UPDATED   = "FTY.T.ASSET.UPDATED";
 static constexpr const char* FTY_ASSET_TOPIC_UPDATED_L = "FTY.T.ASSET_LIGHT.UPDATED";
 static constexpr const char* FTY_ASSET_TOPIC_DELETED   = "FTY.T.ASSET.DELETED";
 static constexpr const char* FTY_ASSET_TOPIC_DELETED_L = "FTY.T.ASSET_LIGHT.DELETED";
+static constexpr const char* FTY_ASSET_TOPIC_CREATED_B = "FTY.T.ASSET_BINARY.CREATED";
+static constexpr const char* FTY_ASSET_TOPIC_UPDATED_B = "FTY.T.ASSET_BINARY.UPDATED";
 
 // new interface topic subjects
 static constexpr const char* FTY_ASSET_SUBJECT_CREATED   = "CREATED";
@@ -50,15 +57,32 @@ static constexpr const char* FTY_ASSET_SUBJECT_UPDATED   = "UPDATED";
 static constexpr const char* FTY_ASSET_SUBJECT_UPDATED_L = "UPDATED_LIGHT";
 static constexpr const char* FTY_ASSET_SUBJECT_DELETED   = "DELETED";
 static constexpr const char* FTY_ASSET_SUBJECT_DELETED_L = "DELETED_LIGHT";
+static constexpr const char* FTY_ASSET_SUBJECT_CREATED_B = "CREATED_BINARY";
+static constexpr const char* FTY_ASSET_SUBJECT_UPDATED_B = "UPDATED_BINARY";
 
 
 static constexpr const char* METADATA_TRY_ACTIVATE      = "TRY_ACTIVATE";
 static constexpr const char* METADATA_NO_ERROR_IF_EXIST = "NO_ERROR_IF_EXIST";
 static constexpr const char* METADATA_ID_ONLY           = "ID_ONLY";
 static constexpr const char* METADATA_WITH_PARENTS_LIST = "WITH_PARENTS_LIST";
+// snapshot id of a previous SRR 2.0 save, the save request then only exports the changes since it
+static constexpr const char* METADATA_SRR_BASE          = "SRR_BASE";
 
 // SRR
 static constexpr const char* SRR_ACTIVE_VERSION  = "1.0";
+// compact format, text lines so that it can be streamed:
+//   "FTY-ASSET-SRR 2.0"
+//   one line per block: base64 of (raw size varint, CRC-32 of raw block (LE), LZ77 compressed raw block)
+//   "END <number of assets>"
+// the raw block is built by AssetImpl::assetsToSrrBlock()
+// the header may carry a snapshot marker, "FTY-ASSET-SRR 2.0 SNAPSHOT <id>" for a full save or
+// "FTY-ASSET-SRR 2.0 DELTA <id> <base id>" for an incremental one, which only contains the assets created or
+// updated since the base snapshot followed by one "DELETED <iname>" line per removed asset.
+// A restore accepts a full save followed by the chain of its deltas.
+static constexpr const char* SRR_COMPACT_VERSION = "2.0";
+// per-asset digests of the SRR 2.0 saves, one "<snapshot id>.manifest" file per save,
+// the snapshot id is the SHA-256 of the manifest
+static constexpr const char* SRR_STATE_DIR = "/var/lib/fty/fty-asset/srr";
 static constexpr const char* FTY_ASSET_SRR_AGENT = "asset-agent-srr";
 static constexpr const char* FTY_ASSET_SRR_NAME  = "asset-agent";
 static constexpr const char* FTY_ASSET_SRR_QUEUE = "FTY.Q.ASSET.SRR";
@@ -170,11 +194,26 @@ public:
         m_srrAgentName = agentName;
     }
 
+    // format of SRR saves (SRR_ACTIVE_VERSION or SRR_COMPACT_VERSION), restore accepts both
+    void setSrrVersion(const std::string& version)
+    {
+        m_srrVersion = version;
+    }
+
+    // where the manifests of the SRR 2.0 saves are kept, base of the incremental saves
+    void setSrrStateDir(const std::string& dir)
+    {
+        m_srrStateDir = dir;
+    }
+
     void createMailboxClientNg();
     void resetMailboxClientNg();
     void connectMailboxClientNg();
     void receiveMailboxClientNg(const std::string& queue);
 
+    // binary CREATED/UPDATED notifications, off by default
+    void setBinaryNotifications(bool enabled);
+
     void createPublisherClientNg();
     void resetPublisherClientNg();
     void connectPublisherClientNg();
@@ -187,15 +226,31 @@ public:
     void resetSrrClient();
 
 private:
+    void createBinaryPublishers();
+
     void createAsset(const messagebus::Message& msg);
     void updateAsset(const messagebus::Message& msg);
     void deleteAsset(const messagebus::Message& msg);
     void getAsset(const messagebus::Message& msg, bool getFromUuid = false);
     void listAsset(const messagebus::Message& msg);
+    void getAssetList(const messagebus::Message& msg);
 
     // SRR
     cxxtools::SerializationInfo saveAssets();
-    void                        restoreAssets(const cxxtools::SerializationInfo& si, bool tryActivate = true);
+    // with a base snapshot id, a SRR 2.0 save only contains the changes since that save,
+    // it is a full save if the base is not known
+    void saveAssets(std::ostream& out, const std::string& version = SRR_ACTIVE_VERSION, const std::string& base = "");
+    void restoreAssets(const cxxtools::SerializationInfo& si, bool tryActivate = true);
+    void restoreAssets(std::istream& in, bool tryActivate = true);
+    void restoreAssets(std::vector<AssetImpl>& assetsToRestore, bool tryActivate);
+
+public:
+    // one SRR 2.0 block line: base64 of the block size, its CRC-32 and the compressed block
+    // decoding throws std::runtime_error on malformed input
+    static std::string            encodeSrrBlock(const std::vector<AssetImpl>& assets);
+    static std::vector<AssetImpl> decodeSrrBlock(const std::string& line);
+    // assets of SRR 2.0 data, a full save with the chain of its deltas applied
+    static std::vector<AssetImpl> readSrrData(std::istream& in);
 
 private:
     static void destroyMlmClient(mlm_client_t* client);
@@ -222,20 +277,28 @@ private:
     MsgBusPtr   m_publisherUpdateLight;
     MsgBusPtr   m_publisherDelete;
     MsgBusPtr   m_publisherDeleteLight;
+    bool        m_binaryNotifications = false;
+    MsgBusPtr   m_publisherCreateBinary;
+    MsgBusPtr   m_publisherUpdateBinary;
+
+    // JSON representation of assets, shared by replies and notifications
+    AssetJsonCache m_jsonCache;
 
     // topic handlers
     void handleAssetManipulationReq(const messagebus::Message& msg);
     void handleAssetSrrReq(const messagebus::Message& msg);
 
     // SRR
-    std::string                 m_srrEndpoint  = "ipc://@/malamute";
-    std::string                 m_srrAgentName = "asset-agent-srr";
+    std::string                 m_srrEndpoint    = "ipc://@/malamute";
+    std::string                 m_srrAgentName   = "asset-agent-srr";
+    std::string                 m_srrVersion     = SRR_ACTIVE_VERSION;
+    std::string                 m_srrStateDir    = SRR_STATE_DIR;
     MsgBusPtr                   m_srrClient;
     std::mutex                  m_srrLock;
     dto::srr::SrrQueryProcessor m_srrProcessor;
 
     // SRR handlers
-    dto::srr::SaveResponse    handleSave(const dto::srr::SaveQuery& query);
+    dto::srr::SaveResponse    handleSave(const dto::srr::SaveQuery& query, const std::string& base);
     dto::srr::RestoreResponse handleRestore(const dto::srr::RestoreQuery& query);
     dto::srr::ResetResponse   handleReset(const dto::srr::ResetQuery& query);
 };
@@ -28,6 +28,7 @@
 
 #include "asset-db-test.h"
 #include "asset.h"
+#include <cstring>
 
 namespace fty {
 
@@ -43,7 +44,8 @@ void DBTest::loadAsset(const std::string& nameId, Asset& asset)
     asset.setAssetStatus(fty::AssetStatus::Nonactive);
     asset.setAssetType(fty::TYPE_DEVICE);
     asset.setAssetSubtype(fty::SUB_UPS);
-    asset.setParentIname("abc123");
+    // the common parent is a root, parents lists end there
+    asset.setParentIname(nameId == "abc123" ? "" : "abc123");
     asset.setPriority(4);
 }
 
@@ -227,4 +229,125 @@ std::vector<std::string> DBTest::listAllAssets()
     return assetList;
 }
 
+std::vector<std::string> DBTest::listAssetsPage(
+    const std::string& after, size_t limit, const std::vector<std::string>& excludedTypes)
+{
+    std::cout << "DBTest::listAssetsPage" << std::endl;
+    std::vector<std::string> assetList;
+
+    for (const auto& name : listAllAssets()) {
+        if (name > after && assetList.size() < limit) {
+            assetList.push_back(name);
+        }
+    }
+
+    return assetList;
+}
+
+std::vector<Asset> DBTest::loadAssets(const std::vector<std::string>& inames, bool loadLinks)
+{
+    std::cout << "DBTest::loadAssets" << std::endl;
+    std::vector<Asset> assets;
+
+    for (const auto& iname : inames) {
+        if (iname.compare(0, strlen(DBTEST_MISSING_PREFIX), DBTEST_MISSING_PREFIX) == 0) {
+            continue;
+        }
+        Asset a;
+        loadAsset(iname, a);
+        loadExtMap(a);
+        if (loadLinks) {
+            loadLinkedAssets(a);
+        }
+        assets.push_back(a);
+    }
+
+    return assets;
+}
+
+std::map<std::string, std::string> DBTest::inamesByUuids(const std::vector<std::string>& uuids)
+{
+    std::cout << "DBTest::inamesByUuids" << std::endl;
+    std::map<std::string, std::string> inames;
+
+    for (const auto& uuid : uuids) {
+        if (uuid.compare(0, strlen(DBTEST_MISSING_PREFIX), DBTEST_MISSING_PREFIX) != 0) {
+            inames[uuid] = inameByUuid(uuid);
+        }
+    }
+
+    return inames;
+}
+
+std::vector<std::string> DBTest::getSubtree(const std::string& iname)
+{
+    std::cout << "DBTest::getSubtree" << std::endl;
+    return getChildren(Asset());
+}
+
+std::map<std::string, std::vector<std::string>> DBTest::childrenOf(const std::vector<std::string>& inames)
+{
+    std::cout << "DBTest::childrenOf" << std::endl;
+    std::map<std::string, std::vector<std::string>> children;
+
+    for (const auto& iname : inames) {
+        children[iname] = getChildren(Asset());
+    }
+
+    return children;
+}
+
+std::map<std::string, std::vector<std::string>> DBTest::linkDestinationsOf(const std::vector<std::string>& inames)
+{
+    std::cout << "DBTest::linkDestinationsOf" << std::endl;
+    std::map<std::string, std::vector<std::string>> dests;
+
+    for (const auto& iname : inames) {
+        dests[iname].push_back("asset-1");
+    }
+
+    return dests;
+}
+
+int DBTest::countDataCenters()
+{
+    std::cout << "DBTest::countDataCenters" << std::endl;
+    return 1;
+}
+
+void DBTest::unlinkAll(const std::vector<std::string>& dests)
+{
+    std::cout << "DBTest::unlinkAll (bulk)" << std::endl;
+}
+
+void DBTest::unlinkSources(const std::vector<std::string>& srcs)
+{
+    std::cout << "DBTest::unlinkSources" << std::endl;
+}
+
+void DBTest::removeAssets(const std::vector<std::vector<std::string>>& levels)
+{
+    std::cout << "DBTest::removeAssets" << std::endl;
+}
+
+void DBTest::removeAllAssets(const std::vector<std::string>& preserved)
+{
+    std::cout << "DBTest::removeAllAssets" << std::endl;
+}
+
+void DBTest::insertAssets(const std::vector<Asset>& assets)
+{
+    std::cout << "DBTest::insertAssets" << std::endl;
+}
+
+void DBTest::insertExtMaps(const std::vector<Asset>& assets)
+{
+    std::cout << "DBTest::insertExtMaps" << std::endl;
+}
+
+void DBTest::insertLinks(const std::vector<Asset>& assets)
+{
+    std::cout << "DBTest::insertLinks" << std::endl;
+}
+
 } // namespace fty
@@ -27,6 +27,9 @@
 
 namespace fty {
 
+// assets and UUIDs with this prefix are not found by the bulk lookups of the test storage
+static constexpr const char* DBTEST_MISSING_PREFIX = "missing-";
+
 class DBTest : public AssetStorage
 {
 public:
@@ -73,6 +76,25 @@ public:
 
     std::vector<std::string> listAssets(std::map<std::string, std::vector<std::string>> filters) override;
     std::vector<std::string> listAllAssets() override;
+    std::vector<std::string> listAssetsPage(
+        const std::string& after, size_t limit, const std::vector<std::string>& excludedTypes) override;
+
+    std::vector<Asset> loadAssets(const std::vector<std::string>& inames, bool loadLinks = true) override;
+    std::map<std::string, std::string> inamesByUuids(const std::vector<std::string>& uuids) override;
+
+    std::vector<std::string>                        getSubtree(const std::string& iname) override;
+    std::map<std::string, std::vector<std::string>> childrenOf(const std::vector<std::string>& inames) override;
+    std::map<std::string, std::vector<std::string>> linkDestinationsOf(
+        const std::vector<std::string>& inames) override;
+    int  countDataCenters() override;
+    void unlinkAll(const std::vector<std::string>& dests) override;
+    void unlinkSources(const std::vector<std::string>& srcs) override;
+    void removeAssets(const std::vector<std::vector<std::string>>& levels) override;
+    void removeAllAssets(const std::vector<std::string>& preserved) override;
+
+    void insertAssets(const std::vector<Asset>& assets) override;
+    void insertExtMaps(const std::vector<Asset>& assets) override;
+    void insertLinks(const std::vector<Asset>& assets) override;
 
 private:
     DBTest();
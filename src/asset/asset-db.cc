@@ -21,15 +21,46 @@
 
 #include "asset-db.h"
 #include "asset.h"
+#include <algorithm>
 #include <cstdlib>
 #include <fty_common_db_dbpath.h>
 #include <sstream>
 #include <tntdb.h>
+#include <tuple>
 
 namespace fty {
 
 // static helpers
 
+// maximum number of elements in one IN (...) clause of bulk queries
+static constexpr size_t BULK_CHUNK_SIZE = 500;
+
+// build a list of placeholders ":<prefix>0, :<prefix>1, ..." for a IN (...) clause
+static std::string inPlaceholders(const std::string& prefix, size_t first, size_t last)
+{
+    std::stringstream ss;
+    for (size_t i = first; i < last; i++) {
+        if (i != first) {
+            ss << ", ";
+        }
+        ss << ":" << prefix << i;
+    }
+    return ss.str();
+}
+
+// build a list of integer ids "1, 2, 3" for a IN (...) clause
+static std::string inIds(const std::vector<uint32_t>& ids)
+{
+    std::stringstream ss;
+    for (auto it = ids.begin(); it != ids.end(); it++) {
+        if (it != ids.begin()) {
+            ss << ", ";
+        }
+        ss << *it;
+    }
+    return ss.str();
+}
+
 // DB
 DB::DB(bool test)
 {
@@ -1177,4 +1208,752 @@ std::vector<std::string> DB::listAllAssets()
     return assetList;
 }
 
+std::vector<std::string> DB::listAssetsPage(
+    const std::string& after, size_t limit, const std::vector<std::string>& excludedTypes)
+{
+    // clang-format off
+    std::string qs =
+        " SELECT"
+        "     a.name AS name"
+        " FROM"
+        "     t_bios_asset_element AS a"
+        " INNER JOIN"
+        "     t_bios_asset_element_type AS t ON a.id_type = t.id_asset_element_type"
+        " WHERE"
+        "     a.name > :after AND a.name != :rc0";
+    if (!excludedTypes.empty()) {
+        qs += " AND t.name NOT IN (" + inPlaceholders("t", 0, excludedTypes.size()) + ")";
+    }
+    qs += " ORDER BY a.name LIMIT :limit";
+    // clang-format on
+
+    tntdb::Result res;
+
+    try {
+        m_conn_lock.lock();
+        auto q = m_conn.prepareCached(qs);
+        q.set("after", after);
+        q.set("rc0", std::string(RC0));
+        for (size_t i = 0; i < excludedTypes.size(); i++) {
+            q.set("t" + std::to_string(i), excludedTypes[i]);
+        }
+        q.set("limit", uint32_t(limit));
+        res = q.select();
+        m_conn_lock.unlock();
+    } catch (std::exception& e) {
+        m_conn_lock.unlock();
+        throw std::runtime_error("database error - " + std::string(e.what()));
+    }
+
+    std::vector<std::string> assetList;
+    for (const auto& row : res) {
+        assetList.emplace_back(row.getString("name"));
+    }
+
+    return assetList;
+}
+
+std::vector<Asset> DB::loadAssets(const std::vector<std::string>& inames, bool loadLinks)
+{
+    std::vector<Asset> assets;
+    // asset id -> position in assets
+    std::map<uint32_t, size_t> index;
+
+    for (size_t first = 0; first < inames.size(); first += BULK_CHUNK_SIZE) {
+        size_t last = std::min(first + BULK_CHUNK_SIZE, inames.size());
+
+        // clang-format off
+        std::string qs =
+            " SELECT"
+            "     a.id_asset_element AS id,"
+            "     a.name             AS name,"
+            "     e.name             AS type,"
+            "     d.name             AS subType,"
+            "     p.name             AS parentName,"
+            "     a.status           AS status,"
+            "     a.priority         AS priority,"
+            "     a.asset_tag        AS tag,"
+            "     a.id_secondary     AS idSecondary"
+            " FROM t_bios_asset_element AS a"
+            "     INNER JOIN t_bios_asset_device_type AS d"
+            "     INNER JOIN t_bios_asset_element_type AS e"
+            "     ON a.id_type = e.id_asset_element_type AND a.id_subtype = d.id_asset_device_type"
+            "     LEFT JOIN t_bios_asset_element AS p"
+            "     ON a.id_parent = p.id_asset_element"
+            " WHERE a.name IN (" + inPlaceholders("n", first, last) + ")";
+        // clang-format on
+
+        tntdb::Result res;
+
+        try {
+            m_conn_lock.lock();
+            auto q = m_conn.prepare(qs);
+            for (size_t i = first; i < last; i++) {
+                q.set("n" + std::to_string(i), inames[i]);
+            }
+            res = q.select();
+            m_conn_lock.unlock();
+        } catch (std::exception& e) {
+            m_conn_lock.unlock();
+            throw std::runtime_error("database error - " + std::string(e.what()));
+        }
+
+        for (const auto& row : res) {
+            Asset asset;
+            asset.setInternalName(row.getString("name"));
+            asset.setAssetType(row.getString("type"));
+            asset.setAssetSubtype(row.getString("subType"));
+            if (!row.isNull("parentName")) {
+                asset.setParentIname(row.getString("parentName"));
+            }
+            asset.setAssetStatus(stringToAssetStatus(row.getString("status")));
+            asset.setPriority(row.getInt("priority"));
+            if (!row.isNull("tag")) {
+                asset.setAssetTag(row.getString("tag"));
+            }
+            if (!row.isNull("idSecondary")) {
+                asset.setSecondaryID(row.getString("idSecondary"));
+            }
+
+            index[row.getUnsigned32("id")] = assets.size();
+            assets.push_back(asset);
+        }
+    }
+
+    std::vector<uint32_t> ids;
+    for (const auto& i : index) {
+        ids.push_back(i.first);
+    }
+
+    for (size_t first = 0; first < ids.size(); first += BULK_CHUNK_SIZE) {
+        std::vector<uint32_t> chunk(
+            ids.begin() + long(first), ids.begin() + long(std::min(first + BULK_CHUNK_SIZE, ids.size())));
+
+        // clang-format off
+        std::string qs =
+            " SELECT"
+            "     id_asset_element,"
+            "     keytag,"
+            "     value,"
+            "     read_only"
+            " FROM"
+            "     t_bios_asset_ext_attributes"
+            " WHERE"
+            "     id_asset_element IN (" + inIds(chunk) + ")";
+        // clang-format on
+
+        tntdb::Result res;
+
+        try {
+            m_conn_lock.lock();
+            res = m_conn.prepare(qs).select();
+            m_conn_lock.unlock();
+        } catch (std::exception& e) {
+            m_conn_lock.unlock();
+            throw std::runtime_error("database error - " + std::string(e.what()));
+        }
+
+        for (const auto& row : res) {
+            Asset& asset = assets[index[row.getUnsigned32("id_asset_element")]];
+            asset.setExtEntry(row.getString("keytag"), row.getString("value"), row.getBool("read_only"));
+        }
+
+        if (!loadLinks) {
+            continue;
+        }
+
+        // clang-format off
+        qs =
+            " SELECT"
+            "     l.id_asset_element_dest AS destId,"
+            "     e.name                  AS name,"
+            "     l.src_out               AS srcOut,"
+            "     l.dest_in               AS destIn,"
+            "     l.id_asset_link_type    AS linkType"
+            " FROM"
+            "     v_bios_asset_link AS l"
+            " INNER JOIN"
+            "     t_bios_asset_element AS e ON l.id_asset_element_src = e.id_asset_element"
+            " WHERE"
+            "     l.id_asset_element_dest IN (" + inIds(chunk) + ")";
+        // clang-format on
+
+        try {
+            m_conn_lock.lock();
+            res = m_conn.prepare(qs).select();
+            m_conn_lock.unlock();
+        } catch (std::exception& e) {
+            m_conn_lock.unlock();
+            throw std::runtime_error("database error - " + std::string(e.what()));
+        }
+
+        std::map<uint32_t, std::vector<AssetLink>> links;
+        for (const auto& row : res) {
+            std::string srcOut, destIn;
+            // may be NULL
+            if (!row.isNull("srcOut")) {
+                row.getString("srcOut", srcOut);
+            }
+            if (!row.isNull("destIn")) {
+                row.getString("destIn", destIn);
+            }
+
+            links[row.getUnsigned32("destId")].push_back(
+                AssetLink(row.getString("name"), srcOut, destIn, row.getInt("linkType")));
+        }
+
+        for (const auto& l : links) {
+            assets[index[l.first]].setLinkedAssets(l.second);
+        }
+    }
+
+    return assets;
+}
+
+std::map<std::string, std::string> DB::inamesByUuids(const std::vector<std::string>& uuids)
+{
+    std::map<std::string, std::string> inames;
+
+    for (size_t first = 0; first < uuids.size(); first += BULK_CHUNK_SIZE) {
+        size_t last = std::min(first + BULK_CHUNK_SIZE, uuids.size());
+
+        // clang-format off
+        std::string qs =
+            " SELECT"
+            "     e.name  AS name,"
+            "     a.value AS uuid"
+            " FROM"
+            "     t_bios_asset_ext_attributes AS a"
+            " INNER JOIN"
+            "     t_bios_asset_element AS e ON a.id_asset_element = e.id_asset_element"
+            " WHERE"
+            "     a.keytag = \"uuid\" AND a.value IN (" + inPlaceholders("u", first, last) + ")";
+        // clang-format on
+
+        tntdb::Result res;
+
+        try {
+            m_conn_lock.lock();
+            auto q = m_conn.prepare(qs);
+            for (size_t i = first; i < last; i++) {
+                q.set("u" + std::to_string(i), uuids[i]);
+            }
+            res = q.select();
+            m_conn_lock.unlock();
+        } catch (std::exception& e) {
+            m_conn_lock.unlock();
+            throw std::runtime_error("database error - " + std::string(e.what()));
+        }
+
+        for (const auto& row : res) {
+            inames[row.getString("uuid")] = row.getString("name");
+        }
+    }
+
+    return inames;
+}
+
+std::map<std::string, uint32_t> DB::getIDs(const std::vector<std::string>& inames)
+{
+    std::map<std::string, uint32_t> ids;
+
+    for (size_t first = 0; first < inames.size(); first += BULK_CHUNK_SIZE) {
+        size_t last = std::min(first + BULK_CHUNK_SIZE, inames.size());
+
+        // clang-format off
+        std::string qs =
+            " SELECT"
+            "     id_asset_element,"
+            "     name"
+            " FROM"
+            "     t_bios_asset_element"
+            " WHERE"
+            "     name IN (" + inPlaceholders("n", first, last) + ")";
+        // clang-format on
+
+        tntdb::Result res;
+
+        try {
+            m_conn_lock.lock();
+            auto q = m_conn.prepare(qs);
+            for (size_t i = first; i < last; i++) {
+                q.set("n" + std::to_string(i), inames[i]);
+            }
+            res = q.select();
+            m_conn_lock.unlock();
+        } catch (std::exception& e) {
+            m_conn_lock.unlock();
+            throw std::runtime_error("database error - " + std::string(e.what()));
+        }
+
+        for (const auto& row : res) {
+            ids[row.getString("name")] = row.getUnsigned32("id_asset_element");
+        }
+    }
+
+    return ids;
+}
+
+void DB::executeBulk(const std::string& qs)
+{
+    try {
+        m_conn_lock.lock();
+        m_conn.prepare(qs).execute();
+        m_conn_lock.unlock();
+    } catch (std::exception& e) {
+        m_conn_lock.unlock();
+        throw std::runtime_error("database error - " + std::string(e.what()));
+    }
+}
+
+std::vector<std::string> DB::getSubtree(const std::string& iname)
+{
+    // recursive over id_parent, so the depth of the tree is not limited and
+    // every level is an index lookup; UNION stops on a location loop
+    // clang-format off
+    auto q = m_conn.prepareCached(R"(
+        WITH RECURSIVE subtree (id, name) AS (
+            SELECT
+                c.id_asset_element, c.name
+            FROM
+                t_bios_asset_element AS c
+            INNER JOIN
+                t_bios_asset_element AS p ON c.id_parent = p.id_asset_element
+            WHERE
+                p.name = :name
+          UNION
+            SELECT
+                c.id_asset_element, c.name
+            FROM
+                t_bios_asset_element AS c
+            INNER JOIN
+                subtree AS s ON c.id_parent = s.id
+        )
+        SELECT
+            name
+        FROM
+            subtree
+        ORDER BY
+            id
+    )");
+    // clang-format on
+    q.set("name", iname);
+
+    tntdb::Result res;
+
+    try {
+        m_conn_lock.lock();
+        res = q.select();
+        m_conn_lock.unlock();
+    } catch (std::exception& e) {
+        m_conn_lock.unlock();
+        throw std::runtime_error("database error - " + std::string(e.what()));
+    }
+
+    std::vector<std::string> subtree;
+    for (const auto& row : res) {
+        subtree.push_back(row.getString("name"));
+    }
+
+    return subtree;
+}
+
+std::map<std::string, std::vector<std::string>> DB::childrenOf(const std::vector<std::string>& inames)
+{
+    std::map<std::string, std::vector<std::string>> children;
+
+    for (size_t first = 0; first < inames.size(); first += BULK_CHUNK_SIZE) {
+        size_t last = std::min(first + BULK_CHUNK_SIZE, inames.size());
+
+        // clang-format off
+        std::string qs =
+            " SELECT"
+            "     c.name AS name,"
+            "     p.name AS parentName"
+            " FROM"
+            "     t_bios_asset_element AS c"
+            " INNER JOIN"
+            "     t_bios_asset_element AS p ON c.id_parent = p.id_asset_element"
+            " WHERE"
+            "     p.name IN (" + inPlaceholders("n", first, last) + ")";
+        // clang-format on
+
+        tntdb::Result res;
+
+        try {
+            m_conn_lock.lock();
+            auto q = m_conn.prepare(qs);
+            for (size_t i = first; i < last; i++) {
+                q.set("n" + std::to_string(i), inames[i]);
+            }
+            res = q.select();
+            m_conn_lock.unlock();
+        } catch (std::exception& e) {
+            m_conn_lock.unlock();
+            throw std::runtime_error("database error - " + std::string(e.what()));
+        }
+
+        for (const auto& row : res) {
+            children[row.getString("parentName")].push_back(row.getString("name"));
+        }
+    }
+
+    return children;
+}
+
+std::map<std::string, std::vector<std::string>> DB::linkDestinationsOf(const std::vector<std::string>& inames)
+{
+    std::map<std::string, std::vector<std::string>> dests;
+
+    for (size_t first = 0; first < inames.size(); first += BULK_CHUNK_SIZE) {
+        size_t last = std::min(first + BULK_CHUNK_SIZE, inames.size());
+
+        // clang-format off
+        std::string qs =
+            " SELECT"
+            "     s.name AS src,"
+            "     d.name AS dest"
+            " FROM"
+            "     t_bios_asset_link AS l"
+            " INNER JOIN"
+            "     t_bios_asset_element AS s ON l.id_asset_device_src = s.id_asset_element"
+            " INNER JOIN"
+            "     t_bios_asset_element AS d ON l.id_asset_device_dest = d.id_asset_element"
+            " WHERE"
+            "     s.name IN (" + inPlaceholders("n", first, last) + ")";
+        // clang-format on
+
+        tntdb::Result res;
+
+        try {
+            m_conn_lock.lock();
+            auto q = m_conn.prepare(qs);
+            for (size_t i = first; i < last; i++) {
+                q.set("n" + std::to_string(i), inames[i]);
+            }
+            res = q.select();
+            m_conn_lock.unlock();
+        } catch (std::exception& e) {
+            m_conn_lock.unlock();
+            throw std::runtime_error("database error - " + std::string(e.what()));
+        }
+
+        for (const auto& row : res) {
+            dests[row.getString("src")].push_back(row.getString("dest"));
+        }
+    }
+
+    return dests;
+}
+
+int DB::countDataCenters()
+{
+    // clang-format off
+    auto q = m_conn.prepareCached(R"(
+        SELECT
+            COUNT(id_asset_element)
+        FROM
+            t_bios_asset_element
+        WHERE
+            id_type = (
+                SELECT id_asset_element_type
+                FROM   t_bios_asset_element_type
+                WHERE  name = 'datacenter'
+            )
+    )");
+    // clang-format on
+
+    int numDatacenters = 0;
+
+    try {
+        m_conn_lock.lock();
+        numDatacenters = q.selectValue().getInt();
+        m_conn_lock.unlock();
+    } catch (std::exception& e) {
+        m_conn_lock.unlock();
+        throw std::runtime_error("database error - " + std::string(e.what()));
+    }
+
+    return numDatacenters;
+}
+
+void DB::unlinkAll(const std::vector<std::string>& dests)
+{
+    std::vector<uint32_t> ids;
+    for (const auto& id : getIDs(dests)) {
+        ids.push_back(id.second);
+    }
+
+    for (size_t first = 0; first < ids.size(); first += BULK_CHUNK_SIZE) {
+        std::vector<uint32_t> chunk(
+            ids.begin() + long(first), ids.begin() + long(std::min(first + BULK_CHUNK_SIZE, ids.size())));
+
+        executeBulk("DELETE FROM t_bios_asset_link WHERE id_asset_device_dest IN (" + inIds(chunk) + ")");
+    }
+}
+
+void DB::unlinkSources(const std::vector<std::string>& srcs)
+{
+    std::vector<uint32_t> ids;
+    for (const auto& id : getIDs(srcs)) {
+        ids.push_back(id.second);
+    }
+
+    for (size_t first = 0; first < ids.size(); first += BULK_CHUNK_SIZE) {
+        std::vector<uint32_t> chunk(
+            ids.begin() + long(first), ids.begin() + long(std::min(first + BULK_CHUNK_SIZE, ids.size())));
+
+        executeBulk("DELETE FROM t_bios_asset_link WHERE id_asset_device_src IN (" + inIds(chunk) + ")");
+    }
+}
+
+void DB::removeAssets(const std::vector<std::vector<std::string>>& levels)
+{
+    for (const auto& level : levels) {
+        std::vector<uint32_t> ids;
+        for (const auto& id : getIDs(level)) {
+            ids.push_back(id.second);
+        }
+
+        for (size_t first = 0; first < ids.size(); first += BULK_CHUNK_SIZE) {
+            std::vector<uint32_t> chunk(
+                ids.begin() + long(first), ids.begin() + long(std::min(first + BULK_CHUNK_SIZE, ids.size())));
+            std::string in = inIds(chunk);
+
+            // clang-format off
+            executeBulk(
+                " DELETE FROM t_bios_asset_group_relation"
+                " WHERE id_asset_element IN (" + in + ") OR id_asset_group IN (" + in + ")");
+            executeBulk("DELETE FROM t_bios_monitor_asset_relation WHERE id_asset_element IN (" + in + ")");
+            executeBulk("DELETE FROM t_bios_asset_ext_attributes WHERE id_asset_element IN (" + in + ")");
+            executeBulk("DELETE FROM t_bios_asset_element WHERE id_asset_element IN (" + in + ")");
+            // clang-format on
+        }
+    }
+}
+
+void DB::removeAllAssets(const std::vector<std::string>& preserved)
+{
+    std::vector<uint32_t> ids;
+    for (const auto& id : getIDs(preserved)) {
+        ids.push_back(id.second);
+    }
+    std::string in = inIds(ids);
+
+    // rows are selected by the preserved assets, so each table is cleared by a single statement
+    auto notPreserved = [&](const std::string& column) {
+        return ids.empty() ? std::string("1") : column + " NOT IN (" + in + ")";
+    };
+
+    // clang-format off
+    executeBulk(
+        " DELETE FROM t_bios_asset_link"
+        " WHERE " + notPreserved("id_asset_device_src") + " OR " + notPreserved("id_asset_device_dest"));
+    executeBulk(
+        " DELETE FROM t_bios_asset_group_relation"
+        " WHERE " + notPreserved("id_asset_element") + " OR " + notPreserved("id_asset_group"));
+    executeBulk("DELETE FROM t_bios_monitor_asset_relation WHERE " + notPreserved("id_asset_element"));
+    executeBulk("DELETE FROM t_bios_asset_ext_attributes WHERE " + notPreserved("id_asset_element"));
+    // detach the remaining assets from the removed ones, so that elements can go in any order
+    executeBulk(
+        " UPDATE t_bios_asset_element SET id_parent = NULL"
+        " WHERE id_parent IS NOT NULL AND " + notPreserved("id_parent"));
+    executeBulk("DELETE FROM t_bios_asset_element WHERE " + notPreserved("id_asset_element"));
+    // clang-format on
+}
+
+void DB::insertAssets(const std::vector<Asset>& assets)
+{
+    std::vector<std::string> parents;
+    for (const auto& a : assets) {
+        if (!a.getParentIname().empty()) {
+            parents.push_back(a.getParentIname());
+        }
+    }
+    std::map<std::string, uint32_t> parentIds = getIDs(parents);
+    for (const auto& a : assets) {
+        if (!a.getParentIname().empty() && !parentIds.count(a.getParentIname())) {
+            throw std::runtime_error("Could not find parent internal name of " + a.getInternalName());
+        }
+    }
+
+    std::map<std::string, uint32_t> typeIds;
+    std::map<std::string, uint32_t> subtypeIds;
+    for (const auto& a : assets) {
+        if (!typeIds.count(a.getAssetType())) {
+            typeIds[a.getAssetType()] = getTypeID(a.getAssetType());
+        }
+        if (!subtypeIds.count(a.getAssetSubtype())) {
+            subtypeIds[a.getAssetSubtype()] = getSubtypeID(a.getAssetSubtype());
+        }
+    }
+
+    for (size_t first = 0; first < assets.size(); first += BULK_CHUNK_SIZE) {
+        size_t last = std::min(first + BULK_CHUNK_SIZE, assets.size());
+
+        std::stringstream qs;
+        qs << "INSERT INTO t_bios_asset_element"
+           << " (name, id_type, id_subtype, id_parent, status, priority, asset_tag, id_secondary) VALUES ";
+        for (size_t i = first; i < last; i++) {
+            qs << (i != first ? ", " : "") << "(:name" << i << ", :type" << i << ", :subtype" << i << ", :parent"
+               << i << ", :status" << i << ", :priority" << i << ", :tag" << i << ", :secondary" << i << ")";
+        }
+
+        try {
+            m_conn_lock.lock();
+            auto q = m_conn.prepare(qs.str());
+            for (size_t i = first; i < last; i++) {
+                const Asset&      a   = assets[i];
+                const std::string idx = std::to_string(i);
+
+                uint32_t parentId = a.getParentIname().empty() ? 0 : parentIds[a.getParentIname()];
+
+                q.set("name" + idx, a.getInternalName());
+                q.set("type" + idx, typeIds[a.getAssetType()]);
+                q.set("subtype" + idx, subtypeIds[a.getAssetSubtype()]);
+                parentId == 0 ? q.setNull("parent" + idx) : q.set("parent" + idx, parentId);
+                // devices consume the license, they are inserted as non active and updated after activation
+                q.set("status" + idx,
+                    assetStatusToString(
+                        a.getAssetType() == TYPE_DEVICE ? fty::AssetStatus::Nonactive : a.getAssetStatus()));
+                q.set("priority" + idx, a.getPriority());
+                a.getAssetTag().empty() ? q.setNull("tag" + idx) : q.set("tag" + idx, a.getAssetTag());
+                a.getSecondaryID().empty() ? q.setNull("secondary" + idx)
+                                           : q.set("secondary" + idx, a.getSecondaryID());
+            }
+            q.execute();
+            m_conn_lock.unlock();
+        } catch (std::exception& e) {
+            m_conn_lock.unlock();
+            throw std::runtime_error("database error - " + std::string(e.what()));
+        }
+    }
+}
+
+void DB::insertExtMaps(const std::vector<Asset>& assets)
+{
+    std::vector<std::string> names;
+    for (const auto& a : assets) {
+        names.push_back(a.getInternalName());
+    }
+    std::map<std::string, uint32_t> ids = getIDs(names);
+
+    using ExtRow = std::tuple<uint32_t, std::string, std::string, bool>;
+
+    std::vector<ExtRow> rows;
+    for (const auto& a : assets) {
+        auto found = ids.find(a.getInternalName());
+        if (found == ids.end()) {
+            throw std::runtime_error("Asset " + a.getInternalName() + " not found");
+        }
+        for (const auto& it : a.getExt()) {
+            // empty attributes are not stored
+            if (!it.second.getValue().empty()) {
+                rows.emplace_back(found->second, it.first, it.second.getValue(), it.second.isReadOnly());
+            }
+        }
+    }
+
+    for (size_t first = 0; first < rows.size(); first += BULK_CHUNK_SIZE) {
+        size_t last = std::min(first + BULK_CHUNK_SIZE, rows.size());
+
+        std::stringstream qs;
+        qs << "INSERT INTO t_bios_asset_ext_attributes (keytag, value, id_asset_element, read_only) VALUES ";
+        for (size_t i = first; i < last; i++) {
+            qs << (i != first ? ", " : "") << "(:key" << i << ", :value" << i << ", :assetId" << i << ", :readOnly"
+               << i << ")";
+        }
+
+        try {
+            m_conn_lock.lock();
+            auto q = m_conn.prepare(qs.str());
+            for (size_t i = first; i < last; i++) {
+                const std::string idx = std::to_string(i);
+                q.set("assetId" + idx, std::get<0>(rows[i]));
+                q.set("key" + idx, std::get<1>(rows[i]));
+                q.set("value" + idx, std::get<2>(rows[i]));
+                q.set("readOnly" + idx, std::get<3>(rows[i]));
+            }
+            q.execute();
+            m_conn_lock.unlock();
+        } catch (std::exception& e) {
+            m_conn_lock.unlock();
+            throw std::runtime_error("database error - " + std::string(e.what()));
+        }
+    }
+}
+
+void DB::insertLinks(const std::vector<Asset>& assets)
+{
+    std::vector<std::string> names;
+    for (const auto& a : assets) {
+        names.push_back(a.getInternalName());
+        for (const auto& l : a.getLinkedAssets()) {
+            names.push_back(l.sourceId);
+        }
+    }
+    std::map<std::string, uint32_t> ids = getIDs(names);
+
+    struct LinkRow
+    {
+        uint32_t    src;
+        std::string srcOut;
+        uint32_t    dest;
+        std::string destIn;
+        int         linkType;
+    };
+
+    std::vector<LinkRow> rows;
+    for (const auto& a : assets) {
+        auto dest = ids.find(a.getInternalName());
+        if (dest == ids.end()) {
+            throw std::runtime_error("Asset " + a.getInternalName() + " not found");
+        }
+
+        const auto& links = a.getLinkedAssets();
+        for (auto l = links.begin(); l != links.end(); l++) {
+            // same link listed twice, inserted once
+            if (std::find(links.begin(), l, *l) != l) {
+                continue;
+            }
+            auto src = ids.find(l->sourceId);
+            if (src == ids.end()) {
+                throw std::runtime_error("Link source " + l->sourceId + " of " + a.getInternalName() + " not found");
+            }
+            rows.push_back({src->second, l->srcOut, dest->second, l->destIn, l->linkType});
+        }
+    }
+
+    for (size_t first = 0; first < rows.size(); first += BULK_CHUNK_SIZE) {
+        size_t last = std::min(first + BULK_CHUNK_SIZE, rows.size());
+
+        std::stringstream qs;
+        qs << "INSERT INTO t_bios_asset_link"
+           << " (id_asset_device_src, src_out, id_asset_device_dest, dest_in, id_asset_link_type) VALUES ";
+        for (size_t i = first; i < last; i++) {
+            qs << (i != first ? ", " : "") << "(:src" << i << ", :srcOut" << i << ", :dest" << i << ", :destIn" << i
+               << ", :linkType" << i << ")";
+        }
+
+        try {
+            m_conn_lock.lock();
+            auto q = m_conn.prepare(qs.str());
+            for (size_t i = first; i < last; i++) {
+                const LinkRow&    r   = rows[i];
+                const std::string idx = std::to_string(i);
+                q.set("src" + idx, r.src);
+                q.set("dest" + idx, r.dest);
+                r.srcOut.empty() ? q.setNull("srcOut" + idx) : q.set("srcOut" + idx, r.srcOut);
+                r.destIn.empty() ? q.setNull("destIn" + idx) : q.set("destIn" + idx, r.destIn);
+                q.set("linkType" + idx, r.linkType);
+            }
+            q.execute();
+            m_conn_lock.unlock();
+        } catch (std::exception& e) {
+            m_conn_lock.unlock();
+            throw std::runtime_error("database error - " + std::string(e.what()));
+        }
+    }
+}
+
 } // namespace fty
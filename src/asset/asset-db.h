@@ -74,8 +74,29 @@ public:
 
     std::vector<std::string> listAssets(std::map<std::string, std::vector<std::string>> filters);
     std::vector<std::string> listAllAssets();
+    std::vector<std::string> listAssetsPage(
+        const std::string& after, size_t limit, const std::vector<std::string>& excludedTypes);
+
+    std::vector<Asset>                 loadAssets(const std::vector<std::string>& inames, bool loadLinks = true);
+    std::map<std::string, std::string> inamesByUuids(const std::vector<std::string>& uuids);
+
+    std::vector<std::string>                        getSubtree(const std::string& iname);
+    std::map<std::string, std::vector<std::string>> childrenOf(const std::vector<std::string>& inames);
+    std::map<std::string, std::vector<std::string>> linkDestinationsOf(const std::vector<std::string>& inames);
+    int                                             countDataCenters();
+    void                                            unlinkAll(const std::vector<std::string>& dests);
+    void                                            unlinkSources(const std::vector<std::string>& srcs);
+    void removeAssets(const std::vector<std::vector<std::string>>& levels);
+    void removeAllAssets(const std::vector<std::string>& preserved);
+
+    void insertAssets(const std::vector<Asset>& assets);
+    void insertExtMaps(const std::vector<Asset>& assets);
+    void insertLinks(const std::vector<Asset>& assets);
 
 private:
+    std::map<std::string, uint32_t> getIDs(const std::vector<std::string>& inames);
+    void                            executeBulk(const std::string& qs);
+
     DB(bool test = false);
     std::mutex                m_conn_lock;
     mutable tntdb::Connection m_conn;
@@ -0,0 +1,147 @@
+/*  =========================================================================
+    asset_asset_json_cache - asset/asset-json-cache
+
+    Copyright (C) 2016 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    asset_asset_json_cache - asset/asset-json-cache
+@discuss
+@end
+*/
+
+#include "asset-json-cache.h"
+#include "include/asset/conversion/json.h"
+
+namespace fty {
+
+// compare everything which ends up in the JSON representation of an asset
+// (Asset::operator== ignores the ext "updated" flags and the parents list)
+static bool sameSerialization(const Asset& l, const Asset& r)
+{
+    if (l != r) {
+        return false;
+    }
+
+    for (auto lIt = l.getExt().begin(), rIt = r.getExt().begin(); lIt != l.getExt().end(); ++lIt, ++rIt) {
+        if (lIt->second.wasUpdated() != rIt->second.wasUpdated()) {
+            return false;
+        }
+    }
+
+    const auto lParents = l.getParentsList();
+    const auto rParents = r.getParentsList();
+
+    if (lParents.has_value() != rParents.has_value()) {
+        return false;
+    }
+    if (lParents.has_value()) {
+        if (lParents->size() != rParents->size()) {
+            return false;
+        }
+        for (size_t i = 0; i < lParents->size(); i++) {
+            if (!sameSerialization(lParents->at(i), rParents->at(i))) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+AssetJsonCache::AssetJsonCache(size_t maxEntries)
+    : m_maxEntries(maxEntries)
+{
+}
+
+std::string AssetJsonCache::toJson(const Asset& asset)
+{
+    const std::string& iname = asset.getInternalName();
+
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+
+        auto found = m_entries.find(iname);
+        if (found != m_entries.end()) {
+            if (sameSerialization(found->second.snapshot, asset)) {
+                m_hits++;
+                m_lru.splice(m_lru.begin(), m_lru, found->second.lru);
+                return found->second.json;
+            }
+            // asset changed since it was cached
+            m_lru.erase(found->second.lru);
+            m_entries.erase(found);
+        }
+        m_misses++;
+    }
+
+    // serialize outside of the lock
+    std::string json = conversion::toJson(asset);
+
+    if (iname.empty() || m_maxEntries == 0) {
+        return json;
+    }
+
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    if (m_entries.find(iname) == m_entries.end()) {
+        while (m_entries.size() >= m_maxEntries) {
+            m_entries.erase(m_lru.back());
+            m_lru.pop_back();
+        }
+
+        m_lru.push_front(iname);
+        m_entries.emplace(iname, Entry{asset, json, m_lru.begin()});
+    }
+
+    return json;
+}
+
+void AssetJsonCache::invalidate(const std::string& iname)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    auto found = m_entries.find(iname);
+    if (found != m_entries.end()) {
+        m_lru.erase(found->second.lru);
+        m_entries.erase(found);
+    }
+}
+
+void AssetJsonCache::clear()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    m_entries.clear();
+    m_lru.clear();
+}
+
+uint64_t AssetJsonCache::hits() const
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    return m_hits;
+}
+
+uint64_t AssetJsonCache::misses() const
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    return m_misses;
+}
+
+} // namespace fty
@@ -0,0 +1,66 @@
+/*  =========================================================================
+    asset_asset_json_cache - asset/asset-json-cache
+
+    Copyright (C) 2016 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+#include "include/fty_asset_dto.h"
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace fty {
+
+/// Cache of the JSON representation of assets
+/// Each entry keeps a snapshot of the serialized asset: an entry is reused only as long as the asset handed to
+/// toJson() is identical to the snapshot, so a changed asset is never served stale. Local writes additionally
+/// drop the entry with invalidate().
+class AssetJsonCache
+{
+public:
+    explicit AssetJsonCache(size_t maxEntries = 10000);
+
+    std::string toJson(const Asset& asset);
+    void        invalidate(const std::string& iname);
+    void        clear();
+
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+private:
+    using LruList = std::list<std::string>;
+
+    struct Entry
+    {
+        Asset             snapshot;
+        std::string       json;
+        LruList::iterator lru;
+    };
+
+    mutable std::mutex                     m_lock;
+    size_t                                 m_maxEntries;
+    std::unordered_map<std::string, Entry> m_entries;
+    LruList                                m_lru;
+    uint64_t                               m_hits   = 0;
+    uint64_t                               m_misses = 0;
+};
+
+} // namespace fty
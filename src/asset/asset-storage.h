@@ -74,6 +74,36 @@ public:
 
     virtual std::vector<std::string> listAssets(std::map<std::string, std::vector<std::string>> filters) = 0;
     virtual std::vector<std::string> listAllAssets()                                                     = 0;
+    // names greater than after, in ascending order
+    virtual std::vector<std::string> listAssetsPage(
+        const std::string& after, size_t limit, const std::vector<std::string>& excludedTypes) = 0;
+
+    // bulk operations (inames which are not found are skipped)
+    virtual std::vector<Asset> loadAssets(const std::vector<std::string>& inames, bool loadLinks = true) = 0;
+    virtual std::map<std::string, std::string> inamesByUuids(const std::vector<std::string>& uuids)     = 0;
+
+    // bulk operations used by the deletion planner
+    // internal names of all the descendants of iname
+    virtual std::vector<std::string> getSubtree(const std::string& iname) = 0;
+    // iname -> internal names of its children
+    virtual std::map<std::string, std::vector<std::string>> childrenOf(const std::vector<std::string>& inames) = 0;
+    // iname -> internal names of the destinations of the links it is the source of
+    virtual std::map<std::string, std::vector<std::string>> linkDestinationsOf(
+        const std::vector<std::string>& inames) = 0;
+
+    virtual int  countDataCenters()                                                = 0;
+    virtual void unlinkAll(const std::vector<std::string>& dests)                  = 0;
+    virtual void unlinkSources(const std::vector<std::string>& srcs)               = 0;
+    // levels are removed in the given order, so children must come before their parents
+    virtual void removeAssets(const std::vector<std::vector<std::string>>& levels) = 0;
+    // removes every asset but the preserved ones, with their links, groups and ext attributes
+    virtual void removeAllAssets(const std::vector<std::string>& preserved) = 0;
+
+    // bulk operations used by the restore (parents and link sources must already be in the database,
+    // devices are inserted as non active, they are activated one by one)
+    virtual void insertAssets(const std::vector<Asset>& assets)  = 0;
+    virtual void insertExtMaps(const std::vector<Asset>& assets) = 0;
+    virtual void insertLinks(const std::vector<Asset>& assets)   = 0;
 };
 
 } // namespace fty
@@ -29,7 +29,9 @@
 #include "asset-utils.h"
 #include <cxxtools/jsondeserializer.h>
 #include <cxxtools/jsonserializer.h>
+#include <cstring>
 #include <sstream>
+#include <vector>
 
 namespace fty { namespace assetutils {
     // create response (data is a single string)
@@ -151,4 +153,228 @@ namespace fty { namespace assetutils {
 
         return si;
     }
+
+    // compact binary helpers
+
+    void writeVarint(std::string& out, unsigned long v)
+    {
+        while (v >= 0x80) {
+            out += char((v & 0x7f) | 0x80);
+            v >>= 7;
+        }
+        out += char(v);
+    }
+
+    unsigned long readVarint(const std::string& in, size_t& pos)
+    {
+        unsigned long v     = 0;
+        unsigned int  shift = 0;
+        for (;;) {
+            if (pos >= in.size()) {
+                throw std::runtime_error("Truncated binary data");
+            }
+            if (shift >= sizeof(v) * 8) {
+                throw std::runtime_error("Invalid varint in binary data");
+            }
+            uint8_t b = static_cast<uint8_t>(in[pos++]);
+            v |= static_cast<unsigned long>(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return v;
+            }
+            shift += 7;
+        }
+    }
+
+    void writeString(std::string& out, const std::string& str)
+    {
+        writeVarint(out, str.size());
+        out += str;
+    }
+
+    std::string readString(const std::string& in, size_t& pos)
+    {
+        unsigned long size = readVarint(in, pos);
+        if (size > in.size() - pos) {
+            throw std::runtime_error("Truncated binary data");
+        }
+        std::string str = in.substr(pos, size);
+        pos += size;
+        return str;
+    }
+
+    // Compressed data is a sequence of tokens: literal length, literal bytes, then (unless the data ends)
+    // match offset and match length - MIN_MATCH. All numbers are varints.
+    static constexpr size_t MIN_MATCH = 4;
+    static constexpr int    HASH_BITS = 14;
+
+    std::string compress(const std::string& data)
+    {
+        static constexpr size_t NONE = size_t(-1);
+
+        std::vector<size_t> table(size_t(1) << HASH_BITS, NONE);
+        std::string         out;
+
+        auto hash = [&](size_t pos) {
+            uint32_t v;
+            std::memcpy(&v, data.data() + pos, sizeof(v));
+            return (v * 2654435761u) >> (32 - HASH_BITS);
+        };
+
+        size_t anchor = 0;
+        size_t pos    = 0;
+        while (pos + MIN_MATCH <= data.size()) {
+            uint32_t h         = hash(pos);
+            size_t   candidate = table[h];
+            table[h]           = pos;
+
+            if (candidate == NONE || data.compare(candidate, MIN_MATCH, data, pos, MIN_MATCH) != 0) {
+                pos++;
+                continue;
+            }
+
+            size_t len = MIN_MATCH;
+            while (pos + len < data.size() && data[candidate + len] == data[pos + len]) {
+                len++;
+            }
+
+            writeVarint(out, pos - anchor);
+            out.append(data, anchor, pos - anchor);
+            writeVarint(out, pos - candidate);
+            writeVarint(out, len - MIN_MATCH);
+
+            pos += len;
+            anchor = pos;
+        }
+
+        // last literals
+        writeVarint(out, data.size() - anchor);
+        out.append(data, anchor, data.size() - anchor);
+
+        return out;
+    }
+
+    std::string uncompress(const std::string& data, size_t size)
+    {
+        std::string out;
+        out.reserve(size);
+
+        size_t pos = 0;
+        for (;;) {
+            unsigned long literals = readVarint(data, pos);
+            if (literals > data.size() - pos || literals > size - out.size()) {
+                throw std::runtime_error("Invalid compressed data");
+            }
+            out.append(data, pos, literals);
+            pos += literals;
+
+            if (pos == data.size()) {
+                break;
+            }
+
+            unsigned long offset = readVarint(data, pos);
+            unsigned long len    = readVarint(data, pos) + MIN_MATCH;
+            if (offset == 0 || offset > out.size() || len > size - out.size()) {
+                throw std::runtime_error("Invalid compressed data");
+            }
+            // matches may overlap the bytes they produce
+            for (size_t from = out.size() - offset; len > 0; len--) {
+                out += out[from++];
+            }
+        }
+
+        if (out.size() != size) {
+            throw std::runtime_error("Invalid compressed data size");
+        }
+        return out;
+    }
+
+    uint32_t crc32(const std::string& data)
+    {
+        static const std::vector<uint32_t> table = [] {
+            std::vector<uint32_t> t(256);
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                t[i] = c;
+            }
+            return t;
+        }();
+
+        uint32_t crc = 0xFFFFFFFFu;
+        for (char c : data) {
+            crc = table[(crc ^ static_cast<uint8_t>(c)) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    static constexpr const char BASE64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string base64Encode(const std::string& data)
+    {
+        std::string out;
+        out.reserve((data.size() + 2) / 3 * 4);
+
+        for (size_t i = 0; i < data.size(); i += 3) {
+            uint32_t n = uint32_t(static_cast<uint8_t>(data[i])) << 16;
+            if (i + 1 < data.size()) {
+                n |= uint32_t(static_cast<uint8_t>(data[i + 1])) << 8;
+            }
+            if (i + 2 < data.size()) {
+                n |= uint32_t(static_cast<uint8_t>(data[i + 2]));
+            }
+            out += BASE64[(n >> 18) & 0x3F];
+            out += BASE64[(n >> 12) & 0x3F];
+            out += i + 1 < data.size() ? BASE64[(n >> 6) & 0x3F] : '=';
+            out += i + 2 < data.size() ? BASE64[n & 0x3F] : '=';
+        }
+
+        return out;
+    }
+
+    std::string base64Decode(const std::string& data)
+    {
+        if (data.size() % 4 != 0) {
+            throw std::runtime_error("Invalid base64 data");
+        }
+
+        auto value = [](char c) -> uint32_t {
+            const char* found = std::strchr(BASE64, c);
+            if (c == '\0' || found == nullptr) {
+                throw std::runtime_error("Invalid base64 data");
+            }
+            return uint32_t(found - BASE64);
+        };
+
+        std::string out;
+        out.reserve(data.size() / 4 * 3);
+
+        for (size_t i = 0; i < data.size(); i += 4) {
+            bool last = (i + 4 == data.size());
+            // padding is only allowed at the end
+            size_t padding = (data[i + 3] == '=') + (data[i + 2] == '=');
+            if ((padding && !last) || (data[i + 2] == '=' && data[i + 3] != '=')) {
+                throw std::runtime_error("Invalid base64 data");
+            }
+
+            uint32_t n = (value(data[i]) << 18) | (value(data[i + 1]) << 12);
+            if (padding < 2) {
+                n |= value(data[i + 2]) << 6;
+            }
+            if (padding < 1) {
+                n |= value(data[i + 3]);
+            }
+
+            out += char((n >> 16) & 0xFF);
+            if (padding < 2) {
+                out += char((n >> 8) & 0xFF);
+            }
+            if (padding < 1) {
+                out += char(n & 0xFF);
+            }
+        }
+
+        return out;
+    }
 }} // namespace fty::assetutils
@@ -20,6 +20,7 @@
 */
 
 #pragma once
+#include <cstdint>
 #include <cxxtools/serializationinfo.h>
 #include <fty_common_messagebus.h>
 #include <string>
@@ -40,4 +41,23 @@ namespace fty { namespace assetutils {
     // JSON serialization/deserialization
     std::string                 serialize(const cxxtools::SerializationInfo& si);
     cxxtools::SerializationInfo deserialize(const std::string& json);
+
+    // compact binary helpers (SRR 2.0), readers throw std::runtime_error on malformed input
+    // unsigned LEB128 varints
+    void          writeVarint(std::string& out, unsigned long v);
+    unsigned long readVarint(const std::string& in, size_t& pos);
+    // length-prefixed strings
+    void        writeString(std::string& out, const std::string& str);
+    std::string readString(const std::string& in, size_t& pos);
+
+    // LZ77 block compression, size is the size of the uncompressed data
+    std::string compress(const std::string& data);
+    std::string uncompress(const std::string& data, size_t size);
+
+    // CRC-32 (IEEE 802.3)
+    uint32_t crc32(const std::string& data);
+
+    // base64 (RFC 4648)
+    std::string base64Encode(const std::string& data);
+    std::string base64Decode(const std::string& data);
 }} // namespace fty::assetutils
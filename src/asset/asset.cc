@@ -23,14 +23,19 @@
 #include "asset-db-test.h"
 #include "asset-db.h"
 #include "asset-storage.h"
+#include "asset-utils.h"
 #include "include/asset/conversion/full-asset.h"
 #include <algorithm>
 #include <fty_asset_activator.h>
 #include <fty_common_db_dbpath.h>
 #include <functional>
+#include <map>
 #include <memory>
+#include <set>
 #include <sstream>
 #include <time.h>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <uuid/uuid.h>
 
@@ -261,19 +266,18 @@ bool AssetImpl::hasLogicalAsset() const
     return getExt().find("logical_asset") != getExt().end();
 }
 
+// types of assets which are discovered, not created by the user
+static const std::vector<std::string>& virtualTypes()
+{
+    static const std::vector<std::string> types = {TYPE_CLUSTER, TYPE_HYPERVISOR, TYPE_VIRTUAL_MACHINE,
+        TYPE_STORAGE_SERVICE, TYPE_VAPP, TYPE_CONNECTOR, TYPE_SERVER, TYPE_PLANNER, TYPE_PLAN};
+    return types;
+}
+
 bool AssetImpl::isVirtual() const
 {
-    return (
-        (getAssetType() == TYPE_CLUSTER) ||
-        (getAssetType() == TYPE_HYPERVISOR) ||
-        (getAssetType() == TYPE_VIRTUAL_MACHINE) ||
-        (getAssetType() == TYPE_STORAGE_SERVICE) ||
-        (getAssetType() == TYPE_VAPP) ||
-        (getAssetType() == TYPE_CONNECTOR) ||
-        (getAssetType() == TYPE_SERVER) ||
-        (getAssetType() == TYPE_PLANNER) ||
-        (getAssetType() == TYPE_PLAN)
-    );
+    const auto& types = virtualTypes();
+    return std::find(types.begin(), types.end(), getAssetType()) != types.end();
 }
 
 bool AssetImpl::hasLinkedAssets() const
@@ -638,6 +642,133 @@ void AssetImpl::srrToAsset(const cxxtools::SerializationInfo& si, AssetImpl& ass
     }
 }
 
+// SRR 2.0 block: string table (types, subtypes, keytags, parent and link inames, ports), then the assets
+// (name, status, type, subtype, parent, priority, tag, secondary id, links, ext entries)
+std::string AssetImpl::assetsToSrrBlock(const std::vector<AssetImpl>& assets)
+{
+    using namespace assetutils;
+
+    std::unordered_map<std::string, unsigned long> index;
+    std::vector<const std::string*>                strings;
+
+    auto intern = [&](const std::string& str) {
+        auto inserted = index.emplace(str, strings.size());
+        if (inserted.second) {
+            strings.push_back(&inserted.first->first);
+        }
+        return inserted.first->second;
+    };
+
+    std::string records;
+    for (const auto& a : assets) {
+        writeString(records, a.getInternalName());
+        records += char(a.getAssetStatus());
+        writeVarint(records, intern(a.getAssetType()));
+        writeVarint(records, intern(a.getAssetSubtype()));
+        writeVarint(records, intern(a.getParentIname()));
+        writeVarint(records, static_cast<unsigned int>(a.getPriority()));
+        writeString(records, a.getAssetTag());
+        writeString(records, a.getSecondaryID());
+
+        writeVarint(records, a.getLinkedAssets().size());
+        for (const auto& l : a.getLinkedAssets()) {
+            writeVarint(records, intern(l.sourceId));
+            writeVarint(records, intern(l.srcOut));
+            writeVarint(records, intern(l.destIn));
+            writeVarint(records, static_cast<unsigned int>(l.linkType));
+        }
+
+        writeVarint(records, a.getExt().size());
+        for (const auto& e : a.getExt()) {
+            writeVarint(records, intern(e.first));
+            writeString(records, e.second.getValue());
+            records += char(e.second.isReadOnly() ? 1 : 0);
+        }
+    }
+
+    std::string block;
+    writeVarint(block, strings.size());
+    for (const auto* str : strings) {
+        writeString(block, *str);
+    }
+    writeVarint(block, assets.size());
+    block += records;
+
+    return block;
+}
+
+std::vector<AssetImpl> AssetImpl::srrBlockToAssets(const std::string& block)
+{
+    using namespace assetutils;
+
+    size_t pos = 0;
+
+    std::vector<std::string> strings;
+    unsigned long            count = readVarint(block, pos);
+    for (unsigned long i = 0; i < count; i++) {
+        strings.push_back(readString(block, pos));
+    }
+
+    auto stringAt = [&](unsigned long i) -> const std::string& {
+        if (i >= strings.size()) {
+            throw std::runtime_error("Invalid string index in SRR block");
+        }
+        return strings[i];
+    };
+    auto readByte = [&]() {
+        if (pos >= block.size()) {
+            throw std::runtime_error("Truncated SRR block");
+        }
+        return static_cast<uint8_t>(block[pos++]);
+    };
+
+    std::vector<AssetImpl> assets;
+    count = readVarint(block, pos);
+    for (unsigned long i = 0; i < count; i++) {
+        AssetImpl a;
+        a.setInternalName(readString(block, pos));
+
+        uint8_t status = readByte();
+        if (status > uint8_t(AssetStatus::Nonactive)) {
+            throw std::runtime_error("Invalid status in SRR block");
+        }
+        a.setAssetStatus(AssetStatus(status));
+        a.setAssetType(stringAt(readVarint(block, pos)));
+        a.setAssetSubtype(stringAt(readVarint(block, pos)));
+        a.setParentIname(stringAt(readVarint(block, pos)));
+        a.setPriority(static_cast<int>(readVarint(block, pos)));
+        a.setAssetTag(readString(block, pos));
+        a.setSecondaryID(readString(block, pos));
+
+        std::vector<AssetLink> links;
+        unsigned long          linkCount = readVarint(block, pos);
+        for (unsigned long j = 0; j < linkCount; j++) {
+            AssetLink l;
+            l.sourceId = stringAt(readVarint(block, pos));
+            l.srcOut   = stringAt(readVarint(block, pos));
+            l.destIn   = stringAt(readVarint(block, pos));
+            l.linkType = static_cast<int>(readVarint(block, pos));
+            links.push_back(l);
+        }
+        a.setLinkedAssets(links);
+
+        unsigned long extCount = readVarint(block, pos);
+        for (unsigned long j = 0; j < extCount; j++) {
+            const std::string& key   = stringAt(readVarint(block, pos));
+            std::string        value = readString(block, pos);
+            a.setExtEntry(key, value, readByte() != 0);
+        }
+
+        assets.push_back(a);
+    }
+
+    if (pos != block.size()) {
+        throw std::runtime_error("Trailing bytes in SRR block");
+    }
+
+    return assets;
+}
+
 std::vector<std::string> AssetImpl::list(const AssetFilters& filters)
 {
     return getStorage().listAssets(filters);
@@ -648,6 +779,11 @@ std::vector<std::string> AssetImpl::listAll()
     return getStorage().listAllAssets();
 }
 
+std::vector<std::string> AssetImpl::listPhysical(const std::string& after, size_t limit)
+{
+    return getStorage().listAssetsPage(after, limit, virtualTypes());
+}
+
 void AssetImpl::load()
 {
     m_storage.loadAsset(getInternalName(), *this);
@@ -655,124 +791,363 @@ void AssetImpl::load()
     m_storage.loadLinkedAssets(*this);
 }
 
-static void addSubTree(const std::string& internalName, std::vector<AssetImpl>& toDel)
+static void addSubTree(
+    const std::string& internalName, std::vector<std::string>& toDel, std::unordered_set<std::string>& seen)
 {
-    std::vector<std::pair<AssetImpl, int>> stack;
-
-    AssetImpl a(internalName);
-
-    AssetImpl& ref = a;
-
-    bool         end  = false;
-    unsigned int next = 0;
-
-    while (!end) {
-        std::vector<std::string> children = getChildren(ref);
-
-        if (next < children.size()) {
-            stack.push_back(std::make_pair(ref, next + 1));
-
-            ref  = children[next];
-            next = 0;
-
-            auto found = std::find_if(toDel.begin(), toDel.end(), [&](const AssetImpl& a) {
-                return a.getInternalName() == ref.getInternalName();
-            });
-            if (found == toDel.end()) {
-                toDel.push_back(ref);
-            }
-        } else {
-            if (stack.empty()) {
-                end = true;
-            } else {
-                ref  = stack.back().first;
-                next = stack.back().second;
-                stack.pop_back();
-            }
+    for (const std::string& iname : getStorage().getSubtree(internalName)) {
+        if (seen.insert(iname).second) {
+            toDel.push_back(iname);
         }
     }
 }
 
 DeleteStatus AssetImpl::deleteList(const std::vector<std::string>& assets, bool recursive, bool removeLastDC)
 {
-    std::vector<AssetImpl> toDel;
+    AssetStorage& storage = getStorage();
 
-    DeleteStatus deleted;
+    std::vector<std::string>        names;
+    std::unordered_set<std::string> seen;
 
     for (const std::string& iname : assets) {
         try {
-            AssetImpl a(iname);
-            toDel.push_back(a);
-
+            if (seen.insert(iname).second) {
+                names.push_back(iname);
+            }
             if (recursive) {
-                addSubTree(iname, toDel);
+                addSubTree(iname, names, seen);
             }
         } catch (std::exception& e) {
             log_warning("Error while loading asset %s. %s", iname.c_str(), e.what());
         }
     }
 
-    auto isAnyParent = [&](const AssetImpl& l, const AssetImpl& r) {
-        std::vector<std::pair<std::string, int>> lTree;
-        auto                                     ptr = l;
-        // path to root of L
-        int distL = 0;
-        while (ptr.getParentIname() != "") {
-            lTree.push_back(std::make_pair(ptr.getInternalName(), distL));
-            std::string parentIname = ptr.getParentIname();
-            ptr                     = AssetImpl(parentIname);
-            distL++;
-        }
-
-        int distR = 0;
-        ptr       = r;
-        while (ptr.getParentIname() != "") {
-            // look for LCA, if exists
-            auto found = std::find_if(lTree.begin(), lTree.end(), [&](const std::pair<std::string, int>& p) {
-                return p.first == ptr.getInternalName();
-            });
-            if (found != lTree.end()) {
-                distL = found->second; // distance of L from LCA
-                break;
-            }
+    // load every asset of the plan once, keeping the requested order
+    std::map<std::string, Asset> loaded;
+    for (const Asset& a : storage.loadAssets(names)) {
+        loaded[a.getInternalName()] = a;
+    }
 
-            ptr = AssetImpl(ptr.getParentIname());
-            distR++;
+    std::vector<AssetImpl> toDel;
+    for (const std::string& iname : names) {
+        auto found = loaded.find(iname);
+        if (found == loaded.end()) {
+            log_warning("Error while loading asset %s. Asset not found", iname.c_str());
+            continue;
         }
-        // farthest node from LCA gets deleted first
-        return distL > distR;
-    };
+        AssetImpl a;
+        static_cast<Asset&>(a) = found->second;
+        toDel.push_back(a);
+    }
+
+    // depth of each asset, ancestors outside of the plan are loaded level by level
+    std::map<std::string, std::string> parents;
+    for (const auto& a : toDel) {
+        parents[a.getInternalName()] = a.getParentIname();
+    }
+
+    std::vector<std::string> toLoad;
+    for (const auto& a : toDel) {
+        toLoad.push_back(a.getParentIname());
+    }
+
+    // avoid infinite loop
+    const unsigned short maxLevels = 255;
+
+    for (unsigned short level = 0; level < maxLevels; level++) {
+        std::sort(toLoad.begin(), toLoad.end());
+        toLoad.erase(std::unique(toLoad.begin(), toLoad.end()), toLoad.end());
+        toLoad.erase(std::remove_if(toLoad.begin(), toLoad.end(),
+                         [&](const std::string& iname) {
+                             return iname.empty() || parents.count(iname);
+                         }),
+            toLoad.end());
+
+        if (toLoad.empty()) {
+            break;
+        }
+
+        std::vector<std::string> next;
+        for (const Asset& p : storage.loadAssets(toLoad, false)) {
+            parents[p.getInternalName()] = p.getParentIname();
+            next.push_back(p.getParentIname());
+        }
+        toLoad = next;
+    }
 
-    // sort by deletion order
-    std::sort(toDel.begin(), toDel.end(), [&](const AssetImpl& l, const AssetImpl& r) {
-        return isAnyParent(l, r);
+    std::map<std::string, int> depth;
+    for (const auto& a : toDel) {
+        int  d     = 0;
+        auto found = parents.find(a.getInternalName());
+        while (found != parents.end() && !found->second.empty() && d < maxLevels) {
+            found = parents.find(found->second);
+            d++;
+        }
+        depth[a.getInternalName()] = d;
+    }
+
+    // deepest assets get deleted first
+    std::stable_sort(toDel.begin(), toDel.end(), [&](const AssetImpl& l, const AssetImpl& r) {
+        return depth[l.getInternalName()] > depth[r.getInternalName()];
     });
 
-    // remove all links
-    for (auto& a : toDel) {
-        a.unlinkAll();
+    std::vector<std::string> planned;
+    for (const auto& a : toDel) {
+        planned.push_back(a.getInternalName());
+    }
+    std::set<std::string> inPlan(planned.begin(), planned.end());
+
+    std::map<std::string, std::vector<std::string>> children;
+    std::map<std::string, std::vector<std::string>> linkDests;
+    int                                             dataCenters = 0;
+    if (!toDel.empty()) {
+        children    = storage.childrenOf(planned);
+        linkDests   = storage.linkDestinationsOf(planned);
+        dataCenters = storage.countDataCenters();
     }
 
-    for (auto& d : toDel) {
-        // after deleting assets, children list may change -> reload
-        d.load();
+    // check every asset against the plan, children are always checked before their parent
+    std::vector<std::string>              status(toDel.size());
+    std::vector<size_t>                   approved;
+    std::set<std::string>                 removed;
+    std::vector<size_t>                   deactivated;
+    std::vector<std::vector<std::string>> levels;
+
+    for (size_t i = 0; i < toDel.size(); i++) {
+        AssetImpl&         d     = toDel[i];
+        const std::string& iname = d.getInternalName();
+
+        std::string error;
+
+        if (RC0 == iname) {
+            error = "cannot delete RC-0";
+        } else if (std::any_of(linkDests[iname].begin(), linkDests[iname].end(), [&](const std::string& dest) {
+                       return !inPlan.count(dest);
+                   })) {
+            error = "it the source of a link";
+        } else if (std::any_of(children[iname].begin(), children[iname].end(), [&](const std::string& child) {
+                       return !removed.count(child);
+                   })) {
+            error = "it has at least one child";
+        } else if (isAnyOf(d.getAssetType(), TYPE_DATACENTER, TYPE_ROW, TYPE_ROOM, TYPE_RACK) && !removeLastDC &&
+                   dataCenters - (d.getAssetType() == TYPE_DATACENTER ? 1 : 0) == 0) {
+            error = "Asset could not be removed: cannot delete last datacenter";
+        } else if (d.getAssetStatus() == AssetStatus::Active) {
+            try {
+                d.deactivate();
+                deactivated.push_back(i);
+            } catch (std::exception& e) {
+                error = e.what();
+            }
+        }
 
+        if (!error.empty()) {
+            log_error("Asset could not be removed: %s", error.c_str());
+            status[i] = "Asset could not be removed: " + error;
+            continue;
+        }
+
+        if (d.getAssetType() == TYPE_DATACENTER) {
+            dataCenters--;
+        }
+        removed.insert(iname);
+        approved.push_back(i);
+
+        if (levels.empty() || depth[iname] != depth[levels.back().back()]) {
+            levels.push_back({});
+        }
+        levels.back().push_back(iname);
+    }
+
+    if (!toDel.empty()) {
+        storage.beginTransaction();
         try {
-            d.remove(removeLastDC);
-            deleted.push_back({d, "OK"});
-        } catch (std::exception& e) {
+            // remove all links to the assets of the plan
+            storage.unlinkAll(planned);
+            storage.removeAssets(levels);
+            storage.commitTransaction();
+        } catch (const std::exception& e) {
+            storage.rollbackTransaction();
+
+            // reactivate assets which were active
+            for (size_t i : deactivated) {
+                try {
+                    toDel[i].activate();
+                } catch (std::exception& ex) {
+                    log_error("Asset %s could not be reactivated: %s", toDel[i].getInternalName().c_str(), ex.what());
+                }
+            }
             log_error("Asset could not be removed: %s", e.what());
-            deleted.push_back({d, "Asset could not be removed: " + std::string(e.what())});
+            for (size_t i : approved) {
+                status[i] = "Asset could not be removed: Asset could not be removed: " + std::string(e.what());
+            }
         }
     }
 
+    DeleteStatus deleted;
+    for (size_t i = 0; i < toDel.size(); i++) {
+        deleted.push_back({toDel[i], status[i].empty() ? "OK" : status[i]});
+    }
+
     return deleted;
 }
 
 DeleteStatus AssetImpl::deleteAll()
 {
-    // get list of all assets (including last datacenter)
-    return deleteList(listAll(), false, true);
+    AssetStorage& storage = getStorage();
+
+    // RC0 stays where it is placed, so its location is kept too
+    std::vector<std::string>        preserved = rc0Location();
+    std::unordered_set<std::string> kept(preserved.begin(), preserved.end());
+    preserved.push_back(RC0);
+
+    // every other asset (including last datacenter), nothing to check as nothing else remains
+    std::vector<std::string> inames;
+    for (const std::string& iname : listAll()) {
+        if (!kept.count(iname)) {
+            inames.push_back(iname);
+        }
+    }
+    std::vector<Asset> toDel = storage.loadAssets(inames, false);
+
+    // devices consume the license, they must be deactivated before being removed
+    std::vector<AssetImpl> deactivated;
+    std::string            error;
+    for (const Asset& a : toDel) {
+        if (a.getAssetType() != TYPE_DEVICE || a.getAssetStatus() != AssetStatus::Active) {
+            continue;
+        }
+        AssetImpl d;
+        static_cast<Asset&>(d) = a;
+        try {
+            d.deactivate();
+            deactivated.push_back(d);
+        } catch (std::exception& e) {
+            error = e.what();
+            break;
+        }
+    }
+
+    if (error.empty()) {
+        storage.beginTransaction();
+        try {
+            storage.removeAllAssets(preserved);
+            storage.commitTransaction();
+        } catch (const std::exception& e) {
+            storage.rollbackTransaction();
+            error = e.what();
+        }
+    }
+
+    if (!error.empty()) {
+        log_error("Assets could not be removed: %s", error.c_str());
+        for (auto& d : deactivated) {
+            try {
+                d.activate();
+            } catch (std::exception& ex) {
+                log_error("Asset %s could not be reactivated: %s", d.getInternalName().c_str(), ex.what());
+            }
+        }
+    }
+
+    DeleteStatus deleted;
+    for (const Asset& a : toDel) {
+        deleted.push_back({a, error.empty() ? "OK" : "Asset could not be removed: " + error});
+    }
+
+    return deleted;
+}
+
+std::vector<std::string> AssetImpl::rc0Location()
+{
+    AssetStorage& storage = getStorage();
+
+    std::vector<std::string>        location;
+    std::unordered_set<std::string> seen{RC0};
+    std::string                     iname = RC0;
+    for (;;) {
+        std::vector<Asset> loaded = storage.loadAssets({iname}, false);
+        if (loaded.empty()) {
+            break;
+        }
+        iname = loaded.front().getParentIname();
+        // avoid infinite loop
+        if (iname.empty() || !seen.insert(iname).second) {
+            break;
+        }
+        location.push_back(iname);
+    }
+    return location;
+}
+
+void AssetImpl::restoreList(std::vector<AssetImpl>& assets, bool restoreLinks)
+{
+    AssetStorage& storage = getStorage();
+
+    std::map<std::string, std::string> parents;
+    for (auto& a : assets) {
+        // set creation timestamp
+        a.setExtEntry(fty::EXT_CREATE_TS, generateCurrentTimestamp(), true);
+        parents[a.getInternalName()] = a.getParentIname();
+    }
+
+    // avoid infinite loop
+    const unsigned short maxLevels = 255;
+
+    // group assets by depth inside the restored set, parents are inserted before their children
+    std::vector<std::vector<Asset>> levels;
+    for (const auto& a : assets) {
+        size_t d     = 0;
+        auto   found = parents.find(a.getParentIname());
+        while (found != parents.end() && d < maxLevels) {
+            found = parents.find(found->second);
+            d++;
+        }
+        if (levels.size() <= d) {
+            levels.resize(d + 1);
+        }
+        levels[d].push_back(a);
+    }
+
+    std::vector<Asset> all(assets.begin(), assets.end());
+
+    storage.beginTransaction();
+    try {
+        for (const auto& level : levels) {
+            storage.insertAssets(level);
+        }
+        storage.insertExtMaps(all);
+        if (restoreLinks) {
+            storage.insertLinks(all);
+        }
+        storage.commitTransaction();
+    } catch (const std::exception& e) {
+        storage.rollbackTransaction();
+        log_debug("AssetImpl::restoreList() got EXCEPTION : %s", e.what());
+        throw std::runtime_error("Assets could not be restored: " + std::string(e.what()));
+    }
+}
+
+void AssetImpl::unlinkSources(const std::vector<std::string>& assets)
+{
+    AssetStorage& storage = getStorage();
+
+    std::vector<std::string>        srcs;
+    std::unordered_set<std::string> seen;
+    for (const std::string& iname : assets) {
+        if (seen.insert(iname).second) {
+            srcs.push_back(iname);
+        }
+        addSubTree(iname, srcs, seen);
+    }
+
+    storage.beginTransaction();
+    try {
+        storage.unlinkSources(srcs);
+        storage.commitTransaction();
+    } catch (const std::exception& e) {
+        storage.rollbackTransaction();
+        throw std::runtime_error("Links could not be removed: " + std::string(e.what()));
+    }
 }
 
 /// get internal name from UUID
@@ -781,4 +1156,78 @@ std::string AssetImpl::getInameFromUuid(const std::string& uuid)
     return getStorage().inameByUuid(uuid);
 }
 
+std::vector<AssetImpl> AssetImpl::getList(const std::vector<std::string>& inames, bool withParentsList)
+{
+    std::vector<AssetImpl> assets;
+
+    for (const Asset& loaded : getStorage().loadAssets(inames)) {
+        AssetImpl a;
+        static_cast<Asset&>(a) = loaded;
+        assets.push_back(a);
+    }
+
+    if (!withParentsList) {
+        return assets;
+    }
+
+    // load all ancestors level by level, each asset is loaded only once
+    std::map<std::string, Asset> cache;
+    for (const auto& a : assets) {
+        cache[a.getInternalName()] = a;
+    }
+
+    std::vector<std::string> toLoad;
+    for (const auto& a : assets) {
+        toLoad.push_back(a.getParentIname());
+    }
+
+    // avoid infinite loop
+    const unsigned short maxLevels = 255;
+
+    for (unsigned short level = 0; level < maxLevels; level++) {
+        std::sort(toLoad.begin(), toLoad.end());
+        toLoad.erase(std::unique(toLoad.begin(), toLoad.end()), toLoad.end());
+        toLoad.erase(std::remove_if(toLoad.begin(), toLoad.end(),
+                         [&](const std::string& iname) {
+                             return iname.empty() || cache.count(iname);
+                         }),
+            toLoad.end());
+
+        if (toLoad.empty()) {
+            break;
+        }
+
+        std::vector<std::string> next;
+        for (const Asset& p : getStorage().loadAssets(toLoad)) {
+            cache[p.getInternalName()] = p;
+            next.push_back(p.getParentIname());
+        }
+        toLoad = next;
+    }
+
+    for (auto& a : assets) {
+        std::vector<Asset> parents;
+
+        std::string parent = a.getParentIname();
+        while (!parent.empty() && parents.size() < maxLevels) {
+            auto found = cache.find(parent);
+            if (found == cache.end()) {
+                break;
+            }
+            parents.push_back(found->second);
+            parent = found->second.getParentIname();
+        }
+
+        a.m_parentsList = parents;
+    }
+
+    return assets;
+}
+
+/// get internal names from UUIDs (uuid -> iname, UUIDs which are not found are skipped)
+std::map<std::string, std::string> AssetImpl::getInamesFromUuids(const std::vector<std::string>& uuids)
+{
+    return getStorage().inamesByUuids(uuids);
+}
+
 } // namespace fty
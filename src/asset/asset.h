@@ -70,16 +70,33 @@ public:
 
     static void assetToSrr(const AssetImpl& asset, cxxtools::SerializationInfo& si);
     static void srrToAsset(const cxxtools::SerializationInfo& si, AssetImpl& asset);
+    // SRR 2.0 block of assets (uncompressed), throws std::runtime_error on malformed input
+    static std::string            assetsToSrrBlock(const std::vector<AssetImpl>& assets);
+    static std::vector<AssetImpl> srrBlockToAssets(const std::string& block);
 
     static std::vector<std::string> list(const AssetFilters& filters);
     static std::vector<std::string> listAll();
+    // next page of non virtual assets (excluding RC-0), ordered by internal name
+    static std::vector<std::string> listPhysical(const std::string& after, size_t limit);
 
     static DeleteStatus deleteList(
         const std::vector<std::string>& assets, bool recursive, bool removeLastDC = false);
+    // removes every asset but RC0 and its location in one transaction
     static DeleteStatus deleteAll();
+    // internal names of the parents of RC0, nearest first
+    static std::vector<std::string> rc0Location();
+
+    // restore assets in as few statements as possible, all or nothing (devices are inserted as non active)
+    static void restoreList(std::vector<AssetImpl>& assets, bool restoreLinks = true);
+    // removes the links the assets and all their descendants are the source of
+    static void unlinkSources(const std::vector<std::string>& assets);
 
     static std::string getInameFromUuid(const std::string& uuid);
 
+    // bulk load (inames which are not found are skipped)
+    static std::vector<AssetImpl> getList(const std::vector<std::string>& inames, bool withParentsList = false);
+    static std::map<std::string, std::string> getInamesFromUuids(const std::vector<std::string>& uuids);
+
     using Asset::operator==;
 
     friend std::vector<std::string> getChildren(const AssetImpl& a);
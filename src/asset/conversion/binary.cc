@@ -0,0 +1,395 @@
+/*  =========================================================================
+    asset_conversion_binary - asset/conversion/binary
+
+    Copyright (C) 2016 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "include/asset/conversion/binary.h"
+#include "include/fty_asset_dto.h"
+#include "src/asset/asset-utils.h"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace fty { namespace conversion {
+
+    static constexpr const char    MAGIC[]       = {'F', 'T', 'Y', 'A'};
+    static constexpr uint8_t       VERSION       = 1;
+    static constexpr uint8_t       FLAG_READONLY = 0x01;
+    static constexpr uint8_t       FLAG_UPDATED  = 0x02;
+    static constexpr unsigned long MAX_DEPTH     = 32;
+
+    // ids of t_bios_asset_element_type
+    // clang-format off
+    static const std::map<std::string, unsigned long> TYPE_CODES = {
+        {TYPE_UNKNOWN, 0}, {TYPE_GROUP, 1}, {TYPE_DATACENTER, 2}, {TYPE_ROOM, 3}, {TYPE_ROW, 4},
+        {TYPE_RACK, 5}, {TYPE_DEVICE, 6}, {TYPE_INFRA_SERVICE, 7}, {TYPE_CLUSTER, 8}, {TYPE_HYPERVISOR, 9},
+        {TYPE_VIRTUAL_MACHINE, 10}, {TYPE_STORAGE_SERVICE, 11}, {TYPE_VAPP, 12}, {TYPE_CONNECTOR, 13},
+        {TYPE_SERVER, 15}, {TYPE_PLANNER, 16}, {TYPE_PLAN, 17}
+    };
+
+    // ids of t_bios_asset_device_type
+    static const std::map<std::string, unsigned long> SUBTYPE_CODES = {
+        {SUB_UNKNOWN, 0}, {SUB_UPS, 1}, {SUB_GENSET, 2}, {SUB_EPDU, 3}, {SUB_PDU, 4}, {SUB_SERVER, 5},
+        {SUB_FEED, 6}, {SUB_STS, 7}, {SUB_SWITCH, 8}, {SUB_STORAGE, 9}, {SUB_VM, 10}, {SUB_N_A, 11},
+        {SUB_ROUTER, 12}, {SUB_RACK_CONTROLLER, 13}, {SUB_SENSOR, 14}, {SUB_APPLIANCE, 15}, {SUB_CHASSIS, 16},
+        {SUB_PATCH_PANEL, 17}, {SUB_OTHER, 18}, {SUB_SENSORGPIO, 19}, {SUB_GPO, 20},
+        {SUB_NETAPP_ONTAP_NODE, 21}, {SUB_IPMINFRA_SERVER, 22}, {SUB_IPMINFRA_SERVICE, 23},
+        {SUB_VMWARE_VCENTER, 24}, {SUB_CITRIX_POOL, 25}, {SUB_VMWARE_CLUSTER, 26}, {SUB_VMWARE_ESXI, 27},
+        {SUB_MICROSOFT_HYPERV, 28}, {SUB_VMWARE_VM, 29}, {SUB_MICROSOFT_VM, 30}, {SUB_CITRIX_VM, 31},
+        {SUB_NETAPP_NODE, 32}, {SUB_VMWARE_STANDALONE_ESXI, 33}, {SUB_VMWARE_TASK, 34}, {SUB_VMWARE_VAPP, 35},
+        {SUB_CITRIX_XENSERVER, 36}, {SUB_CITRIX_VAPP, 37}, {SUB_CITRIX_TASK, 38},
+        {SUB_MICROSOFT_VIRTUALIZATION_MACHINE, 39}, {SUB_MICROSOFT_TASK, 40},
+        {SUB_MICROSOFT_SERVER_CONNECTOR, 41}, {SUB_MICROSOFT_SERVER, 42}, {SUB_MICROSOFT_CLUSTER, 43},
+        {SUB_HP_ONEVIEW_CONNECTOR, 44}, {SUB_HP_ONEVIEW, 45}, {SUB_HP_IT_SERVER, 46}, {SUB_HP_IT_RACK, 47},
+        {SUB_NETAPP_SERVER, 48}, {SUB_NETAPP_ONTAP_CONNECTOR, 49}, {SUB_NETAPP_ONTAP_CLUSTER, 50},
+        {SUB_NUTANIX_VM, 51}, {SUB_NUTANIX_PRISM_GATEWAY, 52}, {SUB_NUTANIX_NODE, 53},
+        {SUB_NUTANIX_CLUSTER, 54}, {SUB_NUTANIX_PRISM_CONNECTOR, 55}, {SUB_VMWARE_VCENTER_CONNECTOR, 60},
+        {SUB_VMWARE_STANDALONE_ESXI_CONNECTOR, 61}, {SUB_NETAPP_ONTAP, 62}, {SUB_VMWARE_SRM, 65},
+        {SUB_VMWARE_SRM_PLAN, 66}
+    };
+    // clang-format on
+
+    static std::map<unsigned long, std::string> reverse(const std::map<std::string, unsigned long>& codes)
+    {
+        std::map<unsigned long, std::string> names;
+        for (const auto& c : codes) {
+            names.emplace(c.second, c.first);
+        }
+        return names;
+    }
+
+    // writer
+
+    using assetutils::writeString;
+    using assetutils::writeVarint;
+
+    class BinaryWriter
+    {
+    public:
+        void writeAsset(std::string& out, const Asset& asset)
+        {
+            std::string record;
+
+            writeString(record, asset.getInternalName());
+            record += char(asset.getAssetStatus());
+            writeCode(record, TYPE_CODES, asset.getAssetType());
+            writeCode(record, SUBTYPE_CODES, asset.getAssetSubtype());
+            writeVarint(record, intern(asset.getParentIname()));
+            writeVarint(record, static_cast<unsigned int>(asset.getPriority()));
+
+            writeVarint(record, asset.getLinkedAssets().size());
+            for (const auto& link : asset.getLinkedAssets()) {
+                writeVarint(record, intern(link.sourceId));
+                writeString(record, link.srcOut);
+                writeString(record, link.destIn);
+                writeVarint(record, static_cast<unsigned int>(link.linkType));
+            }
+
+            writeVarint(record, asset.getExt().size());
+            for (const auto& e : asset.getExt()) {
+                writeVarint(record, intern(e.first));
+                writeString(record, e.second.getValue());
+                record += char((e.second.isReadOnly() ? FLAG_READONLY : 0) | (e.second.wasUpdated() ? FLAG_UPDATED : 0));
+            }
+
+            const auto parentsList = asset.getParentsList();
+            record += char(parentsList ? 1 : 0);
+            if (parentsList) {
+                writeVarint(record, parentsList->size());
+                for (const auto& parent : *parentsList) {
+                    writeAsset(record, parent);
+                }
+            }
+
+            writeString(out, record);
+        }
+
+        void writeStringTable(std::string& out) const
+        {
+            writeVarint(out, m_strings.size());
+            for (const auto* str : m_strings) {
+                writeString(out, *str);
+            }
+        }
+
+    private:
+        std::unordered_map<std::string, unsigned long> m_index;
+        std::vector<const std::string*>                m_strings;
+
+        unsigned long intern(const std::string& str)
+        {
+            auto inserted = m_index.emplace(str, m_strings.size());
+            if (inserted.second) {
+                m_strings.push_back(&inserted.first->first);
+            }
+            return inserted.first->second;
+        }
+
+        // known names are coded by their id + 1, 0 is followed by the index of the name in the string table
+        void writeCode(std::string& out, const std::map<std::string, unsigned long>& codes, const std::string& name)
+        {
+            auto found = codes.find(name);
+            if (found != codes.end()) {
+                writeVarint(out, found->second + 1);
+            } else {
+                writeVarint(out, 0);
+                writeVarint(out, intern(name));
+            }
+        }
+    };
+
+    std::string toBinary(const std::vector<Asset>& assets)
+    {
+        BinaryWriter writer;
+
+        std::string body;
+        for (const auto& asset : assets) {
+            writer.writeAsset(body, asset);
+        }
+
+        std::string out(MAGIC, sizeof(MAGIC));
+        out += char(VERSION);
+        writer.writeStringTable(out);
+        writeVarint(out, assets.size());
+        out += body;
+
+        return out;
+    }
+
+    std::string toBinary(const Asset& asset)
+    {
+        return toBinary(std::vector<Asset>{asset});
+    }
+
+    // reader
+
+    class BinaryReader
+    {
+    public:
+        BinaryReader(const std::string& data, size_t begin, size_t end)
+            : m_data(data)
+            , m_pos(begin)
+            , m_end(end)
+        {
+        }
+
+        size_t position() const
+        {
+            return m_pos;
+        }
+
+        bool atEnd() const
+        {
+            return m_pos == m_end;
+        }
+
+        uint8_t readByte()
+        {
+            if (m_pos >= m_end) {
+                throw std::runtime_error("Truncated binary asset data");
+            }
+            return static_cast<uint8_t>(m_data[m_pos++]);
+        }
+
+        unsigned long readVarint()
+        {
+            unsigned long v     = 0;
+            unsigned int  shift = 0;
+            for (;;) {
+                uint8_t b = readByte();
+                if (shift >= sizeof(v) * 8) {
+                    throw std::runtime_error("Invalid varint in binary asset data");
+                }
+                v |= static_cast<unsigned long>(b & 0x7f) << shift;
+                if (!(b & 0x80)) {
+                    return v;
+                }
+                shift += 7;
+            }
+        }
+
+        // returns the offset of the string in the data
+        size_t readSpan(size_t& size)
+        {
+            size = readVarint();
+            if (size > m_end - m_pos) {
+                throw std::runtime_error("Truncated binary asset data");
+            }
+            size_t begin = m_pos;
+            m_pos += size;
+            return begin;
+        }
+
+        std::string readString()
+        {
+            size_t size;
+            size_t begin = readSpan(size);
+            return m_data.substr(begin, size);
+        }
+
+    private:
+        const std::string& m_data;
+        size_t             m_pos;
+        size_t             m_end;
+    };
+
+    class AssetDecoder
+    {
+    public:
+        explicit AssetDecoder(const std::string& data)
+            : m_data(data)
+        {
+        }
+
+        std::vector<Asset> decode()
+        {
+            if (m_data.size() < sizeof(MAGIC) + 1 || m_data.compare(0, sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0) {
+                throw std::runtime_error("Not a binary asset payload");
+            }
+            if (static_cast<uint8_t>(m_data[sizeof(MAGIC)]) != VERSION) {
+                throw std::runtime_error("Unsupported binary asset format version");
+            }
+
+            BinaryReader reader(m_data, sizeof(MAGIC) + 1, m_data.size());
+
+            unsigned long count = reader.readVarint();
+            m_strings.reserve(std::min<unsigned long>(count, m_data.size()));
+            for (unsigned long i = 0; i < count; i++) {
+                m_strings.push_back(reader.readString());
+            }
+
+            std::vector<Asset> assets;
+            count = reader.readVarint();
+            assets.reserve(std::min<unsigned long>(count, m_data.size()));
+            for (unsigned long i = 0; i < count; i++) {
+                assets.push_back(readAsset(reader, 0));
+            }
+
+            if (!reader.atEnd()) {
+                throw std::runtime_error("Trailing bytes in binary asset data");
+            }
+            return assets;
+        }
+
+    private:
+        const std::string&       m_data;
+        std::vector<std::string> m_strings;
+
+        const std::string& stringAt(unsigned long index) const
+        {
+            if (index >= m_strings.size()) {
+                throw std::runtime_error("Invalid string index in binary asset data");
+            }
+            return m_strings[index];
+        }
+
+        std::string readCode(BinaryReader& reader, const std::map<unsigned long, std::string>& names) const
+        {
+            unsigned long code = reader.readVarint();
+            if (code == 0) {
+                return stringAt(reader.readVarint());
+            }
+            auto found = names.find(code - 1);
+            if (found == names.end()) {
+                throw std::runtime_error("Invalid type code in binary asset data");
+            }
+            return found->second;
+        }
+
+        Asset readAsset(BinaryReader& outer, unsigned long depth) const
+        {
+            static const std::map<unsigned long, std::string> typeNames    = reverse(TYPE_CODES);
+            static const std::map<unsigned long, std::string> subtypeNames = reverse(SUBTYPE_CODES);
+
+            if (depth > MAX_DEPTH) {
+                throw std::runtime_error("Too many nested parents in binary asset data");
+            }
+
+            // records are length prefixed, read only inside the record
+            size_t       size;
+            size_t       begin = outer.readSpan(size);
+            BinaryReader reader(m_data, begin, begin + size);
+
+            Asset asset;
+            asset.setInternalName(reader.readString());
+
+            uint8_t status = reader.readByte();
+            if (status > uint8_t(AssetStatus::Nonactive)) {
+                throw std::runtime_error("Invalid status in binary asset data");
+            }
+            asset.setAssetStatus(AssetStatus(status));
+            asset.setAssetType(readCode(reader, typeNames));
+            asset.setAssetSubtype(readCode(reader, subtypeNames));
+            asset.setParentIname(stringAt(reader.readVarint()));
+            asset.setPriority(static_cast<int>(reader.readVarint()));
+
+            std::vector<AssetLink> links;
+            unsigned long          count = reader.readVarint();
+            for (unsigned long i = 0; i < count; i++) {
+                AssetLink link;
+                link.sourceId = stringAt(reader.readVarint());
+                link.srcOut   = reader.readString();
+                link.destIn   = reader.readString();
+                link.linkType = static_cast<int>(reader.readVarint());
+                links.push_back(std::move(link));
+            }
+            asset.setLinkedAssets(links);
+
+            count = reader.readVarint();
+            for (unsigned long i = 0; i < count; i++) {
+                const std::string& key   = stringAt(reader.readVarint());
+                std::string        value = reader.readString();
+                uint8_t            flags = reader.readByte();
+                // as with JSON, the updated flag is informative only
+                asset.setExtEntry(key, value, flags & FLAG_READONLY);
+            }
+
+            if (reader.readByte()) {
+                std::vector<Asset> parents;
+                count = reader.readVarint();
+                for (unsigned long i = 0; i < count; i++) {
+                    parents.push_back(readAsset(reader, depth + 1));
+                }
+                asset.setParentsList(parents);
+            }
+
+            if (!reader.atEnd()) {
+                throw std::runtime_error("Invalid asset record in binary asset data");
+            }
+            return asset;
+        }
+    };
+
+    std::vector<Asset> fromBinary(const std::string& data)
+    {
+        return AssetDecoder(data).decode();
+    }
+
+    void fromBinary(const std::string& data, Asset& asset)
+    {
+        std::vector<Asset> assets = fromBinary(data);
+        if (assets.size() != 1) {
+            throw std::runtime_error("Binary asset data does not contain exactly one asset");
+        }
+        asset = assets.front();
+    }
+
+}} // namespace fty::conversion
@@ -21,37 +21,625 @@
 
 #include "include/asset/conversion/json.h"
 #include "include/fty_asset_dto.h"
-#include <cxxtools/jsondeserializer.h>
-#include <cxxtools/jsonserializer.h>
-#include <sstream>
+#include <bitset>
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// JSON members, keep consistent with fty_asset_dto.cc
+static constexpr const char* SI_STATUS       = "status";
+static constexpr const char* SI_TYPE         = "type";
+static constexpr const char* SI_SUB_TYPE     = "sub_type";
+static constexpr const char* SI_NAME         = "name";
+static constexpr const char* SI_PRIORITY     = "priority";
+static constexpr const char* SI_PARENT       = "parent";
+static constexpr const char* SI_EXT          = "ext";
+static constexpr const char* SI_LINKED       = "linked";
+static constexpr const char* SI_PARENTS_LIST = "parents_list";
+
+static constexpr const char* SI_LINK_SOURCE    = "source";
+static constexpr const char* SI_LINK_LINK_TYPE = "link_type";
+static constexpr const char* SI_LINK_SRC_OUT   = "src_out";
+static constexpr const char* SI_LINK_DEST_IN   = "dest_in";
+
+static constexpr const char* SI_EXT_MAP_ELEMENT_VALUE    = "value";
+static constexpr const char* SI_EXT_MAP_ELEMENT_READONLY = "readOnly";
+static constexpr const char* SI_EXT_MAP_ELEMENT_UPDATED  = "updated";
 
 namespace fty { namespace conversion {
 
-    std::string toJson(const Asset& asset)
+    // writer
+
+    // same escaping as cxxtools::JsonFormatter
+    static void writeString(std::string& out, const std::string& str)
+    {
+        static const char hex[] = "0123456789abcdef";
+
+        out += '"';
+        for (char c : str) {
+            unsigned char u = static_cast<unsigned char>(c);
+            switch (c) {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\b':
+                    out += "\\b";
+                    break;
+                case '\f':
+                    out += "\\f";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '\r':
+                    out += "\\r";
+                    break;
+                case '\t':
+                    out += "\\t";
+                    break;
+                default:
+                    if (u < 0x20 || u >= 0x80) {
+                        out += "\\u00";
+                        out += hex[u >> 4];
+                        out += hex[u & 0xf];
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    static void writeKey(std::string& out, const char* key, bool first = false)
+    {
+        if (!first) {
+            out += ',';
+        }
+        out += '"';
+        out += key;
+        out += "\":";
+    }
+
+    void appendJson(std::string& buffer, const AssetLink& link)
+    {
+        buffer += '{';
+        writeKey(buffer, SI_LINK_SOURCE, true);
+        writeString(buffer, link.sourceId);
+        writeKey(buffer, SI_LINK_LINK_TYPE);
+        buffer += std::to_string(link.linkType);
+        if (!link.srcOut.empty()) {
+            writeKey(buffer, SI_LINK_SRC_OUT);
+            writeString(buffer, link.srcOut);
+        }
+        if (!link.destIn.empty()) {
+            writeKey(buffer, SI_LINK_DEST_IN);
+            writeString(buffer, link.destIn);
+        }
+        buffer += '}';
+    }
+
+    void appendJson(std::string& buffer, const ExtMapElement& element)
+    {
+        buffer += '{';
+        writeKey(buffer, SI_EXT_MAP_ELEMENT_VALUE, true);
+        writeString(buffer, element.getValue());
+        writeKey(buffer, SI_EXT_MAP_ELEMENT_READONLY);
+        buffer += element.isReadOnly() ? "true" : "false";
+        writeKey(buffer, SI_EXT_MAP_ELEMENT_UPDATED);
+        buffer += element.wasUpdated() ? "true" : "false";
+        buffer += '}';
+    }
+
+    void appendJson(std::string& buffer, const Asset& asset)
     {
-        std::ostringstream output;
+        buffer += '{';
+        writeKey(buffer, SI_STATUS, true);
+        buffer += std::to_string(int(asset.getAssetStatus()));
+        writeKey(buffer, SI_TYPE);
+        writeString(buffer, asset.getAssetType());
+        writeKey(buffer, SI_SUB_TYPE);
+        writeString(buffer, asset.getAssetSubtype());
+        writeKey(buffer, SI_NAME);
+        writeString(buffer, asset.getInternalName());
+        writeKey(buffer, SI_PRIORITY);
+        buffer += std::to_string(asset.getPriority());
+        writeKey(buffer, SI_PARENT);
+        writeString(buffer, asset.getParentIname());
+
+        writeKey(buffer, SI_LINKED);
+        buffer += '[';
+        for (auto it = asset.getLinkedAssets().begin(); it != asset.getLinkedAssets().end(); ++it) {
+            if (it != asset.getLinkedAssets().begin()) {
+                buffer += ',';
+            }
+            appendJson(buffer, *it);
+        }
+        buffer += ']';
+
+        writeKey(buffer, SI_EXT);
+        buffer += '{';
+        for (auto it = asset.getExt().begin(); it != asset.getExt().end(); ++it) {
+            if (it != asset.getExt().begin()) {
+                buffer += ',';
+            }
+            writeString(buffer, it->first);
+            buffer += ':';
+            appendJson(buffer, it->second);
+        }
+        buffer += '}';
 
-        cxxtools::SerializationInfo si;
-        cxxtools::JsonSerializer    serializer(output);
+        const auto parentsList = asset.getParentsList();
+        if (parentsList.has_value()) {
+            writeKey(buffer, SI_PARENTS_LIST);
+            buffer += '[';
+            for (auto it = parentsList->begin(); it != parentsList->end(); ++it) {
+                if (it != parentsList->begin()) {
+                    buffer += ',';
+                }
+                appendJson(buffer, *it);
+            }
+            buffer += ']';
+        }
 
-        si <<= asset;
-        serializer.serialize(si);
+        buffer += '}';
+    }
+
+    std::string toJson(const Asset& asset)
+    {
+        std::string json;
+        json.reserve(512);
 
-        std::string json = output.str();
+        appendJson(json, asset);
 
         return json;
     }
 
-    void fromJson(const std::string& json, fty::Asset& asset)
+    // parser
+
+    class JsonReader
     {
-        std::istringstream input(json);
+    public:
+        explicit JsonReader(const std::string& json)
+            : m_json(json)
+        {
+        }
+
+        // check that only whitespaces are left
+        void finish()
+        {
+            skipWs();
+            if (m_pos != m_json.size()) {
+                error("unexpected data after end of document");
+            }
+        }
+
+        // call onMember(key) for each member, onMember must consume the value
+        template <typename F>
+        void readObject(F&& onMember)
+        {
+            expect('{');
+            if (consume('}')) {
+                return;
+            }
+            do {
+                std::string key = readString();
+                expect(':');
+                onMember(key);
+            } while (consume(','));
+            expect('}');
+        }
+
+        // call onItem() for each item, onItem must consume the value
+        template <typename F>
+        void readArray(F&& onItem)
+        {
+            expect('[');
+            if (consume(']')) {
+                return;
+            }
+            do {
+                onItem();
+            } while (consume(','));
+            expect(']');
+        }
+
+        std::string readString()
+        {
+            std::string str;
+
+            if (readNull()) {
+                return str;
+            }
+            if (peek() != '"') {
+                // number or boolean given instead of a string, take it as is
+                if (peek() == '{' || peek() == '[') {
+                    error("string expected");
+                }
+                size_t begin = m_pos;
+                skipValue();
+                std::string scalar = m_json.substr(begin, m_pos - begin);
+                if (scalar != "true" && scalar != "false" && !isNumber(scalar)) {
+                    error("invalid value '" + scalar + "'");
+                }
+                return scalar;
+            }
+
+            m_pos++;
+            while (true) {
+                if (m_pos >= m_json.size()) {
+                    error("unterminated string");
+                }
+                char c = m_json[m_pos++];
+                if (c == '"') {
+                    break;
+                }
+                if (static_cast<unsigned char>(c) >= 0x80) {
+                    m_pos--;
+                    str += narrow(readUtf8());
+                    continue;
+                }
+                if (c != '\\') {
+                    str += c;
+                    continue;
+                }
+                if (m_pos >= m_json.size()) {
+                    error("unterminated string");
+                }
+                c = m_json[m_pos++];
+                switch (c) {
+                    case 'b':
+                        str += '\b';
+                        break;
+                    case 'f':
+                        str += '\f';
+                        break;
+                    case 'n':
+                        str += '\n';
+                        break;
+                    case 'r':
+                        str += '\r';
+                        break;
+                    case 't':
+                        str += '\t';
+                        break;
+                    case 'u':
+                        str += narrow(readCodePoint());
+                        break;
+                    default:
+                        str += c;
+                }
+            }
 
-        cxxtools::SerializationInfo si;
-        cxxtools::JsonDeserializer  deserializer(input);
+            return str;
+        }
 
-        deserializer.deserialize(si);
+        int readInt()
+        {
+            std::string str = readString();
+            try {
+                return std::stoi(str);
+            } catch (const std::exception&) {
+                error("invalid integer value '" + str + "'");
+            }
+        }
+
+        bool readBool()
+        {
+            std::string str = readString();
+            if (str == "true" || str == "1") {
+                return true;
+            }
+            if (str == "false" || str == "0" || str.empty()) {
+                return false;
+            }
+            error("invalid boolean value '" + str + "'");
+        }
+
+        bool readNull()
+        {
+            skipWs();
+            if (m_json.compare(m_pos, 4, "null") == 0) {
+                m_pos += 4;
+                return true;
+            }
+            return false;
+        }
+
+        void skipValue()
+        {
+            switch (peek()) {
+                case '{':
+                    readObject([&](const std::string&) {
+                        skipValue();
+                    });
+                    break;
+                case '[':
+                    readArray([&]() {
+                        skipValue();
+                    });
+                    break;
+                case '"':
+                    readString();
+                    break;
+                default:
+                    while (m_pos < m_json.size() && m_json[m_pos] != ',' && m_json[m_pos] != '}' &&
+                           m_json[m_pos] != ']' && !isspace(static_cast<unsigned char>(m_json[m_pos]))) {
+                        m_pos++;
+                    }
+            }
+        }
+
+    private:
+        const std::string& m_json;
+        size_t             m_pos = 0;
+
+        [[noreturn]] void error(const std::string& what) const
+        {
+            throw std::runtime_error("JSON parse error at offset " + std::to_string(m_pos) + ": " + what);
+        }
+
+        void skipWs()
+        {
+            while (m_pos < m_json.size() && isspace(static_cast<unsigned char>(m_json[m_pos]))) {
+                m_pos++;
+            }
+        }
+
+        char peek()
+        {
+            skipWs();
+            if (m_pos >= m_json.size()) {
+                error("unexpected end of document");
+            }
+            return m_json[m_pos];
+        }
+
+        bool consume(char c)
+        {
+            if (peek() == c) {
+                m_pos++;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char c)
+        {
+            if (!consume(c)) {
+                error(std::string("expected '") + c + "'");
+            }
+        }
+
+        uint32_t readHex4()
+        {
+            if (m_pos + 4 > m_json.size()) {
+                error("invalid unicode escape");
+            }
+            uint32_t v = 0;
+            for (int i = 0; i < 4; i++) {
+                char c = m_json[m_pos++];
+                v <<= 4;
+                if (c >= '0' && c <= '9') {
+                    v |= uint32_t(c - '0');
+                } else if (c >= 'a' && c <= 'f') {
+                    v |= uint32_t(c - 'a' + 10);
+                } else if (c >= 'A' && c <= 'F') {
+                    v |= uint32_t(c - 'A' + 10);
+                } else {
+                    error("invalid unicode escape");
+                }
+            }
+            return v;
+        }
+
+        uint32_t readCodePoint()
+        {
+            uint32_t v = readHex4();
+            // surrogate pair
+            if (v >= 0xd800 && v < 0xdc00 && m_json.compare(m_pos, 2, "\\u") == 0) {
+                m_pos += 2;
+                uint32_t low = readHex4();
+                v = 0x10000 + ((v - 0xd800) << 10) + (low - 0xdc00);
+            }
+            return v;
+        }
+
+        // raw input is UTF-8 encoded
+        uint32_t readUtf8()
+        {
+            unsigned char c = static_cast<unsigned char>(m_json[m_pos]);
+
+            size_t   len = 0;
+            uint32_t v   = 0;
+            if ((c & 0xe0) == 0xc0) {
+                len = 2;
+                v   = c & 0x1f;
+            } else if ((c & 0xf0) == 0xe0) {
+                len = 3;
+                v   = c & 0x0f;
+            } else if ((c & 0xf8) == 0xf0) {
+                len = 4;
+                v   = c & 0x07;
+            }
+
+            if (len == 0 || m_pos + len > m_json.size()) {
+                // not UTF-8, take the byte as is
+                m_pos++;
+                return c;
+            }
+            for (size_t i = 1; i < len; i++) {
+                unsigned char cont = static_cast<unsigned char>(m_json[m_pos + i]);
+                if ((cont & 0xc0) != 0x80) {
+                    m_pos++;
+                    return c;
+                }
+                v = (v << 6) | (cont & 0x3f);
+            }
+
+            m_pos += len;
+            return v;
+        }
+
+        // JSON number: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+        static bool isNumber(const std::string& str)
+        {
+            size_t pos    = 0;
+            auto   digits = [&]() {
+                size_t begin = pos;
+                while (pos < str.size() && isdigit(static_cast<unsigned char>(str[pos]))) {
+                    pos++;
+                }
+                return pos - begin;
+            };
+
+            if (pos < str.size() && str[pos] == '-') {
+                pos++;
+            }
+            if (pos < str.size() && str[pos] == '0') {
+                pos++;
+            } else if (digits() == 0) {
+                return false;
+            }
+            if (pos < str.size() && str[pos] == '.') {
+                pos++;
+                if (digits() == 0) {
+                    return false;
+                }
+            }
+            if (pos < str.size() && (str[pos] == 'e' || str[pos] == 'E')) {
+                pos++;
+                if (pos < str.size() && (str[pos] == '+' || str[pos] == '-')) {
+                    pos++;
+                }
+                if (digits() == 0) {
+                    return false;
+                }
+            }
+            return pos == str.size();
+        }
+
+        // same conversion as cxxtools::String::narrow() used by the cxxtools deserializer
+        static char narrow(uint32_t v)
+        {
+            return v <= 0xff ? char(v) : '?';
+        }
+    };
+
+    static void readLink(JsonReader& reader, AssetLink& link)
+    {
+        bool hasSource = false, hasType = false;
+
+        reader.readObject([&](const std::string& key) {
+            if (key == SI_LINK_SOURCE) {
+                link.sourceId = reader.readString();
+                hasSource     = true;
+            } else if (key == SI_LINK_LINK_TYPE) {
+                link.linkType = reader.readInt();
+                hasType       = true;
+            } else if (key == SI_LINK_SRC_OUT) {
+                link.srcOut = reader.readString();
+            } else if (key == SI_LINK_DEST_IN) {
+                link.destIn = reader.readString();
+            } else {
+                reader.skipValue();
+            }
+        });
+
+        if (!hasSource || !hasType) {
+            throw std::runtime_error("Missing member in asset link");
+        }
+    }
+
+    static void readAsset(JsonReader& reader, Asset& asset)
+    {
+        // members required by the cxxtools deserializer, a repeated member counts once
+        enum Required
+        {
+            Status,
+            Type,
+            SubType,
+            Name,
+            Priority,
+            Parent,
+            Linked,
+            Ext,
+            RequiredCount
+        };
+        std::bitset<RequiredCount> found;
+
+        reader.readObject([&](const std::string& key) {
+            if (key == SI_STATUS) {
+                asset.setAssetStatus(AssetStatus(reader.readInt()));
+                found.set(Status);
+            } else if (key == SI_TYPE) {
+                asset.setAssetType(reader.readString());
+                found.set(Type);
+            } else if (key == SI_SUB_TYPE) {
+                asset.setAssetSubtype(reader.readString());
+                found.set(SubType);
+            } else if (key == SI_NAME) {
+                asset.setInternalName(reader.readString());
+                found.set(Name);
+            } else if (key == SI_PRIORITY) {
+                asset.setPriority(reader.readInt());
+                found.set(Priority);
+            } else if (key == SI_PARENT) {
+                asset.setParentIname(reader.readString());
+                found.set(Parent);
+            } else if (key == SI_LINKED) {
+                std::vector<AssetLink> links;
+                reader.readArray([&]() {
+                    AssetLink l;
+                    readLink(reader, l);
+                    links.push_back(l);
+                });
+                asset.setLinkedAssets(links);
+                found.set(Linked);
+            } else if (key == SI_EXT) {
+                reader.readObject([&](const std::string& extKey) {
+                    std::string value;
+                    bool        readOnly = false;
+                    reader.readObject([&](const std::string& elementKey) {
+                        if (elementKey == SI_EXT_MAP_ELEMENT_VALUE) {
+                            value = reader.readString();
+                        } else if (elementKey == SI_EXT_MAP_ELEMENT_READONLY) {
+                            readOnly = reader.readBool();
+                        } else {
+                            // "updated" flag is recomputed by ExtMapElement
+                            reader.skipValue();
+                        }
+                    });
+                    asset.setExtEntry(extKey, value, readOnly);
+                });
+                found.set(Ext);
+            } else if (key == SI_PARENTS_LIST) {
+                std::vector<Asset> parents;
+                reader.readArray([&]() {
+                    Asset p;
+                    readAsset(reader, p);
+                    parents.push_back(p);
+                });
+                asset.setParentsList(parents);
+            } else {
+                reader.skipValue();
+            }
+        });
+
+        if (!found.all()) {
+            throw std::runtime_error("Missing member in asset");
+        }
+    }
+
+    void fromJson(const std::string& json, fty::Asset& asset)
+    {
+        JsonReader reader(json);
 
-        si >>= asset;
+        readAsset(reader, asset);
+        reader.finish();
     }
 
 }} // namespace fty::conversion
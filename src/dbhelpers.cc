@@ -45,14 +45,37 @@ std::map<std::string, std::string> test_map_asset_state;
  *  \param[out] assets - inames of assets in this container
  *  \param[in] test - unit tests indicator
  *
+ *  Assets of a named container are taken from the closure index of the
+ *  resident topology model when it is loaded.
+ *
  *  \return  0 - in case of success
  *          -1 - in case of some unexpected error
+ *          -2 - in case the container was not found
  */
 int select_assets_by_container(const std::string& container_name, const std::set<std::string>& filter,
     std::vector<std::string>& assets, bool test)
 {
     if (test)
         return 0;
+
+    persist::TopologyGraph& graph = persist::TopologyGraph::instance();
+    if (!container_name.empty() && graph.ensureLoaded()) {
+        int64_t container_id = graph.nameToId(container_name);
+        if (container_id < 0)
+            return -2;
+
+        std::vector<persist::TopologyGraph::Node> nodes;
+        if (graph.descendants(static_cast<a_elmnt_id_t>(container_id), nodes) != 0)
+            return -2;
+        // filter contains both type and subtype names
+        for (const auto& n : nodes) {
+            if (filter.empty() || filter.count(persist::typeid_to_type(n.typeId)) != 0 ||
+                (n.hasSubtypeName && filter.count(n.subtypeName) != 0))
+                assets.push_back(n.iname);
+        }
+        return 0;
+    }
+
     tntdb::Connection conn = tntdb::connectCached(DBConn::url);
     int rv = DBAssets::select_assets_by_container_name_filter(conn, container_name, filter, assets);
     return rv;
@@ -221,35 +244,310 @@ int process_insert_inventory(
     return 0;
 }
 
+InventoryCache::InventoryCache(size_t capacity)
+    : m_capacity(capacity)
+{
+}
+
+uint32_t InventoryCache::keyId(const std::string& keytag, bool read_only)
+{
+    auto found = m_keytags.find(keytag);
+    if (found == m_keytags.end()) {
+        found = m_keytags.emplace(keytag, uint32_t(m_keytags.size())).first;
+    }
+    return (found->second << 1) | (read_only ? 1 : 0);
+}
+
+InventoryCache::Device& InventoryCache::touch(const std::string& device)
+{
+    auto found = m_devices.find(device);
+    if (found == m_devices.end()) {
+        m_lru.push_front(device);
+        found             = m_devices.emplace(device, Device()).first;
+        found->second.lru = m_lru.begin();
+    } else if (found->second.lru != m_lru.begin()) {
+        m_lru.splice(m_lru.begin(), m_lru, found->second.lru);
+    }
+    return found->second;
+}
+
+bool InventoryCache::contains(
+    const std::string& device, const std::string& keytag, bool read_only, const std::string& value)
+{
+    auto found = m_devices.find(device);
+    if (found != m_devices.end()) {
+        auto el = found->second.values.find(keyId(keytag, read_only));
+        if (el != found->second.values.end() && el->second == value) {
+            touch(device);
+            m_hits++;
+            return true;
+        }
+    }
+    m_misses++;
+    return false;
+}
+
+void InventoryCache::set(
+    const std::string& device, const std::string& keytag, bool read_only, const std::string& value)
+{
+    auto inserted = touch(device).values.emplace(keyId(keytag, read_only), value);
+    if (inserted.second) {
+        m_size++;
+        evict();
+    } else {
+        inserted.first->second = value;
+    }
+}
+
+void InventoryCache::erase(const std::string& device)
+{
+    auto found = m_devices.find(device);
+    if (found == m_devices.end()) {
+        return;
+    }
+    m_size -= found->second.values.size();
+    m_lru.erase(found->second.lru);
+    m_devices.erase(found);
+}
+
+void InventoryCache::clear()
+{
+    m_devices.clear();
+    m_lru.clear();
+    m_size = 0;
+}
+
+void InventoryCache::setCapacity(size_t capacity)
+{
+    m_capacity = capacity;
+    evict();
+}
+
+int InventoryCache::load(bool test)
+{
+    if (test)
+        return 0;
+
+    try {
+        tntdb::Connection conn = tntdb::connectCached(DBConn::url);
+        // clang-format off
+        tntdb::Statement st = conn.prepare(
+            " SELECT e.name, a.keytag, a.value, a.read_only"
+            " FROM t_bios_asset_ext_attributes AS a"
+            " INNER JOIN t_bios_asset_element AS e ON e.id_asset_element = a.id_asset_element"
+            " INNER JOIN t_bios_asset_element_type AS t ON t.id_asset_element_type = e.id_type"
+            " WHERE t.name = 'device'"
+            " ORDER BY e.id_asset_element");
+        // clang-format on
+
+        // streamed with a cursor, the whole result is never in memory
+        for (tntdb::Statement::const_iterator it = st.begin(1000); it != st.end() && m_size < m_capacity;
+             ++it) {
+            const tntdb::Row& row = *it;
+            set(row.getString("name"), row.getString("keytag"), row.getBool("read_only"), row.getString("value"));
+        }
+    } catch (const std::exception& e) {
+        log_error("DB: cannot load inventory cache, %s", e.what());
+        return -1;
+    }
+
+    log_debug("inventory cache: %zu values of %zu devices loaded", m_size, m_devices.size());
+    return 0;
+}
+
+void InventoryCache::evict()
+{
+    // the most recently used device is kept, even when it is bigger than the capacity
+    while (m_size > m_capacity && m_lru.size() > 1) {
+        erase(m_lru.back());
+        m_evictions++;
+    }
+}
+
+// number of rows of one statement of InventoryBuffer::flush
+static constexpr size_t INVENTORY_CHUNK_SIZE = 500;
+
+void InventoryBuffer::add(
+    const std::string& device, const std::string& keytag, bool read_only, const std::string& value)
+{
+    auto inserted = m_pending[device].emplace(keytag, std::make_pair(value, read_only));
+    if (inserted.second) {
+        if (m_size++ == 0) {
+            m_since = zclock_mono();
+        }
+    } else {
+        inserted.first->second = std::make_pair(value, read_only);
+    }
+}
+
+bool InventoryBuffer::has(const std::string& device, const std::string& keytag) const
+{
+    auto found = m_pending.find(device);
+    return found != m_pending.end() && found->second.count(keytag) != 0;
+}
+
+void InventoryBuffer::erase(const std::string& device)
+{
+    auto found = m_pending.find(device);
+    if (found == m_pending.end()) {
+        return;
+    }
+    m_size -= found->second.size();
+    m_pending.erase(found);
+    if (m_size == 0) {
+        m_since = 0;
+    }
+}
+
+int InventoryBuffer::flush(InventoryCache* cache, bool test)
+{
+    std::map<std::string, std::map<std::string, std::pair<std::string, bool>>> pending;
+    std::swap(pending, m_pending);
+    m_size  = 0;
+    m_since = 0;
+
+    if (test || pending.empty())
+        return 0;
+
+    try {
+        tntdb::Connection  conn = tntdb::connectCached(DBConn::url);
+        tntdb::Transaction trans(conn);
+
+        std::vector<std::string> devices;
+        for (const auto& device : pending) {
+            devices.push_back(device.first);
+        }
+
+        std::map<std::string, uint32_t> ids;
+        for (size_t first = 0; first < devices.size(); first += INVENTORY_CHUNK_SIZE) {
+            size_t last = std::min(first + INVENTORY_CHUNK_SIZE, devices.size());
+
+            std::stringstream qs;
+            qs << "SELECT id_asset_element, name FROM t_bios_asset_element WHERE name IN (";
+            for (size_t i = first; i < last; i++) {
+                qs << (i != first ? ", " : "") << ":name" << i;
+            }
+            qs << ")";
+
+            tntdb::Statement st = conn.prepare(qs.str());
+            for (size_t i = first; i < last; i++) {
+                st.set("name" + std::to_string(i), devices[i]);
+            }
+            for (const auto& row : st.select()) {
+                ids[row.getString("name")] = row.getUnsigned32("id_asset_element");
+            }
+        }
+
+        struct Row
+        {
+            uint32_t           id;
+            const std::string* device;
+            const std::string* keytag;
+            const std::string* value;
+            bool               readOnly;
+        };
+        std::vector<Row>         rows;
+        std::vector<std::string> missing;
+        for (const auto& device : pending) {
+            auto id = ids.find(device.first);
+            if (id == ids.end()) {
+                log_warning("inventory of %s not written, asset does not exist", device.first.c_str());
+                missing.push_back(device.first);
+                continue;
+            }
+            for (const auto& attr : device.second) {
+                rows.push_back({id->second, &device.first, &attr.first, &attr.second.first, attr.second.second});
+            }
+        }
+
+        auto execute = [&](size_t first, size_t last) {
+            std::stringstream qs;
+            qs << "INSERT INTO t_bios_asset_ext_attributes (keytag, value, id_asset_element, read_only) VALUES ";
+            for (size_t i = first; i < last; i++) {
+                qs << (i != first ? ", " : "") << "(:keytag" << i << ", :value" << i << ", :id" << i
+                   << ", :readonly" << i << ")";
+            }
+            qs << " ON DUPLICATE KEY UPDATE value = VALUES (value), read_only = VALUES (read_only)";
+
+            tntdb::Statement st = conn.prepare(qs.str());
+            for (size_t i = first; i < last; i++) {
+                std::string n = std::to_string(i);
+                st.set("keytag" + n, *rows[i].keytag)
+                    .set("value" + n, *rows[i].value)
+                    .set("id" + n, rows[i].id)
+                    .set("readonly" + n, rows[i].readOnly);
+            }
+            st.execute();
+        };
+
+        // a failed statement is rolled back alone, so a bad row of a chunk does not hold back the others
+        std::vector<bool> written(rows.size(), true);
+        size_t            dropped = 0;
+        for (size_t first = 0; first < rows.size(); first += INVENTORY_CHUNK_SIZE) {
+            size_t last = std::min(first + INVENTORY_CHUNK_SIZE, rows.size());
+            try {
+                execute(first, last);
+            } catch (const std::exception& e) {
+                log_warning("DB: cannot write inventory chunk, retrying row by row, %s", e.what());
+                for (size_t i = first; i < last; i++) {
+                    try {
+                        execute(i, i + 1);
+                    } catch (const std::exception& err) {
+                        log_error("DB: inventory %s of %s dropped, %s", rows[i].keytag->c_str(),
+                            rows[i].device->c_str(), err.what());
+                        written[i] = false;
+                        dropped++;
+                    }
+                }
+            }
+        }
+
+        trans.commit();
+        log_debug("inventory: %zu values of %zu devices written", rows.size() - dropped, pending.size());
+
+        // only the committed values are known, the other ones are written again next time
+        if (cache) {
+            for (size_t i = 0; i < rows.size(); i++) {
+                if (written[i]) {
+                    cache->set(*rows[i].device, *rows[i].keytag, rows[i].readOnly, *rows[i].value);
+                }
+            }
+            for (const auto& device : missing) {
+                cache->erase(device);
+            }
+        }
+
+        if (dropped != 0) {
+            return -1;
+        }
+    } catch (const std::exception& e) {
+        log_error("DB: cannot write inventory, %s", e.what());
+        return -1;
+    }
+
+    return 0;
+}
+
 /**
- *  \brief Inserts ext attributes from inventory message into DB only
- *         if the new value is different from the cache map
+ *  \brief Queues ext attributes from inventory message into the write buffer
+ *         only if the new value is different from the cache
  *         This method is not thread safe.
  *
  *  \param[in] device_name - iname of assets
  *  \param[in] ext_attributes - recent ext attributes for this asset
  *  \param[in] read_only - whether to insert ext attributes as readonly
  *  \param[in] test - unit tests indicator
- *  \param[in] map_cache -  cache map
+ *  \param[in] cache - values already written by the inventory, updated by InventoryBuffer::flush
+ *  \param[in] buffer - values waiting to be written, see InventoryBuffer::flush
  *
  *  \return  0 - in case of success
  *          -1 - in case of some unexpected error
  */
 int process_insert_inventory(const std::string& device_name, zhash_t* ext_attributes, bool readonly,
-    std::unordered_map<std::string, std::string>& map_cache, bool test)
+    InventoryCache& cache, InventoryBuffer& buffer, bool test)
 {
     if (test)
         return 0;
-    tntdb::Connection conn;
-    try {
-        conn = tntdb::connectCached(DBConn::url);
-    } catch (const std::exception& e) {
-        log_error("DB: cannot connect, %s", e.what());
-        return -1;
-    }
-
-    tntdb::Transaction trans(conn);
-    tntdb::Statement   st = conn.prepareCached(SQL_EXT_ATT_INVENTORY);
 
     for (void* it = zhash_first(ext_attributes); it != NULL; it = zhash_next(ext_attributes)) {
         const char* value     = (const char*)it;
@@ -258,26 +556,13 @@ int process_insert_inventory(const std::string& device_name, zhash_t* ext_attrib
         if (strcmp(keytag, "name") == 0 || strcmp(keytag, "description") == 0)
             readonlyV = false;
 
-        std::string cache_key = device_name;
-        cache_key.append(":").append(keytag).append(readonlyV ? "1" : "0");
-        auto el = map_cache.find(cache_key);
-        if (el != map_cache.end() && el->second == value)
-            continue;
-        try {
-            st.set("keytag", keytag)
-                .set("value", value)
-                .set("device_name", device_name)
-                .set("readonly", readonlyV)
-                .execute();
-            map_cache[cache_key] = value;
-        } catch (const std::exception& e) {
-            log_warning("%s:\texception on updating %s {%s, %s}\n\t%s", "", device_name.c_str(), keytag,
-                value, e.what());
+        // a pending value is always replaced, the cache only knows the committed one
+        if (!buffer.has(device_name, keytag) && cache.contains(device_name, keytag, readonlyV, value))
             continue;
-        }
+
+        buffer.add(device_name, keytag, readonlyV, value);
     }
 
-    trans.commit();
     return 0;
 }
 /**
@@ -26,6 +26,7 @@
 
 
 #include <functional>
+#include <list>
 #include <string>
 #include <map>
 #include <unordered_map>
@@ -85,6 +86,91 @@ FTY_ASSET_PRIVATE int
 
 //////////////////////////////////////////////////////////////////////////////////
 
+// Ext attributes written by the inventory, per device, used to skip unchanged values
+// Keytags are interned, the least recently used devices are evicted above the capacity.
+// This class is not thread safe.
+class FTY_ASSET_PRIVATE InventoryCache
+{
+public:
+    // capacity in number of cached values
+    explicit InventoryCache (size_t capacity = 100000);
+
+    // true if the same value was already written for this keytag of the device
+    bool contains (const std::string& device, const std::string& keytag, bool read_only, const std::string& value);
+    void set (const std::string& device, const std::string& keytag, bool read_only, const std::string& value);
+    // drops all the values of a device
+    void erase (const std::string& device);
+    void clear ();
+
+    void setCapacity (size_t capacity);
+    size_t capacity () const { return m_capacity; }
+
+    // fills the cache with the ext attributes of the devices stored in the DB, up to the capacity
+    // returns 0 in case of success, -1 otherwise
+    int load (bool test);
+
+    size_t size () const { return m_size; }
+    size_t devices () const { return m_devices.size (); }
+
+    // values found unchanged (write skipped), values written, devices evicted
+    uint64_t hits () const { return m_hits; }
+    uint64_t misses () const { return m_misses; }
+    uint64_t evictions () const { return m_evictions; }
+
+private:
+    struct Device
+    {
+        // interned keytag and read only flag -> value
+        std::unordered_map<uint32_t, std::string> values;
+        // position in m_lru
+        std::list<std::string>::iterator lru;
+    };
+
+    uint32_t keyId (const std::string& keytag, bool read_only);
+    Device& touch (const std::string& device);
+    void evict ();
+
+    std::unordered_map<std::string, uint32_t> m_keytags;
+    std::unordered_map<std::string, Device> m_devices;
+    // most recently used device first
+    std::list<std::string> m_lru;
+
+    size_t m_capacity;
+    size_t m_size = 0;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_evictions = 0;
+};
+
+// Inventory ext attributes waiting to be written, merged per device and keytag (last value wins)
+// All of them are written by flush () with multi-row upserts in one transaction.
+// This class is not thread safe.
+class FTY_ASSET_PRIVATE InventoryBuffer
+{
+public:
+    void add (const std::string& device, const std::string& keytag, bool read_only, const std::string& value);
+    // true if a value of this keytag of the device is pending
+    bool has (const std::string& device, const std::string& keytag) const;
+    // drops the pending values of a device
+    void erase (const std::string& device);
+
+    // writes all the pending values, a chunk which fails is retried row by row
+    // only the committed values are set in the cache, the devices which do not exist are dropped from it
+    // returns 0 in case of success, -1 if any value could not be written
+    int flush (InventoryCache* cache, bool test);
+
+    size_t size () const { return m_size; }
+    bool empty () const { return m_size == 0; }
+    // time of the oldest pending value (zclock_mono), 0 when empty
+    int64_t since () const { return m_since; }
+
+private:
+    // device -> keytag -> value, read only
+    std::map<std::string, std::map<std::string, std::pair<std::string, bool>>> m_pending;
+    size_t m_size = 0;
+    int64_t m_since = 0;
+};
+
 // Inserts ext attributes from inventory message into DB
 FTY_ASSET_PRIVATE int
     process_insert_inventory
@@ -93,13 +179,14 @@ FTY_ASSET_PRIVATE int
     bool read_only,
     bool test);
 
-// Inserts ext attributes from inventory message into DB if not present in the cache
+// Queues ext attributes from inventory message into the buffer if not present in the cache
 FTY_ASSET_PRIVATE int
     process_insert_inventory
     (const std::string& device_name,
     zhash_t *ext_attributes,
     bool read_only,
-    std::unordered_map<std::string,std::string> &map_cache,
+    InventoryCache &cache,
+    InventoryBuffer &buffer,
     bool test);
 
 // Selects user-friendly name for given asset name
@@ -28,6 +28,8 @@
 
 #include "fty_asset_classes.h"
 #define DEFAULT_LOG_CONFIG "/etc/fty/ftylog.cfg"
+#define DEFAULT_CONFIG "/etc/fty-asset/fty-asset.cfg"
+#define DEFAULT_SRR_STATE_DIR "/var/lib/fty/fty-asset/srr"
 
 static int
 s_autoupdate_timer (zloop_t *loop, int timer_id, void *output)
@@ -46,6 +48,7 @@ s_repeat_assets_timer (zloop_t *loop, int timer_id, void *output)
 int main (int argc, char *argv [])
 {
     const char* endpoint = "ipc://@/malamute";
+    const char* config_file = DEFAULT_CONFIG;
     ManageFtyLog::setInstanceFtylog("fty-asset", DEFAULT_LOG_CONFIG);
     bool verbose = false;
     int argn;
@@ -55,10 +58,15 @@ int main (int argc, char *argv [])
         ||  streq (argv [argn], "-h")) {
             puts ("fty-asset [options] ...");
             puts ("  --verbose / -v         verbose test output");
+            puts ("  --config / -c          configuration file (default " DEFAULT_CONFIG ")");
             puts ("  --help / -h            this information");
             return 0;
         }
         else
+        if ((streq (argv [argn], "--config")
+        ||   streq (argv [argn], "-c")) && argn + 1 < argc)
+            config_file = argv [++argn];
+        else
         if (streq (argv [argn], "--verbose")
         ||  streq (argv [argn], "-v"))
             verbose = true;
@@ -72,7 +80,19 @@ int main (int argc, char *argv [])
     if (verbose)
         ManageFtyLog::getInstanceFtylog()->setVeboseMode();
 
+    //  missing configuration file means default settings
+    zconfig_t *config = zconfig_load (config_file);
+    if (!config)
+        log_info ("Configuration file %s not loaded, using defaults", config_file);
+
     zactor_t *asset_server = zactor_new (fty_asset_server, (void*) "asset-agent");
+    //  before CONNECTSTREAM, which creates the publishers
+    zstr_sendx (asset_server, "BINARY_NOTIFICATIONS",
+        config ? zconfig_get (config, "asset/binary_notifications", "false") : "false", NULL);
+    zstr_sendx (asset_server, "SRR_VERSION",
+        config ? zconfig_get (config, "srr/version", "1.0") : "1.0", NULL);
+    zstr_sendx (asset_server, "SRR_STATE_DIR",
+        config ? zconfig_get (config, "srr/state_dir", DEFAULT_SRR_STATE_DIR) : DEFAULT_SRR_STATE_DIR, NULL);
     zstr_sendx (asset_server, "CONNECTSTREAM", endpoint, NULL);
     zsock_wait (asset_server);
     zstr_sendx (asset_server, "PRODUCER", "ASSETS", NULL);
@@ -114,5 +134,6 @@ int main (int argc, char *argv [])
     zactor_destroy (&inventory_server);
     zactor_destroy (&autoupdate_server);
     zactor_destroy (&asset_server);
+    zconfig_destroy (&config);
     return 0;
 }
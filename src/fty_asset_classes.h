@@ -83,6 +83,10 @@ typedef struct _topology_shared_utilspp_t topology_shared_utilspp_t;
 typedef struct _topology_shared_location_helpers_t topology_shared_location_helpers_t;
 #define TOPOLOGY_SHARED_LOCATION_HELPERS_T_DEFINED
 #endif
+#ifndef TOPOLOGY_DB_TOPOLOGY_GRAPH_T_DEFINED
+typedef struct _topology_db_topology_graph_t topology_db_topology_graph_t;
+#define TOPOLOGY_DB_TOPOLOGY_GRAPH_T_DEFINED
+#endif
 #ifndef TOPOLOGY_MSG_ASSET_MSG_T_DEFINED
 typedef struct _topology_msg_asset_msg_t topology_msg_asset_msg_t;
 #define TOPOLOGY_MSG_ASSET_MSG_T_DEFINED
@@ -131,6 +135,10 @@ typedef struct _asset_asset_t asset_asset_t;
 typedef struct _asset_asset_utils_t asset_asset_utils_t;
 #define ASSET_ASSET_UTILS_T_DEFINED
 #endif
+#ifndef ASSET_ASSET_JSON_CACHE_T_DEFINED
+typedef struct _asset_asset_json_cache_t asset_asset_json_cache_t;
+#define ASSET_ASSET_JSON_CACHE_T_DEFINED
+#endif
 #ifndef ASSET_ASSET_STORAGE_T_DEFINED
 typedef struct _asset_asset_storage_t asset_asset_storage_t;
 #define ASSET_ASSET_STORAGE_T_DEFINED
@@ -160,6 +168,7 @@ typedef struct _asset_asset_db_test_t asset_asset_db_test_t;
 #include "topology/shared/data.h"
 #include "topology/shared/utilspp.h"
 #include "topology/shared/location_helpers.h"
+#include "topology/db/topology_graph.h"
 #include "topology/msg/asset_msg.h"
 #include "topology/msg/common_msg.h"
 #include "topology/topology_power.h"
@@ -172,6 +181,7 @@ typedef struct _asset_asset_db_test_t asset_asset_db_test_t;
 #include "asset-server.h"
 #include "asset/asset.h"
 #include "asset/asset-utils.h"
+#include "asset/asset-json-cache.h"
 #include "asset/asset-storage.h"
 #include "asset/asset-db.h"
 #include "asset/asset-db-test.h"
@@ -265,6 +265,11 @@ void Asset::setSecondaryID(const std::string& secondaryID)
     m_secondaryID = secondaryID;
 }
 
+void Asset::setParentsList(const std::vector<Asset>& parentsList)
+{
+    m_parentsList = parentsList;
+}
+
 void Asset::dump(std::ostream& os)
 {
     os << "iname       : " << m_internalName << std::endl;
@@ -505,6 +510,8 @@ void UIAsset::deserializeUI(const cxxtools::SerializationInfo& /*si*/)
 #define ANSI_COLOR_GREEN "\x1b[32m"
 #define ANSI_COLOR_RESET "\x1b[0m"
 
+#include "include/asset/conversion/binary.h"
+#include "include/asset/conversion/json.h"
 #include <cassert>
 #include <fstream>
 #include <iostream>
@@ -693,6 +700,212 @@ void fty_asset_dto_test(bool verbose)
         }
     }
 
+    // Next test
+    testNumber = "3.1";
+    testName   = "Fast JSON serialization matches cxxtools serialization";
+    printf(
+        "\n----------------------------------------------------------------"
+        "-------\n");
+    {
+        printf(" *=>  Test #%s %s\n", testNumber.c_str(), testName.c_str());
+
+        try {
+            using namespace fty;
+
+            Asset parent;
+            parent.setInternalName("rack-1");
+            parent.setAssetType(TYPE_RACK);
+
+            Asset asset;
+            asset.setInternalName("ups-1");
+            asset.setAssetStatus(AssetStatus::Active);
+            asset.setAssetType(TYPE_DEVICE);
+            asset.setAssetSubtype(SUB_UPS);
+            asset.setParentIname("rack-1");
+            asset.setPriority(3);
+            asset.setExtEntry("name", "My \"UPS\"\n\\ \xc3\xa9\x01", true);
+            asset.setExtEntry("testKey", "testValue");
+            asset.setLinkedAssets({AssetLink("epdu-1", "1", "", 1), AssetLink("epdu-2", "", "B", 1)});
+
+            std::vector<Asset> withParents = {asset, asset};
+            withParents[1].setParentsList({parent});
+
+            for (const auto& a : withParents) {
+                cxxtools::SerializationInfo si;
+                si <<= a;
+
+                std::ostringstream       output;
+                cxxtools::JsonSerializer serializer(output);
+                serializer.serialize(si);
+
+                if (conversion::toJson(a) != output.str()) {
+                    throw std::runtime_error("Serialization mismatch: " + conversion::toJson(a) + " vs " + output.str());
+                }
+            }
+
+            printf(" *<=  Test #%s > OK\n", testNumber.c_str());
+            testsResults.emplace_back(" Test #" + testNumber + " " + testName, true);
+        } catch (const std::exception& e) {
+            printf(" *<=  Test #%s > Failed\n", testNumber.c_str());
+            printf("Error: %s\n", e.what());
+            testsResults.emplace_back(" Test #" + testNumber + " " + testName, false);
+        }
+    }
+
+    // Next test
+    testNumber = "3.2";
+    testName   = "Fast JSON deserialization matches cxxtools deserialization";
+    printf(
+        "\n----------------------------------------------------------------"
+        "-------\n");
+    {
+        printf(" *=>  Test #%s %s\n", testNumber.c_str(), testName.c_str());
+
+        try {
+            using namespace fty;
+
+            const std::string json =
+                " { \"status\" : \"1\", \"type\":\"device\",\"sub_type\":\"ups\",\"name\":\"ups-1\","
+                "\"priority\":2,\"parent\":\"rack-1\",\"linked\":[{\"source\":\"epdu-1\",\"link_type\":1,"
+                "\"src_out\":\"1\"}],\"ext\":{\"k\":{\"value\":\"\\u00e9\\t\",\"readOnly\":true,\"updated\":true}},"
+                "\"unknown\":[1,{\"a\":null}]} ";
+
+            Asset fast;
+            conversion::fromJson(json, fast);
+
+            Asset                      reference;
+            cxxtools::SerializationInfo si;
+            std::istringstream         input(json);
+            cxxtools::JsonDeserializer deserializer(input);
+            deserializer.deserialize(si);
+            si >>= reference;
+
+            if (fast != reference) {
+                throw std::runtime_error("Deserialization mismatch");
+            }
+
+            // round trip
+            Asset roundTrip;
+            conversion::fromJson(conversion::toJson(fast), roundTrip);
+            if (roundTrip != fast) {
+                throw std::runtime_error("Round trip mismatch");
+            }
+
+            // missing members are rejected
+            bool thrown = false;
+            try {
+                Asset incomplete;
+                conversion::fromJson("{\"status\":1,\"type\":\"device\"}", incomplete);
+            } catch (const std::exception&) {
+                thrown = true;
+            }
+            if (!thrown) {
+                throw std::runtime_error("Incomplete asset accepted");
+            }
+
+            // a repeated member counts once, objects, arrays and bare words are not values
+            const std::string name = "\"name\":\"ups-1\",";
+            const std::string tail = "\"linked\":[],\"ext\":{}}";
+            const std::vector<std::string> invalid = {
+                "{" + name + name + name + name + name + name + name + name + "\"status\":1}",
+                "{\"status\":1,\"type\":{\"a\":1},\"sub_type\":\"ups\"," + name +
+                    "\"priority\":2,\"parent\":\"\"," + tail,
+                "{\"status\":1,\"type\":\"device\",\"sub_type\":[\"ups\"]," + name +
+                    "\"priority\":2,\"parent\":\"\"," + tail,
+                "{\"status\":1,\"type\":\"device\",\"sub_type\":\"ups\"," + name +
+                    "\"priority\":2,\"parent\":rack," + tail};
+            for (const auto& doc : invalid) {
+                thrown = false;
+                try {
+                    Asset bad;
+                    conversion::fromJson(doc, bad);
+                } catch (const std::exception&) {
+                    thrown = true;
+                }
+                if (!thrown) {
+                    throw std::runtime_error("Invalid asset accepted: " + doc);
+                }
+            }
+
+            // numbers, booleans and null are taken as strings
+            Asset scalars;
+            conversion::fromJson("{\"status\":1,\"type\":true,\"sub_type\":null," + name +
+                                     "\"priority\":2,\"parent\":-1.5e3," + tail,
+                scalars);
+            if (scalars.getAssetType() != "true" || !scalars.getAssetSubtype().empty() ||
+                scalars.getParentIname() != "-1.5e3") {
+                throw std::runtime_error("Scalar values mismatch");
+            }
+
+            printf(" *<=  Test #%s > OK\n", testNumber.c_str());
+            testsResults.emplace_back(" Test #" + testNumber + " " + testName, true);
+        } catch (const std::exception& e) {
+            printf(" *<=  Test #%s > Failed\n", testNumber.c_str());
+            printf("Error: %s\n", e.what());
+            testsResults.emplace_back(" Test #" + testNumber + " " + testName, false);
+        }
+    }
+
+    // Next test
+    testNumber = "3.3";
+    testName   = "Binary format round trip";
+    printf(
+        "\n----------------------------------------------------------------"
+        "-------\n");
+    {
+        printf(" *=>  Test #%s %s\n", testNumber.c_str(), testName.c_str());
+
+        try {
+            using namespace fty;
+
+            Asset parent;
+            parent.setInternalName("rack-1");
+            parent.setAssetType(TYPE_RACK);
+
+            Asset asset;
+            asset.setInternalName("ups-1");
+            asset.setAssetStatus(AssetStatus::Active);
+            asset.setAssetType(TYPE_DEVICE);
+            asset.setAssetSubtype("not-a-known-subtype");
+            asset.setParentIname("rack-1");
+            asset.setPriority(3);
+            asset.setExtEntry("name", "My \"UPS\"\n\\ \xc3\xa9\x01", true);
+            asset.setExtEntry("testKey", "testValue");
+            asset.setLinkedAssets({AssetLink("epdu-1", "1", "", 1), AssetLink("epdu-2", "", "B", 1)});
+            asset.setParentsList({parent});
+
+            const std::string data = conversion::toBinary({asset, parent});
+
+            std::vector<Asset> decoded = conversion::fromBinary(data);
+            if (decoded.size() != 2 || decoded[0] != asset || decoded[1] != parent) {
+                throw std::runtime_error("Binary round trip mismatch");
+            }
+            if (conversion::toJson(decoded[0]) != conversion::toJson(asset)) {
+                throw std::runtime_error("Binary round trip JSON mismatch");
+            }
+
+            // truncated payloads are rejected
+            for (size_t size = 0; size < data.size(); size++) {
+                bool thrown = false;
+                try {
+                    conversion::fromBinary(data.substr(0, size));
+                } catch (const std::runtime_error&) {
+                    thrown = true;
+                }
+                if (!thrown) {
+                    throw std::runtime_error("Truncated binary payload accepted");
+                }
+            }
+
+            printf(" *<=  Test #%s > OK\n", testNumber.c_str());
+            testsResults.emplace_back(" Test #" + testNumber + " " + testName, true);
+        } catch (const std::exception& e) {
+            printf(" *<=  Test #%s > Failed\n", testNumber.c_str());
+            printf("Error: %s\n", e.what());
+            testsResults.emplace_back(" Test #" + testNumber + " " + testName, false);
+        }
+    }
+
     // collect results
 
     printf("\n-----------------------------------------------------------------------\n");
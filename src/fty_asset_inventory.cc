@@ -30,6 +30,11 @@
 
 //  Structure of our class
 
+//  Inventory values are written at most after this delay (ms)...
+#define INVENTORY_FLUSH_INTERVAL 1000
+//  ... or as soon as that many values are waiting
+#define INVENTORY_FLUSH_SIZE 1000
+
 void
 fty_asset_inventory_server (zsock_t *pipe, void *args)
 {
@@ -37,14 +42,28 @@ fty_asset_inventory_server (zsock_t *pipe, void *args)
     mlm_client_t *client = mlm_client_new ();
     zpoller_t *poller = zpoller_new (pipe, mlm_client_msgpipe (client), NULL);
     bool test = false;
-    std::unordered_map<std::string, std::string> ext_map_cache;
+    InventoryCache cache;
+    InventoryBuffer buffer;
+    //  cache is loaded on first inventory message, once test mode is known
+    bool cache_loaded = false;
 
     zsock_signal (pipe, 0);
     log_info ("%s:\tStarted", name);
 
     while (!zsys_interrupted)
     {
-        void *which = zpoller_wait (poller, -1);
+        int timeout = -1;
+        if (!buffer.empty ()) {
+            int64_t due = buffer.since () + INVENTORY_FLUSH_INTERVAL - zclock_mono ();
+            timeout = due > 0 ? int (due) : 0;
+        }
+
+        void *which = zpoller_wait (poller, timeout);
+        if (!buffer.empty () && zclock_mono () - buffer.since () >= INVENTORY_FLUSH_INTERVAL) {
+            if (buffer.flush (&cache, test) != 0)
+                log_error ("Could not insert inventory data into DB");
+        }
+
         if (!which)
             continue;
         else
@@ -55,6 +74,9 @@ fty_asset_inventory_server (zsock_t *pipe, void *args)
 
             if (streq (cmd, "$TERM")) {
                 log_info ("%s:\tGot $TERM", name);
+                log_info ("%s:\tCache: %zu values of %zu devices, "
+                    "%" PRIu64 " unchanged, %" PRIu64 " written, %" PRIu64 " evicted",
+                    name, cache.size (), cache.devices (), cache.hits (), cache.misses (), cache.evictions ());
                 zstr_free (&cmd);
                 zmsg_destroy (&msg);
                 break;
@@ -93,6 +115,24 @@ fty_asset_inventory_server (zsock_t *pipe, void *args)
                 zsock_signal (pipe, 0);
             }
             else
+            if (streq (cmd, "FLUSH")) {
+                if (buffer.flush (&cache, test) != 0)
+                    log_error ("Could not insert inventory data into DB");
+                zsock_signal (pipe, 0);
+            }
+            else
+            if (streq (cmd, "CACHE_CAPACITY")) {
+                char* capacity = zmsg_popstr (msg);
+                char* end = NULL;
+                errno = 0;
+                unsigned long value = capacity ? strtoul (capacity, &end, 10) : 0;
+                if (capacity && isdigit ((unsigned char) capacity [0]) && *end == '\0' && errno == 0)
+                    cache.setCapacity (value);
+                else
+                    log_error ("%s:\tInvalid cache capacity '%s'", name, capacity ? capacity : "");
+                zstr_free (&capacity);
+            }
+            else
             {
                 log_info ("%s:\tUnhandled command %s", name, cmd);
             }
@@ -112,24 +152,31 @@ fty_asset_inventory_server (zsock_t *pipe, void *args)
             const char *operation = fty_proto_operation(proto);
 
             if (streq (operation, "inventory")) {
+                if (!cache_loaded) {
+                    //  only the values which really changed since last run are written
+                    if (cache.load (test) != 0)
+                        log_warning ("%s:\tInventory cache starts empty", name);
+                    cache_loaded = true;
+                }
                 zhash_t *ext = fty_proto_ext (proto);
-                int rv = process_insert_inventory (device_name, ext, true, ext_map_cache, test);
+                int rv = process_insert_inventory (device_name, ext, true, cache, buffer, test);
                 if (rv != 0)
                     log_error ("Could not insert inventory data into DB");
+                if (buffer.size () >= INVENTORY_FLUSH_SIZE && buffer.flush (&cache, test) != 0)
+                    log_error ("Could not insert inventory data into DB");
             } else if (streq (operation, "delete")) {
-                //  Vacuum the cache
-                //  The keys are formatted as asset_name:keytag[01]
-                device_name.append(":");
-                for (auto it = ext_map_cache.begin(); it != ext_map_cache.end(); )
-                    if (it->first.compare(0, device_name.size(), device_name) == 0)
-                        it = ext_map_cache.erase(it);
-                    else
-                        ++it;
+                //  Vacuum the cache, pending values would be written for a removed asset
+                buffer.erase (device_name);
+                cache.erase (device_name);
             }
             fty_proto_destroy (&proto);
         }
     }
 
+    //  Nothing pending is lost on shutdown
+    if (buffer.flush (&cache, test) != 0)
+        log_error ("Could not insert inventory data into DB");
+
     mlm_client_destroy (&client);
     zpoller_destroy (&poller);
     zstr_free (&name);
@@ -182,6 +229,49 @@ fty_asset_inventory_test (bool verbose)
         log_info ("fty-asset-server-test:Test #2: OK");
     }
 
+    //  Test #3: inventory cache
+    {
+        log_debug ("fty-asset-server-test:Test #3");
+        InventoryCache cache (4);
+        assert (!cache.contains ("ups-1", "model", true, "9PX"));
+        cache.set ("ups-1", "model", true, "9PX");
+        cache.set ("ups-1", "serial_no", true, "G202");
+        assert (cache.contains ("ups-1", "model", true, "9PX"));
+        // read only flag and value are part of the key
+        assert (!cache.contains ("ups-1", "model", false, "9PX"));
+        assert (!cache.contains ("ups-1", "model", true, "9SX"));
+        cache.set ("ups-1", "model", true, "9SX");
+        assert (cache.size () == 2);
+        assert (cache.hits () == 1 && cache.misses () == 3);
+
+        // ups-1 is the least recently used device
+        cache.set ("epdu-2", "model", true, "G3");
+        cache.set ("epdu-3", "model", true, "G3");
+        cache.set ("epdu-3", "serial_no", true, "A1");
+        assert (cache.devices () == 2 && cache.size () == 3);
+        assert (cache.evictions () == 1);
+        assert (!cache.contains ("ups-1", "model", true, "9SX"));
+
+        cache.erase ("epdu-3");
+        assert (cache.devices () == 1 && cache.size () == 1);
+        assert (cache.contains ("epdu-2", "model", true, "G3"));
+
+        // pending values are merged per device and keytag
+        InventoryBuffer buffer;
+        assert (buffer.empty () && buffer.since () == 0);
+        buffer.add ("ups-1", "model", true, "9PX");
+        buffer.add ("ups-1", "model", true, "9SX");
+        buffer.add ("ups-1", "serial_no", true, "G202");
+        buffer.add ("epdu-2", "model", true, "G3");
+        assert (buffer.size () == 3 && buffer.since () != 0);
+        assert (buffer.has ("ups-1", "model") && !buffer.has ("ups-1", "location"));
+        buffer.erase ("epdu-2");
+        assert (buffer.size () == 2 && !buffer.has ("epdu-2", "model"));
+        assert (buffer.flush (&cache, true) == 0);
+        assert (buffer.empty () && buffer.since () == 0);
+        log_info ("fty-asset-server-test:Test #3: OK");
+    }
+
     zactor_destroy (&inventory_server);
     mlm_client_destroy (&ui);
     zactor_destroy (&server);
@@ -199,6 +199,7 @@
 #include <functional>
 #include <malamute.h>
 #include <mlm_client.h>
+#include <sstream>
 #include <string>
 #include <sys/time.h>
 #include <tntdb/connect.h>
@@ -830,6 +831,23 @@ static zmsg_t* s_publish_create_or_update_asset_msg(const std::string& client_na
     return msg;
 }
 
+// reload one asset of the resident topology model, see asset-server.cc
+void refresh_topology_model(const std::string& asset_name)
+{
+    persist::TopologyGraph::instance().refresh(asset_name);
+    total_power_invalidate(asset_name);
+    topology_processor_invalidate();
+}
+
+// drop the whole resident topology model, after all the assets were removed or restored
+void reset_topology_model()
+{
+    persist::TopologyGraph::instance().invalidate();
+    // unknown asset drops all the cached results
+    total_power_invalidate("");
+    topology_processor_invalidate();
+}
+
 void send_create_or_update_asset(
     const fty::AssetServer& server, const std::string& asset_name, const char* operation, bool read_only)
 {
@@ -1071,6 +1089,19 @@ static void s_handle_subject_asset_manipulation(const fty::AssetServer& server,
     zmsg_destroy(&reply);
 }
 
+// changes made by other agents are applied to the resident topology model here,
+// local writes are applied as soon as they are notified
+static void s_update_topology_model(const fty::AssetServer& server, fty_proto_t* msg, const char* sender)
+{
+    assert(msg);
+
+    const std::string streamName = server.getAgentName() + "-stream";
+    if ((sender && streamName == sender) || streq(fty_proto_operation(msg), FTY_PROTO_ASSET_OP_INVENTORY)) {
+        return;
+    }
+    refresh_topology_model(fty_proto_name(msg));
+}
+
 static void s_update_topology(const fty::AssetServer& server, fty_proto_t* msg)
 {
     assert(msg);
@@ -1204,6 +1235,9 @@ void fty_asset_server(zsock_t* pipe, void* args)
             } else if (streq(cmd, "PRODUCER")) {
                 char* stream = zmsg_popstr(msg);
                 server.setTestMode(streq(stream, "ASSETS-TEST"));
+                // TOPOLOGY requests are answered from the resident model, load it right away
+                persist::TopologyGraph::instance().setEnabled(!server.getTestMode());
+                persist::TopologyGraph::instance().ensureLoaded();
                 int rv = mlm_client_set_producer(const_cast<mlm_client_t*>(server.getStreamClient()), stream);
                 if (rv == -1) {
                     log_error(
@@ -1241,6 +1275,25 @@ void fty_asset_server(zsock_t* pipe, void* args)
 
                 zstr_free(&endpoint);
                 zsock_signal(pipe, 0);
+            } else if (streq(cmd, "BINARY_NOTIFICATIONS")) {
+                char* enabled = zmsg_popstr(msg);
+                server.setBinaryNotifications(enabled && streq(enabled, "true"));
+                zstr_free(&enabled);
+            } else if (streq(cmd, "SRR_VERSION")) {
+                char* version = zmsg_popstr(msg);
+                if (version && (streq(version, SRR_ACTIVE_VERSION) || streq(version, SRR_COMPACT_VERSION))) {
+                    server.setSrrVersion(version);
+                } else {
+                    log_error("%s:\tUnsupported SRR version '%s'", server.getAgentName().c_str(),
+                        version ? version : "");
+                }
+                zstr_free(&version);
+            } else if (streq(cmd, "SRR_STATE_DIR")) {
+                char* dir = zmsg_popstr(msg);
+                if (dir && *dir) {
+                    server.setSrrStateDir(dir);
+                }
+                zstr_free(&dir);
             } else if (streq(cmd, "REPEAT_ALL")) {
                 s_repeat_all(server);
                 log_debug("%s:\tREPEAT_ALL end", server.getAgentName().c_str());
@@ -1301,6 +1354,8 @@ void fty_asset_server(zsock_t* pipe, void* args)
             if (is_fty_proto(zmessage)) {
                 fty_proto_t* bmsg = fty_proto_decode(&zmessage);
                 if (fty_proto_id(bmsg) == FTY_PROTO_ASSET) {
+                    s_update_topology_model(server, bmsg,
+                        mlm_client_sender(const_cast<mlm_client_t*>(server.getStreamClient())));
                     s_update_topology(server, bmsg);
                 } else if (fty_proto_id(bmsg) == FTY_PROTO_METRIC) {
                     handle_incoming_limitations(server, bmsg);
@@ -1324,6 +1379,16 @@ void fty_asset_server(zsock_t* pipe, void* args)
 // stores correlationID : asset JSON for each message received
 std::map<std::string, std::string> assetTestMap;
 
+struct AssetListTest
+{
+    std::string test;
+    bool        withParentsList;
+    // requested id, found
+    std::vector<std::pair<std::string, bool>> items;
+};
+// stores correlationID : expected reply for each GET_LIST message
+std::map<std::string, AssetListTest> assetListTestMap;
+
 static void test_asset_mailbox_handler(const messagebus::Message& msg)
 {
     try {
@@ -1369,6 +1434,34 @@ static void test_asset_mailbox_handler(const messagebus::Message& msg)
             } else {
                 log_error("fty-asset-server-test:Test #15.3: FAILED");
             }
+        } else if (msgSubject == FTY_ASSET_SUBJECT_GET_LIST) {
+            const AssetListTest& expected =
+                assetListTestMap.at(msg.metaData().find(messagebus::Message::CORRELATION_ID)->second);
+
+            // one item per requested id, in the order of the request
+            cxxtools::SerializationInfo si = assetutils::deserialize(msg.userData().back());
+
+            bool   ok = si.memberCount() == expected.items.size();
+            size_t i  = 0;
+            for (auto it = si.begin(); ok && it != si.end(); ++it, ++i) {
+                std::string id;
+                std::string status;
+                it->getMember("id") >>= id;
+                it->getMember("status") >>= status;
+
+                bool                               found = (status == "OK");
+                const cxxtools::SerializationInfo* asset = it->findMember("asset");
+
+                ok = id == expected.items[i].first && found == expected.items[i].second &&
+                     found == (asset != nullptr) &&
+                     (!found || (asset->findMember("parents_list") != nullptr) == expected.withParentsList);
+            }
+
+            if (ok) {
+                log_info("fty-asset-server-test:Test #%s: OK", expected.test.c_str());
+            } else {
+                log_error("fty-asset-server-test:Test #%s: FAILED", expected.test.c_str());
+            }
         } else {
             log_error("fty-asset-server-test:Invalid subject %s", msgSubject.c_str());
         }
@@ -1871,6 +1964,64 @@ void fty_asset_server_test(bool /*verbose*/)
         log_debug("fty-asset-server-test:Test #14 OK");
     }
 
+    // Test #14.1: cache of the JSON representation of the assets
+    {
+        log_debug("fty-asset-server-test:Test #14.1");
+
+        fty::AssetJsonCache cache(2);
+
+        fty::Asset asset;
+        asset.setInternalName("ups-1");
+        asset.setAssetStatus(fty::AssetStatus::Active);
+        asset.setAssetType(fty::TYPE_DEVICE);
+        asset.setAssetSubtype(fty::SUB_UPS);
+        asset.setParentIname("rack-1");
+        asset.setExtEntry("name", "UPS 1");
+
+        // a hit is the same as the serialization
+        const std::string json = fty::conversion::toJson(asset);
+        assert(cache.toJson(asset) == json);
+        assert(cache.toJson(asset) == json);
+        assert(cache.hits() == 1 && cache.misses() == 1);
+
+        // a changed asset with the same iname is serialized again
+        fty::Asset changed = asset;
+        changed.setExtEntry("name", "UPS 1 renamed");
+        assert(cache.toJson(changed) == fty::conversion::toJson(changed));
+        assert(cache.toJson(changed) != json);
+        assert(cache.hits() == 2 && cache.misses() == 2);
+
+        // UPDATE and DELETE drop the entry
+        cache.invalidate("ups-1");
+        assert(cache.toJson(changed) == fty::conversion::toJson(changed));
+        assert(cache.misses() == 3);
+        cache.invalidate("ups-1");
+        cache.invalidate("unknown-1");
+        assert(cache.toJson(changed) == fty::conversion::toJson(changed));
+        assert(cache.hits() == 2 && cache.misses() == 4);
+
+        cache.clear();
+        cache.toJson(changed);
+        assert(cache.hits() == 2 && cache.misses() == 5);
+
+        // the least recently used asset is evicted at capacity
+        fty::Asset epdu = asset;
+        epdu.setInternalName("epdu-2");
+        fty::Asset sensor = asset;
+        sensor.setInternalName("sensor-3");
+        cache.toJson(epdu);
+        cache.toJson(changed);
+        cache.toJson(sensor);
+        assert(cache.hits() == 3 && cache.misses() == 7);
+        assert(cache.toJson(changed) == fty::conversion::toJson(changed));
+        assert(cache.toJson(sensor) == fty::conversion::toJson(sensor));
+        assert(cache.hits() == 5 && cache.misses() == 7);
+        assert(cache.toJson(epdu) == fty::conversion::toJson(epdu));
+        assert(cache.hits() == 5 && cache.misses() == 8);
+
+        log_debug("fty-asset-server-test:Test #14.1 OK");
+    }
+
     // Test #15: new generation asset interface
     {
         static const char* FTY_ASSET_TEST_Q   = "FTY.Q.ASSET.TEST";
@@ -1957,6 +2108,268 @@ void fty_asset_server_test(bool /*verbose*/)
         log_info("fty-asset-server-test:Test #15.3: send GET message");
         publisher->sendRequest(FTY_ASSET_MAILBOX, msg);
         zclock_sleep(200);
+
+        // test get list, found and missing inames and uuids, without and with the parents lists
+        for (bool withParentsList : {false, true}) {
+            msg.metaData().clear();
+            msg.metaData().emplace(messagebus::Message::CORRELATION_ID, messagebus::generateUuid());
+            msg.metaData().emplace(messagebus::Message::SUBJECT, FTY_ASSET_SUBJECT_GET_LIST);
+            msg.metaData().emplace(messagebus::Message::FROM, FTY_ASSET_TEST_REC);
+            msg.metaData().emplace(messagebus::Message::TO, FTY_ASSET_TEST_MAIL_NAME);
+            msg.metaData().emplace(messagebus::Message::REPLY_TO, FTY_ASSET_TEST_Q);
+            if (withParentsList) {
+                msg.metaData().emplace(METADATA_WITH_PARENTS_LIST, "true");
+            }
+
+            const std::vector<std::string> inames = {"test-asset", std::string(fty::DBTEST_MISSING_PREFIX) + "ups",
+                "epdu-2"};
+            const std::vector<std::string> uuids  = {std::string(fty::DBTEST_MISSING_PREFIX) + "uuid", "uuid-1"};
+
+            cxxtools::SerializationInfo request;
+            request.addMember("inames") <<= inames;
+            request.addMember("uuids") <<= uuids;
+
+            msg.userData().clear();
+            msg.userData().push_back(assetutils::serialize(request));
+
+            AssetListTest expected;
+            expected.test            = withParentsList ? "15.5" : "15.4";
+            expected.withParentsList = withParentsList;
+            expected.items = {{inames[0], true}, {inames[1], false}, {inames[2], true}, {uuids[0], false},
+                {uuids[1], true}};
+            assetListTestMap.emplace(msg.metaData().find(messagebus::Message::CORRELATION_ID)->second, expected);
+
+            log_info("fty-asset-server-test:Test #%s: send GET_LIST message", expected.test.c_str());
+            publisher->sendRequest(FTY_ASSET_MAILBOX, msg);
+            zclock_sleep(200);
+        }
+    }
+
+    // Test #16: compact SRR helpers
+    {
+        log_debug("fty-asset-server-test:Test #16");
+
+        using namespace fty::assetutils;
+
+        auto throws = [](const std::function<void()>& f) {
+            try {
+                f();
+            } catch (std::runtime_error&) {
+                return true;
+            }
+            return false;
+        };
+
+        // varints and strings
+        std::string data;
+        const std::vector<unsigned long> values = {0, 1, 127, 128, 300, 0xFFFFFFFFul, ~0ul};
+        for (unsigned long v : values) {
+            writeVarint(data, v);
+        }
+        writeString(data, "");
+        writeString(data, "dc-0");
+        size_t pos = 0;
+        for (unsigned long v : values) {
+            assert(readVarint(data, pos) == v);
+        }
+        assert(readString(data, pos).empty());
+        assert(readString(data, pos) == "dc-0");
+        assert(pos == data.size());
+        assert(throws([&] {
+            readVarint(data, pos);
+        }));
+        assert(throws([] {
+            size_t p = 0;
+            readVarint(std::string("\x80", 1), p);
+        }));
+        assert(throws([] {
+            size_t p = 0;
+            readString(std::string("\x05" "abc"), p);
+        }));
+
+        // LZ77, matches may overlap the bytes they produce
+        std::string binary;
+        for (int i = 0; i < 1000; i++) {
+            binary += char((i * 7919) % 251);
+        }
+        const std::vector<std::string> texts = {"", "abc", std::string(1000, 'a'),
+            "abcabcabcabcabcabcabcabcabcabc", "asset-1 asset-2 asset-3 asset-1 asset-2 asset-3", binary};
+        for (const auto& text : texts) {
+            std::string compressed = compress(text);
+            assert(uncompress(compressed, text.size()) == text);
+        }
+        assert(compress(std::string(1000, 'a')).size() < 10);
+        assert(throws([] {
+            uncompress(compress("abcdefgh"), 7);
+        }));
+        assert(throws([] {
+            // match offset out of the produced data
+            std::string bad;
+            writeVarint(bad, 1);
+            bad += 'a';
+            writeVarint(bad, 2);
+            writeVarint(bad, 0);
+            uncompress(bad, 5);
+        }));
+
+        // CRC-32 check values
+        assert(crc32("") == 0);
+        assert(crc32("123456789") == 0xCBF43926u);
+        assert(crc32("123456789") != crc32("123456788"));
+
+        // base64 (RFC 4648 test vectors)
+        assert(base64Encode("") == "");
+        assert(base64Encode("f") == "Zg==");
+        assert(base64Encode("fo") == "Zm8=");
+        assert(base64Encode("foobar") == "Zm9vYmFy");
+        assert(base64Decode("") == "");
+        assert(base64Decode("Zg==") == "f");
+        assert(base64Decode("Zm8=") == "fo");
+        assert(base64Decode("Zm9vYmFy") == "foobar");
+        std::string bytes;
+        for (int i = 0; i < 256; i++) {
+            bytes += char(i);
+        }
+        assert(base64Decode(base64Encode(bytes)) == bytes);
+        for (const char* bad : {"Zg=", "Zg=a", "Z===", "Zg==Zg==", "Zm9*", "Zm9v\n"}) {
+            assert(throws([bad] {
+                base64Decode(bad);
+            }));
+        }
+
+        log_debug("fty-asset-server-test:Test #16 OK");
+    }
+
+    // Test #17: SRR 2.0 blocks
+    {
+        log_debug("fty-asset-server-test:Test #17");
+
+        auto throws = [](const std::function<void()>& f) {
+            try {
+                f();
+            } catch (std::runtime_error&) {
+                return true;
+            }
+            return false;
+        };
+
+        std::vector<fty::AssetImpl> assets(2);
+        assets[0].setInternalName("rack-1");
+        assets[0].setAssetStatus(fty::AssetStatus::Active);
+        assets[0].setAssetType(fty::TYPE_RACK);
+        assets[0].setAssetSubtype("N_A");
+        assets[0].setParentIname("datacenter-1");
+        assets[0].setPriority(2);
+        assets[0].setExtEntry("name", "Rack 1");
+        assets[1].setInternalName("epdu-2");
+        assets[1].setAssetStatus(fty::AssetStatus::Nonactive);
+        assets[1].setAssetType(fty::TYPE_DEVICE);
+        assets[1].setAssetSubtype(fty::SUB_EPDU);
+        assets[1].setParentIname("rack-1");
+        assets[1].setPriority(5);
+        assets[1].setAssetTag("tag-2");
+        assets[1].setExtEntry("name", "ePDU 2");
+        assets[1].setExtEntry("serial_no", "1234", true);
+        assets[1].setLinkedAssets({fty::AssetLink("ups-3", "1", "A", 1)});
+
+        // raw block
+        std::string raw = fty::AssetImpl::assetsToSrrBlock(assets);
+        std::vector<fty::AssetImpl> decoded = fty::AssetImpl::srrBlockToAssets(raw);
+        assert(decoded.size() == 2);
+        assert(decoded[0] == assets[0]);
+        assert(decoded[1] == assets[1]);
+        assert(fty::AssetImpl::srrBlockToAssets(fty::AssetImpl::assetsToSrrBlock({})).empty());
+        assert(throws([&] {
+            fty::AssetImpl::srrBlockToAssets(raw.substr(0, raw.size() - 1));
+        }));
+
+        // block line
+        std::string line = fty::AssetServer::encodeSrrBlock(assets);
+        decoded          = fty::AssetServer::decodeSrrBlock(line);
+        assert(decoded.size() == 2);
+        assert(decoded[0] == assets[0]);
+        assert(decoded[1] == assets[1]);
+        assert(fty::AssetServer::decodeSrrBlock(fty::AssetServer::encodeSrrBlock({})).empty());
+        assert(throws([&] {
+            fty::AssetServer::decodeSrrBlock(line.substr(0, line.size() - 4));
+        }));
+        assert(throws([] {
+            fty::AssetServer::decodeSrrBlock("AA==");
+        }));
+
+        // corrupt the checksum, which follows the block size
+        std::string block = fty::assetutils::base64Decode(line);
+        size_t      pos   = 0;
+        fty::assetutils::readVarint(block, pos);
+        block[pos] = char(block[pos] ^ 0x01);
+        assert(throws([&] {
+            fty::AssetServer::decodeSrrBlock(fty::assetutils::base64Encode(block));
+        }));
+
+        log_debug("fty-asset-server-test:Test #17 OK");
+    }
+
+    // Test #18: SRR 2.0 full save followed by a delta
+    {
+        log_debug("fty-asset-server-test:Test #18");
+
+        auto throws = [](const std::string& data) {
+            try {
+                std::istringstream in(data);
+                fty::AssetServer::readSrrData(in);
+            } catch (std::runtime_error&) {
+                return true;
+            }
+            return false;
+        };
+
+        std::vector<fty::AssetImpl> assets(3);
+        assets[0].setInternalName("rack-1");
+        assets[0].setAssetType(fty::TYPE_RACK);
+        assets[1].setInternalName("epdu-2");
+        assets[1].setAssetType(fty::TYPE_DEVICE);
+        assets[1].setParentIname("rack-1");
+        assets[2].setInternalName("ups-3");
+        assets[2].setAssetType(fty::TYPE_DEVICE);
+        assets[2].setParentIname("rack-1");
+
+        fty::AssetImpl updated = assets[1];
+        updated.setExtEntry("name", "ePDU 2");
+        fty::AssetImpl created;
+        created.setInternalName("sensor-4");
+        created.setAssetType(fty::TYPE_DEVICE);
+        created.setParentIname("epdu-2");
+
+        const std::string header = "FTY-ASSET-SRR 2.0 ";
+        const std::string full   = header + "SNAPSHOT 0000000a\n" + fty::AssetServer::encodeSrrBlock(assets) + "\n" +
+                                 "END 3\n";
+        const std::string delta = header + "DELTA 0000000b 0000000a\n" +
+                                  fty::AssetServer::encodeSrrBlock({updated, created}) + "\n" +
+                                  "DELETED ups-3\n" + "END 2\n";
+
+        // full save alone
+        std::istringstream in(full);
+        std::vector<fty::AssetImpl> restored = fty::AssetServer::readSrrData(in);
+        assert(restored.size() == 3);
+        assert(restored[1] == assets[1]);
+
+        // updated assets keep their place, created ones come last, deleted ones are dropped
+        in.str(full + delta);
+        in.clear();
+        restored = fty::AssetServer::readSrrData(in);
+        assert(restored.size() == 3);
+        assert(restored[0] == assets[0]);
+        assert(restored[1] == updated);
+        assert(restored[2] == created);
+
+        // a delta of another snapshot, a delta without its full save, truncated data
+        assert(throws(full + header + "DELTA 0000000c 0000000b\nEND 0\n"));
+        assert(throws(delta));
+        assert(throws(full + header + "DELTA 0000000b 0000000a\n" + "DELETED ups-3\n"));
+        assert(throws(full + full));
+        assert(throws(header + "SNAPSHOT 0000000a\n" + fty::AssetServer::encodeSrrBlock(assets) + "\nEND 2\n"));
+
+        log_debug("fty-asset-server-test:Test #18 OK");
     }
 
     zactor_destroy(&autoupdate_server);
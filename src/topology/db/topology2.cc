@@ -54,8 +54,6 @@
 
 #include "../../fty_asset_classes.h"
 
-#define PARENT_LEVEL_COUNT 10
-
 namespace persist {
 
 static std::string
@@ -188,8 +186,8 @@ s_mkspc (int level) {
     return ret;
 }
 
-static void
-s_topology2_devices_in_groups (
+void
+topology2_devices_in_groups (
     tntdb::Connection& conn,
     Item &item)
 {
@@ -265,7 +263,7 @@ topology2_groups (
                 };
 
         if (recursive)
-            s_topology2_devices_in_groups (conn, item);
+            topology2_devices_in_groups (conn, item);
         ret.push_back (item);
     }
     return ret;
@@ -331,131 +329,68 @@ topology2_feed_by (
     return nm.feed_by (feed_by);
 }
 
-//  return a topology
+//  return a location subtree
 //
 //  from    - iname of asset where topology starts
-//  filter  - (datacenter,row,rack,room,device) - show only selected types
-//  recursive - true|false
-//  feed_by - additional filtering - only devices feed by given iname
 //
-//  return tntdb::Result
+//  walks id_parent down from the asset using recursive query, so there
+//  is no limit on location depth, ext attributes are joined once per asset
+//
+//  return Topology2Subtree
 //
 
-tntdb::Result
+Topology2Subtree
 topology2_from (
     tntdb::Connection& conn,
     const std::string& from)
 {
-
-    // TODO: db error handling
-    std::string query = \
+    // clang-format off
+    tntdb::Statement st = conn.prepare (
+        " WITH RECURSIVE subtree (id, depth) AS ( "
+        "     SELECT e.id_asset_element, 0 "
+        "     FROM t_bios_asset_element AS e "
+        "     INNER JOIN t_bios_asset_device_type AS t ON t.id_asset_device_type = e.id_subtype "
+        "     WHERE e.name = :from "
+        "   UNION ALL "
+        "     SELECT e.id_asset_element, s.depth + 1 "
+        "     FROM t_bios_asset_element AS e "
+        "     INNER JOIN subtree AS s ON e.id_parent = s.id "
+        " ) "
         " SELECT "
-        "    t1.id AS DBID1,    "
-        "    t2.id AS DBID2,    "
-        "    t3.id AS DBID3,    "
-        "    t4.id AS DBID4,    "
-        "    t5.id AS DBID5,    "
-        "    t6.id AS DBID6,    "
-        "    t7.id AS DBID7,    "
-        "    t8.id AS DBID8,    "
-        "    t9.id AS DBID9,    "
-        "    t10.id AS DBID10,  "
-        "    t11.id AS DBID11,  "
-        "    t1.name AS ID1,    "
-        "    t2.name AS ID2,    "
-        "    t3.name AS ID3,    "
-        "    t4.name AS ID4,    "
-        "    t5.name AS ID5,    "
-        "    t6.name AS ID6,    "
-        "    t7.name AS ID7,    "
-        "    t8.name AS ID8,    "
-        "    t9.name AS ID9,    "
-        "    t10.name AS ID10,  "
-        "    t11.name AS ID11,  "
-        "    t1.id_type AS TYPEID1,     "
-        "    t2.id_type AS TYPEID2,     "
-        "    t3.id_type AS TYPEID3,     "
-        "    t4.id_type AS TYPEID4,     "
-        "    t5.id_type AS TYPEID5,     "
-        "    t6.id_type AS TYPEID6,     "
-        "    t7.id_type AS TYPEID7,     "
-        "    t8.id_type AS TYPEID8,     "
-        "    t9.id_type AS TYPEID9,     "
-        "    t10.id_type AS TYPEID10,   "
-        "    t11.id_type AS TYPEID11,   "
-        "    t1.id_subtype AS SUBTYPEID1,   "
-        "    t2.id_subtype AS SUBTYPEID2,   "
-        "    t3.id_subtype AS SUBTYPEID3,   "
-        "    t4.id_subtype AS SUBTYPEID4,   "
-        "    t5.id_subtype AS SUBTYPEID5,   "
-        "    t6.id_subtype AS SUBTYPEID6,   "
-        "    t7.id_subtype AS SUBTYPEID7,   "
-        "    t8.id_subtype AS SUBTYPEID8,   "
-        "    t9.id_subtype AS SUBTYPEID9,   "
-        "    t10.id_subtype AS SUBTYPEID10, "
-        "    t11.id_subtype AS SUBTYPEID11, "
-        "    t1ext.value AS ASSET_ORDER1,   "
-        "    t2ext.value AS ASSET_ORDER2,   "
-        "    t3ext.value AS ASSET_ORDER3,   "
-        "    t4ext.value AS ASSET_ORDER4,   "
-        "    t5ext.value AS ASSET_ORDER5,   "
-        "    t6ext.value AS ASSET_ORDER6,   "
-        "    t7ext.value AS ASSET_ORDER7,   "
-        "    t8ext.value AS ASSET_ORDER8,   "
-        "    t9ext.value AS ASSET_ORDER9,   "
-        "    t10ext.value AS ASSET_ORDER10, "
-        "    t11ext.value AS ASSET_ORDER11, "
-        "    t1name.value AS NAME1,     "
-        "    t2name.value AS NAME2,     "
-        "    t3name.value AS NAME3,     "
-        "    t4name.value AS NAME4,     "
-        "    t5name.value AS NAME5,     "
-        "    t6name.value AS NAME6,     "
-        "    t7name.value AS NAME7,     "
-        "    t8name.value AS NAME8,     "
-        "    t9name.value AS NAME9,     "
-        "    t10name.value AS NAME10,   "
-        "    t11name.value AS NAME11    "
-        "  FROM v_bios_asset_element AS t1  "
-        "    LEFT JOIN v_bios_asset_element AS t2 ON t2.id_parent = t1.id       "
-        "    LEFT JOIN v_bios_asset_element AS t3 ON t3.id_parent = t2.id       "
-        "    LEFT JOIN v_bios_asset_element AS t4 ON t4.id_parent = t3.id       "
-        "    LEFT JOIN v_bios_asset_element AS t5 ON t5.id_parent = t4.id       "
-        "    LEFT JOIN v_bios_asset_element AS t6 ON t6.id_parent = t5.id       "
-        "    LEFT JOIN v_bios_asset_element AS t7 ON t7.id_parent = t6.id       "
-        "    LEFT JOIN v_bios_asset_element AS t8 ON t8.id_parent = t7.id       "
-        "    LEFT JOIN v_bios_asset_element AS t9 ON t9.id_parent = t8.id       "
-        "    LEFT JOIN v_bios_asset_element AS t10 ON t10.id_parent = t9.id     "
-        "    LEFT JOIN v_bios_asset_element AS t11 ON t11.id_parent = t10.id    "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t1ext ON (t1.id = t1ext.id_asset_element AND t1ext.keytag=\"asset_order\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t2ext ON (t2.id = t2ext.id_asset_element AND t2ext.keytag=\"asset_order\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t3ext ON (t3.id = t3ext.id_asset_element AND t3ext.keytag=\"asset_order\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t4ext ON (t4.id = t4ext.id_asset_element AND t4ext.keytag=\"asset_order\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t5ext ON (t5.id = t5ext.id_asset_element AND t5ext.keytag=\"asset_order\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t6ext ON (t6.id = t6ext.id_asset_element AND t6ext.keytag=\"asset_order\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t7ext ON (t7.id = t7ext.id_asset_element AND t7ext.keytag=\"asset_order\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t8ext ON (t8.id = t8ext.id_asset_element AND t8ext.keytag=\"asset_order\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t9ext ON (t9.id = t9ext.id_asset_element AND t9ext.keytag=\"asset_order\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t10ext ON (t10.id = t10ext.id_asset_element AND t10ext.keytag=\"asset_order\")    "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t11ext ON (t11.id = t11ext.id_asset_element AND t11ext.keytag=\"asset_order\")    "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t1name ON (t1.id = t1name.id_asset_element AND t1name.keytag=\"name\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t2name ON (t2.id = t2name.id_asset_element AND t2name.keytag=\"name\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t3name ON (t3.id = t3name.id_asset_element AND t3name.keytag=\"name\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t4name ON (t4.id = t4name.id_asset_element AND t4name.keytag=\"name\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t5name ON (t5.id = t5name.id_asset_element AND t5name.keytag=\"name\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t6name ON (t6.id = t6name.id_asset_element AND t6name.keytag=\"name\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t7name ON (t7.id = t7name.id_asset_element AND t7name.keytag=\"name\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t8name ON (t8.id = t8name.id_asset_element AND t8name.keytag=\"name\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t9name ON (t9.id = t9name.id_asset_element AND t9name.keytag=\"name\")        "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t10name ON (t10.id = t10name.id_asset_element AND t10name.keytag=\"name\")    "
-        "    LEFT JOIN t_bios_asset_ext_attributes AS t11name ON (t11.id = t11name.id_asset_element AND t11name.keytag=\"name\")    "
-        "    INNER JOIN t_bios_asset_device_type AS v1 ON (v1.id_asset_device_type = t1.id_subtype) "
-        "  WHERE t1.name=:from ";
-
-    tntdb::Statement st = conn.prepare (query);
+        "    s.depth AS DEPTH, "
+        "    e.name AS ID, "
+        "    p.name AS PARENT, "
+        "    e.id_type AS TYPEID, "
+        "    e.id_subtype AS SUBTYPEID, "
+        "    ord.value AS ASSET_ORDER, "
+        "    ext.value AS NAME "
+        " FROM subtree AS s "
+        "    INNER JOIN t_bios_asset_element AS e ON e.id_asset_element = s.id "
+        "    LEFT JOIN t_bios_asset_element AS p ON p.id_asset_element = e.id_parent "
+        "    LEFT JOIN t_bios_asset_ext_attributes AS ord ON (ord.id_asset_element = s.id AND ord.keytag=\"asset_order\") "
+        "    LEFT JOIN t_bios_asset_ext_attributes AS ext ON (ext.id_asset_element = s.id AND ext.keytag=\"name\") "
+        " ORDER BY s.depth, s.id ");
+    // clang-format on
 
     st.set ("from", from);
-    return st.select ();
+
+    Topology2Subtree subtree {};
+    for (const auto& row: st.select ()) {
+        Topology2Node node {};
+
+        node.depth = row.getInt ("DEPTH");
+        if (node.depth != 0)
+            node.parent = s_get (row, "PARENT");
+
+        node.cell.id = s_get (row, "ID");
+        node.cell.name = s_get (row, "NAME");
+        node.cell.type = s_geti (row, "TYPEID");
+        node.cell.subtype = s_geti (row, "SUBTYPEID");
+        node.cell.asset_order = s_geti (row, "ASSET_ORDER");
+
+        subtree.push_back (node);
+    }
+    return subtree;
 }
 
 static int
@@ -486,7 +421,7 @@ fctOrderByName (const Item &i1, const Item &i2)
 void
 topology2_from_json (
     std::ostream &out,
-    tntdb::Result &res,
+    const Topology2Subtree &subtree,
     const std::string &from,
     const std::string &filter,
     const std::set <std::string> &feeded_by,
@@ -499,53 +434,52 @@ topology2_from_json (
 
     int filter_type = s_filter_type (filter);
 
-    for (const auto& row: res) {
-        for (int i = 1; i != 3; i++) {
-
-            std::string idx = std::to_string (i);
-            std::string ID {"ID"}; ID.append (idx);
-            std::string TYPE {"TYPEID"}; TYPE.append (idx);
-            std::string SUBTYPE {"SUBTYPEID"}; SUBTYPE.append (idx);
-            std::string NAME {"NAME"}; NAME.append (idx);
-            std::string ASSET_ORDER {"ASSET_ORDER"}; ASSET_ORDER.append (idx);
-
-            // feed_by filtering
-            std::string id = s_get (row, ID);
-
-            if (id == from) {
-                item_from = Item {
-                    id,
-                    s_get (row, NAME),
-                    persist::subtypeid_to_subtype (s_geti (row, SUBTYPE)),
-                    persist::typeid_to_type (s_geti (row, TYPE))};
-                continue;
-            }
+    for (const auto& node: subtree) {
 
-            if (!feeded_by.empty () && feeded_by.count (id) == 0)
-                continue;
+        // only the asset and its direct children are listed
+        if (node.depth > 1)
+            break;
 
-            // filter - type filtering
-            int type = s_geti (row, TYPE);
-            if (s_should_filter (filter_type, type))
-                continue;
+        const Topology2Cell &cell = node.cell;
 
-            if (processed.count (id) != 0 || id == "(null)")
-                continue;
+        // feed_by filtering
+        const std::string &id = cell.id;
 
-            Item item {
+        if (id == from) {
+            item_from = Item {
                 id,
-                s_get (row, NAME),
-                persist::subtypeid_to_subtype (s_geti (row, SUBTYPE)),
-                persist::typeid_to_type (s_geti (row, TYPE))};
-            item.asset_order = s_geti (row, ASSET_ORDER);
+                cell.name,
+                persist::subtypeid_to_subtype (cell.subtype),
+                persist::typeid_to_type (cell.type)};
+            continue;
+        }
 
-            if (item.asset_order < 0) {
-                item.asset_order = 0;
-            }
-            topo.push_back (item);
+        if (!feeded_by.empty () && feeded_by.count (id) == 0)
+            continue;
 
-            processed.emplace (id);
+        // filter - type filtering
+        int type = cell.type;
+        if (s_should_filter (filter_type, type))
+            continue;
+
+        if (processed.count (id) != 0 || id == "(null)")
+            continue;
+
+        Item item {
+            id,
+            cell.name,
+            persist::subtypeid_to_subtype (cell.subtype),
+            persist::typeid_to_type (cell.type)};
+        item.asset_order = cell.asset_order;
+
+        if (item.asset_order < 0) {
+            item.asset_order = 0;
         }
+        topo.push_back (item);
+
+        processed.emplace (id);
+    }
+    if (!subtree.empty ()) {
         topo.sort (fctOrderByName);
         topo.groups.insert (topo.groups.end (), groups.begin (), groups.end ());
     }
@@ -611,27 +545,19 @@ s_should_filter_recursive (int query_type, int asset_type)
 void
 topology2_from_json_recursive (
     std::ostream &out,
-    tntdb::Connection &conn,
-    tntdb::Result &res,
+    const Topology2Subtree &subtree,
     const std::string &from,
     const std::string &filter,
     const std::set <std::string> &feeded_by,
-    const std::vector <Item> &groups)
+    const std::vector <Item> &groups,
+    std::function <void (Item&)> devices_in_group)
 {
     NodeMap nm {};
     // build the topology using NodeMap put data to map string->Item
-    for (const auto& row: res) {
-        for (int i = 1; i != PARENT_LEVEL_COUNT; i++) {
-            std::string name = s_get (row, "ID" + std::to_string (i));
-            std::string kid = s_get (row, "ID" + std::to_string (i+1));
-
-            if (name != "(null)") {
-                if (kid != "(null)")
-                    nm.add (name, kid);
-                else
-                    nm.add (name);
-            }
-        }
+    for (const auto& node: subtree) {
+        if (node.depth != 0)
+            nm.add (node.parent, node.cell.id);
+        nm.add (node.cell.id);
     }
 
     int query_type = s_filter_type (filter);
@@ -642,59 +568,51 @@ topology2_from_json_recursive (
     std::string from_type;
     std::string from_subtype;
     Item it2;
-    for (const auto& row: res) {
+    for (const auto& node: subtree) {
 
-        for (int i = 1; i != PARENT_LEVEL_COUNT+1; i++) {
+        const Topology2Cell &cell = node.cell;
 
-            std::string idx = std::to_string (i);
-            std::string ID {"ID"}; ID.append (idx);
-            std::string TYPE {"TYPEID"}; TYPE.append (idx);
-            std::string SUBTYPE {"SUBTYPEID"}; SUBTYPE.append (idx);
-            std::string NAME {"NAME"}; NAME.append (idx);
-            std::string ASSET_ORDER {"ASSET_ORDER"}; ASSET_ORDER.append (idx);
+        const std::string &id = cell.id;
 
-            std::string id = s_get (row, ID);
+        if (!id.compare (from)) {
 
-            if (!id.compare (from)) {
+            from_type = persist::typeid_to_type (cell.type);
+            from_subtype = persist::subtypeid_to_subtype (cell.subtype);
 
-                from_type = persist::typeid_to_type (s_geti (row, TYPE));
-                from_subtype = persist::subtypeid_to_subtype (s_geti (row, SUBTYPE));
+            it2.id = from;
+            it2.name = cell.name,
+            it2.subtype =  from_subtype;
+            it2.type =  from_type;
+            it2.asset_order = 0;
+        }
 
-                it2.id = from;
-                it2.name = s_get (row, NAME),
-                it2.subtype =  from_subtype;
-                it2.type =  from_type;
-                it2.asset_order = 0;
-            }
+        // feed_by filtering - for devices only
+        int type = cell.type;
+        if (type == persist::asset_type::DEVICE
+        && (!feeded_by.empty () && feeded_by.count (id) == 0))
+            continue;
 
-            // feed_by filtering - for devices only
-            int type = s_geti (row, TYPE);
-            if (type == persist::asset_type::DEVICE
-            && (!feeded_by.empty () && feeded_by.count (id) == 0))
-                continue;
+        // filter - type filtering
+        if (s_should_filter_recursive (query_type, type))
+            continue;
 
-            // filter - type filtering
-            if (s_should_filter_recursive (query_type, type))
-                continue;
+        if (processed.count (id) != 0 || id == "(null)")
+            continue;
 
-            if (processed.count (id) != 0 || id == "(null)")
-                continue;
+        Item it {
+            id,
+                cell.name,
+                persist::subtypeid_to_subtype (cell.subtype),
+                persist::typeid_to_type (cell.type)};
+        it.asset_order = cell.asset_order;
+        if (it.asset_order < 0)
+            it.asset_order = 0;
 
-            Item it {
-                id,
-                    s_get (row, NAME),
-                    persist::subtypeid_to_subtype (s_geti (row, SUBTYPE)),
-                    persist::typeid_to_type (s_geti (row, TYPE))};
-            it.asset_order = s_geti (row, ASSET_ORDER);
-            if (it.asset_order < 0)
-                it.asset_order = 0;
-
-            if (s_geti (row, TYPE) == persist::asset_type::GROUP)
-                s_topology2_devices_in_groups (conn, it);
-
-            im.insert (std::make_pair (id, it));
-            processed.emplace (id);
-        }
+        if (cell.type == persist::asset_type::GROUP)
+            devices_in_group (it);
+
+        im.insert (std::make_pair (id, it));
+        processed.emplace (id);
     }
 
     Item::Topology topo {};
@@ -31,6 +31,7 @@
 
 #include <cxxtools/serializationinfo.h>
 #include <algorithm>
+#include <functional>
 #include <fty_common.h>
 
 namespace persist {
@@ -113,6 +114,38 @@ struct Item
     friend void operator<<= (cxxtools::SerializationInfo &si, const Item &asset);
 }; //Item
 
+//  one asset of a location subtree
+//
+//  holds what the row accessors return, "(null)" for missing strings
+//  and -1 for missing numbers, so subtrees coming from the database and
+//  subtrees built in memory are serialized the same way
+
+struct Topology2Cell
+{
+    std::string id {"(null)"};
+    std::string name {"(null)"};
+    int type {-1};
+    int subtype {-1};
+    int asset_order {-1};
+};
+
+//  one node of topology2_from - the asset, iname of its parent
+//  and distance from the starting asset
+
+struct Topology2Node
+{
+    Topology2Cell cell;
+    std::string parent;
+    int depth {0};
+};
+
+//  all assets located under the starting asset, whatever deep
+//
+//  the starting asset comes first, then its descendants in breadth
+//  first order - each node follows its parent
+
+typedef std::vector <Topology2Node> Topology2Subtree;
+
 //
 //  maps node to it's kids, ideal structure for feed_by queries
 //
@@ -138,6 +171,13 @@ struct Item
 //  feed_by ("epdu2") -> {"epdu2", "srv2.1", "srv2.2"};
 //
 
+//  add all devices in group item.id to item.contains
+
+void
+topology2_devices_in_groups (
+    tntdb::Connection& conn,
+    Item &item);
+
 //  return all groups for given id
 //
 //  if recursive, return all devices in this group
@@ -159,16 +199,13 @@ topology2_feed_by (
     tntdb::Connection& conn,
     const std::string& feed_by);
 
-//  return a topology frovm
+//  return a location subtree
 //
 //  from    - iname of asset where topology starts
-//  filter  - (datacenter,row,rack,room,device) - show only selected types
-//  recursive - true|false
-//  feed_by - additional filtering - only devices feed by given iname
 //
-//  return tntdb::Result
+//  return Topology2Subtree, empty if from does not exist
 
-tntdb::Result
+Topology2Subtree
 topology2_from (
     tntdb::Connection& conn,
     const std::string& from);
@@ -176,7 +213,7 @@ topology2_from (
 //  serialize topology returned by topology2_from to ostream
 //
 //  out - output stream
-//  ret - tntdb::Result from topology2_from
+//  subtree - topology2_from subtree
 //  filter - show only given devices
 //  feeded_by - if not empty - show only devices from this set
 //  groups - list of groups device belongs to
@@ -184,7 +221,7 @@ topology2_from (
 void
 topology2_from_json (
     std::ostream &out,
-    tntdb::Result &res,
+    const Topology2Subtree &subtree,
     const std::string &from,
     const std::string &filter,
     const std::set <std::string> &feeded_by,
@@ -194,20 +231,21 @@ topology2_from_json (
 //  recursive variant
 //
 //  out - output stream
-//  ret - tntdb::Result from topology2_from
+//  subtree - topology2_from subtree
 //  filter - show only given devices
 //  feeded_by - if not empty - show only devices from this set
 //  groups - list of groups device belongs to
+//  devices_in_group - adds devices of a group item to its contains
 
 void
 topology2_from_json_recursive (
     std::ostream &out,
-    tntdb::Connection &conn,
-    tntdb::Result &res,
+    const Topology2Subtree &subtree,
     const std::string &from,
-    const std::string &_filter,
+    const std::string &filter,
     const std::set <std::string> &feeded_by,
-    const std::vector <Item> &groups);
+    const std::vector <Item> &groups,
+    std::function <void (Item&)> devices_in_group);
 
 // returns TRUE if asset_name is a power device
 // returns FALSE otherwise
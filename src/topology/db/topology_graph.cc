@@ -0,0 +1,992 @@
+/*  =========================================================================
+    topology_db_topology_graph - In-memory topology model
+
+    Copyright (C) 2016 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    topology_db_topology_graph - In-memory topology model
+@discuss
+    Location tree, power links and group membership of all assets, loaded
+    once from the database and refreshed asset by asset afterwards.
+@end
+*/
+
+#include <tntdb/connect.h>
+#include <tntdb/error.h>
+#include <tntdb/result.h>
+#include <tntdb/row.h>
+#include <tntdb/statement.h>
+#include <algorithm>
+#include <strings.h>
+#include <fty_common.h>
+#include <fty_common_db.h>
+#include <fty_common_db_dbpath.h>
+
+#include "../../fty_asset_classes.h"
+
+namespace persist {
+
+// t_bios_asset_device_type ids of power devices, see is_power_device
+static const std::set <a_dvc_tp_id_t> POWER_DEVICE_SUBTYPES {1, 2, 3, 4, 6, 7};
+
+TopologyGraph&
+TopologyGraph::instance ()
+{
+    static TopologyGraph graph;
+    return graph;
+}
+
+void
+TopologyGraph::setEnabled (bool enabled)
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    m_enabled = enabled;
+    if (!enabled)
+        clear ();
+}
+
+bool
+TopologyGraph::ensureLoaded ()
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    if (!m_enabled)
+        return false;
+    if (m_loaded)
+        return true;
+
+    try {
+        tntdb::Connection conn = tntdb::connectCached (DBConn::url);
+        load (conn);
+        m_loaded = true;
+        log_info ("topology model loaded: %zu assets, %zu links", m_nodes.size (), m_links.size ());
+    }
+    catch (const std::exception &e) {
+        log_error ("cannot load topology model: %s", e.what ());
+        clear ();
+    }
+    return m_loaded;
+}
+
+void
+TopologyGraph::invalidate ()
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    clear ();
+}
+
+void
+TopologyGraph::clear ()
+{
+    m_loaded = false;
+    m_nodes.clear ();
+    m_inames.clear ();
+    m_children.clear ();
+    m_descendants.clear ();
+    m_links.clear ();
+    m_linksFrom.clear ();
+    m_linksTo.clear ();
+    m_groupMembers.clear ();
+    m_memberOf.clear ();
+    m_powerValid = false;
+}
+
+// columns: id_asset_element, name, id_type, id_subtype, id_parent, subtype_name
+void
+TopologyGraph::loadNode (const tntdb::Row &row)
+{
+    Node n;
+    row [0].get (n.id);
+    row [1].get (n.iname);
+    row [2].get (n.typeId);
+    row [3].get (n.subtypeId);
+    row [4].get (n.parentId);
+    n.hasSubtypeName = row [5].get (n.subtypeName);
+
+    bool moved = true;
+    auto it = m_nodes.find (n.id);
+    if (it != m_nodes.end ()) {
+        // keep ext attributes, they are reloaded separately
+        if (it->second.parentId != n.parentId) {
+            m_children [it->second.parentId].erase (n.id);
+            placeSubtree (n.id, it->second.parentId, false);
+        }
+        else
+            moved = false;
+        n.extName = it->second.extName;
+        n.hasExtName = it->second.hasExtName;
+        n.assetOrder = it->second.assetOrder;
+        n.hasAssetOrder = it->second.hasAssetOrder;
+        n.groupType = it->second.groupType;
+        n.hasGroupType = it->second.hasGroupType;
+    }
+    if (n.parentId != 0)
+        m_children [n.parentId].insert (n.id);
+    m_inames [n.iname] = n.id;
+    m_nodes [n.id] = n;
+    if (moved)
+        placeSubtree (n.id, n.parentId, true);
+}
+
+// adds the asset and everything under it to (or removes it from) the closure
+// of all its ancestors, an ancestor not loaded yet carries the subtree
+// further up when it is loaded itself
+void
+TopologyGraph::placeSubtree (a_elmnt_id_t id, a_elmnt_id_t parent_id, bool add)
+{
+    std::vector <a_elmnt_id_t> subtree {id};
+    auto under = m_descendants.find (id);
+    if (under != m_descendants.end ())
+        subtree.insert (subtree.end (), under->second.begin (), under->second.end ());
+
+    std::set <a_elmnt_id_t> visited {id};
+    for (a_elmnt_id_t ancestor = parent_id; ancestor != 0 && visited.insert (ancestor).second; ) {
+        if (add)
+            m_descendants [ancestor].insert (subtree.begin (), subtree.end ());
+        else {
+            auto it = m_descendants.find (ancestor);
+            if (it != m_descendants.end ())
+                for (const auto member_id : subtree)
+                    it->second.erase (member_id);
+        }
+        const Node *n = node (ancestor);
+        ancestor = n ? n->parentId : 0;
+    }
+}
+
+void
+TopologyGraph::setExt (a_elmnt_id_t id, const std::string &keytag, const std::string &value)
+{
+    auto it = m_nodes.find (id);
+    if (it == m_nodes.end ())
+        return;
+
+    Node &n = it->second;
+    if (keytag == "name") {
+        n.extName = value;
+        n.hasExtName = true;
+    }
+    else
+    if (keytag == "asset_order") {
+        n.assetOrder = value;
+        n.hasAssetOrder = true;
+    }
+    else
+    if (keytag == "type") {
+        n.groupType = value;
+        n.hasGroupType = true;
+    }
+}
+
+void
+TopologyGraph::addLink (const Link &link)
+{
+    m_links [link.id] = link;
+    m_linksFrom [link.src].insert (link.id);
+    m_linksTo [link.dest].insert (link.id);
+    m_powerValid = false;
+}
+
+void
+TopologyGraph::removeLinksTo (a_elmnt_id_t id)
+{
+    auto it = m_linksTo.find (id);
+    if (it == m_linksTo.end ())
+        return;
+
+    for (const auto link_id : it->second) {
+        auto link = m_links.find (link_id);
+        if (link == m_links.end ())
+            continue;
+        m_linksFrom [link->second.src].erase (link_id);
+        m_links.erase (link);
+    }
+    m_linksTo.erase (it);
+    m_powerValid = false;
+}
+
+void
+TopologyGraph::removeGroupRelations (a_elmnt_id_t id)
+{
+    for (const auto group_id : m_memberOf [id])
+        m_groupMembers [group_id].erase (id);
+    m_memberOf.erase (id);
+
+    for (const auto member_id : m_groupMembers [id])
+        m_memberOf [member_id].erase (id);
+    m_groupMembers.erase (id);
+}
+
+void
+TopologyGraph::removeNode (a_elmnt_id_t id)
+{
+    auto it = m_nodes.find (id);
+    if (it == m_nodes.end ())
+        return;
+
+    removeLinksTo (id);
+    auto from = m_linksFrom.find (id);
+    if (from != m_linksFrom.end ()) {
+        for (const auto link_id : from->second) {
+            auto link = m_links.find (link_id);
+            if (link == m_links.end ())
+                continue;
+            m_linksTo [link->second.dest].erase (link_id);
+            m_links.erase (link);
+        }
+        m_linksFrom.erase (from);
+        m_powerValid = false;
+    }
+    removeGroupRelations (id);
+
+    placeSubtree (id, it->second.parentId, false);
+    m_descendants.erase (id);
+    m_children [it->second.parentId].erase (id);
+    m_children.erase (id);
+    m_inames.erase (it->second.iname);
+    m_nodes.erase (it);
+}
+
+// clang-format off
+static const char *SELECT_ELEMENTS =
+    " SELECT "
+    "   e.id_asset_element, e.name, e.id_type, e.id_subtype, e.id_parent, t.name "
+    " FROM t_bios_asset_element AS e "
+    " LEFT JOIN t_bios_asset_device_type AS t "
+    "   ON e.id_subtype = t.id_asset_device_type ";
+
+static const char *SELECT_EXT =
+    " SELECT id_asset_element, keytag, value "
+    " FROM t_bios_asset_ext_attributes "
+    " WHERE keytag IN ('name', 'asset_order', 'type') ";
+
+static const char *SELECT_LINKS =
+    " SELECT id_link, id_asset_device_src, src_out, id_asset_device_dest, dest_in, id_asset_link_type "
+    " FROM t_bios_asset_link ";
+
+static const char *SELECT_GROUPS =
+    " SELECT id_asset_group, id_asset_element "
+    " FROM t_bios_asset_group_relation ";
+// clang-format on
+
+static TopologyGraph::Link
+s_link (const tntdb::Row &row)
+{
+    TopologyGraph::Link link;
+    row [0].get (link.id);
+    row [1].get (link.src);
+    link.hasSrcOut = row [2].get (link.srcOut);
+    row [3].get (link.dest);
+    link.hasDestIn = row [4].get (link.destIn);
+    row [5].get (link.typeId);
+    return link;
+}
+
+void
+TopologyGraph::load (tntdb::Connection &conn)
+{
+    clear ();
+
+    for (const auto &row : conn.prepare (SELECT_ELEMENTS).select ())
+        loadNode (row);
+
+    for (const auto &row : conn.prepare (SELECT_EXT).select ()) {
+        a_elmnt_id_t id = 0;
+        std::string keytag, value;
+        row [0].get (id);
+        row [1].get (keytag);
+        row [2].get (value);
+        setExt (id, keytag, value);
+    }
+
+    for (const auto &row : conn.prepare (SELECT_LINKS).select ())
+        addLink (s_link (row));
+
+    for (const auto &row : conn.prepare (SELECT_GROUPS).select ()) {
+        a_elmnt_id_t group_id = 0, id = 0;
+        row [0].get (group_id);
+        row [1].get (id);
+        m_groupMembers [group_id].insert (id);
+        m_memberOf [id].insert (group_id);
+    }
+}
+
+void
+TopologyGraph::refresh (const std::string &iname)
+{
+    std::lock_guard <std::mutex> refresh_lock (m_refreshMutex);
+    {
+        std::lock_guard <std::mutex> lock (m_mutex);
+        if (!m_loaded)
+            return;
+    }
+
+    //  the database is read without holding m_mutex, readers are only blocked while the model is updated
+    tntdb::Result elements, ext, links, groups;
+    a_elmnt_id_t id = 0;
+    try {
+        tntdb::Connection conn = tntdb::connectCached (DBConn::url);
+
+        // clang-format off
+        elements = conn.prepareCached (
+            std::string (SELECT_ELEMENTS) + " WHERE e.name = :name ").set ("name", iname).select ();
+        // clang-format on
+
+        if (!elements.empty ()) {
+            elements.getRow (0) [0].get (id);
+
+            // clang-format off
+            ext = conn.prepareCached (
+                std::string (SELECT_EXT) + " AND id_asset_element = :id ").set ("id", id).select ();
+            links = conn.prepareCached (
+                std::string (SELECT_LINKS) + " WHERE id_asset_device_dest = :id ").set ("id", id).select ();
+            groups = conn.prepareCached (
+                std::string (SELECT_GROUPS) + " WHERE id_asset_element = :id OR id_asset_group = :id ")
+                .set ("id", id).select ();
+            // clang-format on
+        }
+    }
+    catch (const std::exception &e) {
+        // reload everything on next use rather than answer from a stale model
+        log_error ("cannot refresh '%s' in topology model: %s", iname.c_str (), e.what ());
+        invalidate ();
+        return;
+    }
+
+    std::lock_guard <std::mutex> lock (m_mutex);
+    if (!m_loaded)
+        return;
+
+    try {
+        if (elements.empty ()) {
+            auto it = m_inames.find (iname);
+            if (it != m_inames.end ())
+                removeNode (it->second);
+            log_debug ("topology model: '%s' removed", iname.c_str ());
+            return;
+        }
+
+        loadNode (elements.getRow (0));
+
+        Node &n = m_nodes.at (id);
+        n.hasExtName = n.hasAssetOrder = n.hasGroupType = false;
+        n.extName.clear ();
+        n.assetOrder.clear ();
+        n.groupType.clear ();
+
+        for (const auto &row : ext) {
+            std::string keytag, value;
+            row [1].get (keytag);
+            row [2].get (value);
+            setExt (id, keytag, value);
+        }
+
+        // links are owned by their destination, power sources are set on the powered asset
+        removeLinksTo (id);
+        for (const auto &row : links)
+            addLink (s_link (row));
+
+        removeGroupRelations (id);
+        for (const auto &row : groups) {
+            a_elmnt_id_t group_id = 0, member_id = 0;
+            row [0].get (group_id);
+            row [1].get (member_id);
+            m_groupMembers [group_id].insert (member_id);
+            m_memberOf [member_id].insert (group_id);
+        }
+        log_debug ("topology model: '%s' refreshed", iname.c_str ());
+    }
+    catch (const std::exception &e) {
+        log_error ("cannot refresh '%s' in topology model: %s", iname.c_str (), e.what ());
+        clear ();
+    }
+}
+
+const TopologyGraph::Node*
+TopologyGraph::node (a_elmnt_id_t id) const
+{
+    auto it = m_nodes.find (id);
+    return it == m_nodes.end () ? nullptr : &it->second;
+}
+
+const TopologyGraph::Node*
+TopologyGraph::node (const std::string &iname) const
+{
+    auto it = m_inames.find (iname);
+    return it == m_inames.end () ? nullptr : node (it->second);
+}
+
+bool
+TopologyGraph::isUnder (const Node &n, a_elmnt_id_t container_id) const
+{
+    auto under = m_descendants.find (container_id);
+    return under != m_descendants.end () && under->second.count (n.id) != 0;
+}
+
+device_info_t
+TopologyGraph::deviceInfo (const Node &n) const
+{
+    return std::make_tuple (n.id, n.iname, n.subtypeName, n.subtypeId);
+}
+
+static powerlink_info_t
+s_powerlink_info (const TopologyGraph::Link &link)
+{
+    return std::make_tuple (
+        link.src, link.hasSrcOut ? link.srcOut : SRCOUT_DESTIN_IS_NULL,
+        link.dest, link.hasDestIn ? link.destIn : SRCOUT_DESTIN_IS_NULL);
+}
+
+int64_t
+TopologyGraph::nameToId (const std::string &iname) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    const Node *n = node (iname);
+    return n ? n->id : -1;
+}
+
+std::pair <std::string, std::string>
+TopologyGraph::idToNameExtName (a_elmnt_id_t id) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    const Node *n = node (id);
+    if (!n || !n->hasExtName)
+        return std::make_pair ("", "");
+    return std::make_pair (n->iname, n->extName);
+}
+
+int
+TopologyGraph::powerFrom (
+    a_elmnt_id_t id,
+    std::set <device_info_t> &devices,
+    std::set <powerlink_info_t> &powerlinks) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    const Node *start = node (id);
+    if (!start)
+        return DB_ERROR_NOTFOUND;
+    if (start->subtypeId == persist::asset_subtype::N_A)
+        return DB_ERROR_BADINPUT;
+
+    devices.insert (deviceInfo (*start));
+    auto from = m_linksFrom.find (id);
+    if (from == m_linksFrom.end ())
+        return 0;
+
+    for (const auto link_id : from->second) {
+        const Link &link = m_links.at (link_id);
+        const Node *dest = node (link.dest);
+        if (link.typeId != INPUT_POWER_CHAIN || !dest)
+            continue;
+        powerlinks.insert (s_powerlink_info (link));
+        devices.insert (deviceInfo (*dest));
+    }
+    return 0;
+}
+
+int
+TopologyGraph::powerTo (
+    a_elmnt_id_t id,
+    std::set <device_info_t> &devices,
+    std::set <powerlink_info_t> &powerlinks) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    const Node *start = node (id);
+    if (!start)
+        return DB_ERROR_NOTFOUND;
+    if (start->subtypeId == persist::asset_subtype::N_A)
+        return DB_ERROR_BADINPUT;
+
+    // walk the power chain upstream, every device is visited once
+    std::set <a_elmnt_id_t> visited {id};
+    std::vector <const Node*> todo {start};
+    devices.insert (deviceInfo (*start));
+
+    while (!todo.empty ()) {
+        const Node *current = todo.back ();
+        todo.pop_back ();
+
+        auto to = m_linksTo.find (current->id);
+        if (to == m_linksTo.end ())
+            continue;
+
+        for (const auto link_id : to->second) {
+            const Link &link = m_links.at (link_id);
+            const Node *src = node (link.src);
+            if (link.typeId != INPUT_POWER_CHAIN || !src)
+                continue;
+            powerlinks.insert (s_powerlink_info (link));
+            if (visited.insert (src->id).second) {
+                devices.insert (deviceInfo (*src));
+                todo.push_back (src);
+            }
+        }
+    }
+    return 0;
+}
+
+int
+TopologyGraph::powerGroup (
+    a_elmnt_id_t id,
+    std::set <device_info_t> &devices,
+    std::set <powerlink_info_t> &powerlinks) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    auto members = m_groupMembers.find (id);
+    if (members == m_groupMembers.end ())
+        return 0;
+
+    for (const auto member_id : members->second) {
+        const Node *member = node (member_id);
+        if (!member)
+            continue;
+        devices.insert (deviceInfo (*member));
+
+        auto from = m_linksFrom.find (member_id);
+        if (from == m_linksFrom.end ())
+            continue;
+        for (const auto link_id : from->second) {
+            const Link &link = m_links.at (link_id);
+            if (link.typeId == INPUT_POWER_CHAIN && members->second.count (link.dest) != 0)
+                powerlinks.insert (s_powerlink_info (link));
+        }
+    }
+    return 0;
+}
+
+int
+TopologyGraph::powerDatacenter (
+    a_elmnt_id_t id,
+    std::set <device_info_t> &devices,
+    std::set <powerlink_info_t> &powerlinks) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    auto under = m_descendants.find (id);
+    if (under == m_descendants.end ())
+        return 0;
+
+    for (const auto member_id : under->second) {
+        const Node *n = node (member_id);
+        if (!n)
+            continue;
+        if (n->typeId == persist::asset_type::DEVICE)
+            devices.insert (std::make_tuple (
+                n->id, n->iname, persist::subtypeid_to_subtype (n->subtypeId), n->subtypeId));
+
+        auto from = m_linksFrom.find (member_id);
+        if (from == m_linksFrom.end ())
+            continue;
+        for (const auto link_id : from->second) {
+            const Link &link = m_links.at (link_id);
+            if (link.typeId == INPUT_POWER_CHAIN && under->second.count (link.dest) != 0)
+                powerlinks.insert (s_powerlink_info (link));
+        }
+    }
+    return 0;
+}
+
+int
+TopologyGraph::descendants (a_elmnt_id_t id, std::vector <Node> &nodes) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    if (!node (id))
+        return DB_ERROR_NOTFOUND;
+
+    auto under = m_descendants.find (id);
+    if (under == m_descendants.end ())
+        return 0;
+    nodes.reserve (nodes.size () + under->second.size ());
+    for (const auto member_id : under->second) {
+        const Node *n = node (member_id);
+        if (n)
+            nodes.push_back (*n);
+    }
+    return 0;
+}
+
+int
+TopologyGraph::containerPowerLinks (
+    a_elmnt_id_t id,
+    std::set <std::pair <a_elmnt_id_t, a_elmnt_id_t>> &links) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    if (!node (id))
+        return DB_ERROR_NOTFOUND;
+
+    auto under = m_descendants.find (id);
+    if (under == m_descendants.end ())
+        return 0;
+
+    auto add = [this, &links] (const std::unordered_map <a_elmnt_id_t, std::set <a_lnk_id_t>> &index, a_elmnt_id_t member_id) {
+        auto it = index.find (member_id);
+        if (it == index.end ())
+            return;
+        for (const auto link_id : it->second) {
+            const Link &link = m_links.at (link_id);
+            if (link.typeId == INPUT_POWER_CHAIN)
+                links.emplace (link.src, link.dest);
+        }
+    };
+    for (const auto member_id : under->second) {
+        add (m_linksFrom, member_id);
+        add (m_linksTo, member_id);
+    }
+    return 0;
+}
+
+int
+TopologyGraph::locationTo (a_elmnt_id_t id, std::vector <LocationStep> &path) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    const Node *n = node (id);
+    if (!n)
+        return DB_ERROR_NOTFOUND;
+
+    while (n) {
+        if (path.size () > m_nodes.size ()) {
+            log_error ("location loop detected for element %" PRIu32, id);
+            return DB_ERROR_INTERNAL;
+        }
+        // the type name of groups is their 'type' ext attribute
+        if (n->typeId == persist::asset_type::GROUP && !n->hasGroupType)
+            return DB_ERROR_NOTFOUND;
+
+        path.push_back (LocationStep {
+            n->id,
+            n->typeId,
+            n->iname,
+            n->typeId == persist::asset_type::GROUP ? n->groupType : n->subtypeName});
+        n = n->parentId != 0 ? node (n->parentId) : nullptr;
+    }
+    return 0;
+}
+
+int
+TopologyGraph::parentsAndSources (
+    a_elmnt_id_t id,
+    std::set <a_elmnt_id_t> &parents,
+    std::set <a_elmnt_id_t> &sources) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    const Node *n = node (id);
+    if (!n)
+        return DB_ERROR_NOTFOUND;
+
+    auto to = m_linksTo.find (id);
+    if (to != m_linksTo.end ())
+        for (const auto link_id : to->second)
+            sources.insert (m_links.at (link_id).src);
+
+    // a location loop is stopped on the first parent seen twice
+    while (n->parentId != 0 && parents.insert (n->parentId).second) {
+        n = node (n->parentId);
+        if (!n)
+            break;
+    }
+    return 0;
+}
+
+void
+TopologyGraph::inputPowerGroup (
+    a_elmnt_id_t datacenter_id,
+    std::map <std::string, std::pair <std::string, std::string>> &devices,
+    std::vector <std::tuple <std::string, std::string, std::string, std::string>> &powerchains) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+
+    auto device = [&devices] (const Node &n) {
+        devices.emplace (std::to_string (n.id), std::make_pair (n.iname, n.subtypeName));
+    };
+    auto powerchain = [&powerchains] (const Link &link) {
+        powerchains.push_back (std::make_tuple (
+            std::to_string (link.dest), link.destIn,
+            std::to_string (link.src), link.srcOut));
+    };
+
+    std::set <a_elmnt_id_t> empty;
+    auto children = m_children.find (datacenter_id);
+    const std::set <a_elmnt_id_t> &kids = children == m_children.end () ? empty : children->second;
+
+    // first input power group placed in the datacenter
+    const Node *group = nullptr;
+    for (const auto kid_id : kids) {
+        const Node *kid = node (kid_id);
+        if (kid && kid->typeId == persist::asset_type::GROUP
+            && kid->hasGroupType && kid->groupType == "input_power") {
+            group = kid;
+            break;
+        }
+    }
+
+    std::set <a_elmnt_id_t> members;
+    if (group) {
+        auto it = m_groupMembers.find (group->id);
+        if (it != m_groupMembers.end ())
+            members = it->second;
+    }
+    else {
+        for (const auto kid_id : kids) {
+            const Node *kid = node (kid_id);
+            if (kid && kid->typeId == persist::asset_type::DEVICE) {
+                members.insert (kid_id);
+                device (*kid);
+            }
+        }
+    }
+
+    for (const auto &it : m_links) {
+        const Link &link = it.second;
+        if (members.count (link.src) == 0 || members.count (link.dest) == 0)
+            continue;
+        const Node *src = node (link.src);
+        const Node *dest = node (link.dest);
+        if (group && src)
+            device (*src);
+        if (group && dest)
+            device (*dest);
+        powerchain (link);
+    }
+
+    if (group) {
+        for (const auto member_id : members) {
+            const Node *member = node (member_id);
+            if (member)
+                device (*member);
+        }
+    }
+}
+
+bool
+TopologyGraph::isPowerDevice (const std::string &iname) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    const Node *n = node (iname);
+    return n && POWER_DEVICE_SUBTYPES.count (n->subtypeId) != 0;
+}
+
+void
+TopologyGraph::buildPowerAdjacency () const
+{
+    m_powerIds.clear ();
+    m_powerIndex.clear ();
+    m_powerOffsets.clear ();
+    m_powerTargets.clear ();
+
+    auto index = [this] (a_elmnt_id_t id) -> uint32_t {
+        auto it = m_powerIndex.emplace (id, uint32_t (m_powerIds.size ()));
+        if (it.second)
+            m_powerIds.push_back (id);
+        return it.first->second;
+    };
+
+    // v_bios_asset_link_topology joins both ends to existing elements
+    std::vector <std::pair <uint32_t, uint32_t>> edges;
+    for (const auto &it : m_links) {
+        const Link &link = it.second;
+        if (link.typeId != INPUT_POWER_CHAIN || !node (link.src) || !node (link.dest))
+            continue;
+        edges.emplace_back (index (link.src), index (link.dest));
+    }
+
+    m_powerOffsets.assign (m_powerIds.size () + 1, 0);
+    for (const auto &edge : edges)
+        m_powerOffsets [edge.first + 1]++;
+    for (size_t i = 1; i != m_powerOffsets.size (); i++)
+        m_powerOffsets [i] += m_powerOffsets [i - 1];
+
+    m_powerTargets.resize (edges.size ());
+    std::vector <uint32_t> fill (m_powerOffsets.begin (), m_powerOffsets.end () - 1);
+    for (const auto &edge : edges)
+        m_powerTargets [fill [edge.first]++] = edge.second;
+
+    m_powerValid = true;
+}
+
+std::set <std::string>
+TopologyGraph::feedBy (const std::string &iname) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+
+    // like NodeMap::feed_by, the asset itself is always part of the result
+    std::set <std::string> ret {iname};
+    const Node *start = node (iname);
+    if (!start)
+        return ret;
+
+    if (!m_powerValid)
+        buildPowerAdjacency ();
+
+    auto it = m_powerIndex.find (start->id);
+    if (it == m_powerIndex.end ())
+        return ret;
+
+    // iterative DFS, power loops are stopped by the visited bitmap
+    std::vector <bool> visited (m_powerIds.size (), false);
+    std::vector <uint32_t> todo {it->second};
+    visited [it->second] = true;
+    while (!todo.empty ()) {
+        uint32_t i = todo.back ();
+        todo.pop_back ();
+
+        for (uint32_t e = m_powerOffsets [i]; e != m_powerOffsets [i + 1]; e++) {
+            uint32_t kid = m_powerTargets [e];
+            if (visited [kid])
+                continue;
+            visited [kid] = true;
+            ret.insert (node (m_powerIds [kid])->iname);
+            todo.push_back (kid);
+        }
+    }
+    return ret;
+}
+
+static Topology2Cell
+s_cell (const TopologyGraph::Node &n)
+{
+    Topology2Cell cell;
+    cell.id = n.iname;
+    if (n.hasExtName)
+        cell.name = n.extName;
+    cell.type = n.typeId;
+    cell.subtype = n.subtypeId;
+    if (n.hasAssetOrder)
+        cell.asset_order = std::stoi (n.assetOrder);
+    return cell;
+}
+
+Topology2Subtree
+TopologyGraph::topology2From (const std::string &from) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    Topology2Subtree subtree;
+
+    // topology2_from joins the device type of the starting asset
+    const Node *start = node (from);
+    if (!start || !start->hasSubtypeName)
+        return subtree;
+
+    // breadth first, like the recursive query ordered by depth
+    std::set <a_elmnt_id_t> visited {start->id};
+    subtree.push_back (Topology2Node {s_cell (*start), "", 0});
+    for (size_t i = 0; i != subtree.size (); i++) {
+        const Node *parent = node (subtree [i].cell.id);
+        auto kids = m_children.find (parent->id);
+        if (kids == m_children.end ())
+            continue;
+        for (const auto kid_id : kids->second) {
+            const Node *kid = node (kid_id);
+            if (!kid || !visited.insert (kid_id).second)
+                continue;
+            subtree.push_back (Topology2Node {s_cell (*kid), parent->iname, subtree [i].depth + 1});
+        }
+    }
+    return subtree;
+}
+
+// MySQL orders by the case insensitive collation
+static bool
+s_order_by_name (const Item &i1, const Item &i2)
+{
+    return strcasecmp (i1.name.c_str (), i2.name.c_str ()) < 0;
+}
+
+void
+TopologyGraph::devicesInGroupLocked (Item &item) const
+{
+    const Node *group = node (item.id);
+    if (!group)
+        return;
+    auto members = m_groupMembers.find (group->id);
+    if (members == m_groupMembers.end ())
+        return;
+
+    std::vector <Item> items;
+    for (const auto member_id : members->second) {
+        const Node *member = node (member_id);
+        if (!member || !member->hasExtName)
+            continue;
+        items.push_back (Item {
+            member->iname,
+            member->extName,
+            persist::subtypeid_to_subtype (member->subtypeId),
+            persist::typeid_to_type (member->typeId)
+        });
+    }
+    std::stable_sort (items.begin (), items.end (), s_order_by_name);
+    for (const auto &it : items)
+        item.contains.push_back (it);
+}
+
+void
+TopologyGraph::devicesInGroup (Item &item) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    devicesInGroupLocked (item);
+}
+
+std::vector <Item>
+TopologyGraph::groups (const std::string &iname, bool recursive) const
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    std::vector <Item> ret {};
+
+    const Node *n = node (iname);
+    if (!n)
+        return ret;
+    auto member_of = m_memberOf.find (n->id);
+    if (member_of == m_memberOf.end ())
+        return ret;
+
+    for (const auto group_id : member_of->second) {
+        const Node *group = node (group_id);
+        if (!group || !group->hasExtName)
+            continue;
+
+        Item item {
+            group->iname,
+            group->extName,
+            "N_A",
+            "group"
+        };
+        if (recursive)
+            devicesInGroupLocked (item);
+        ret.push_back (item);
+    }
+    return ret;
+}
+
+int64_t
+    topology_name_to_asset_id (const std::string &iname)
+{
+    TopologyGraph &graph = TopologyGraph::instance ();
+    if (graph.ensureLoaded ())
+        return graph.nameToId (iname);
+    return DBAssets::name_to_asset_id (iname);
+}
+
+std::pair <std::string, std::string>
+    topology_id_to_name_ext_name (a_elmnt_id_t id)
+{
+    TopologyGraph &graph = TopologyGraph::instance ();
+    if (graph.ensureLoaded ())
+        return graph.idToNameExtName (id);
+    return DBAssets::id_to_name_ext_name (id);
+}
+
+} // namespace persist
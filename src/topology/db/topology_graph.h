@@ -0,0 +1,215 @@
+/*  =========================================================================
+    topology_db_topology_graph - In-memory topology model
+
+    Copyright (C) 2016 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#ifndef TOPOLOGY_DB_TOPOLOGY_GRAPH_H_INCLUDED
+#define TOPOLOGY_DB_TOPOLOGY_GRAPH_H_INCLUDED
+
+/*!
+ * \file  topology_graph.h
+ * \brief Resident topology model answering the TOPOLOGY requests
+ *
+ * Keeps the location tree, the power links and the group membership of all
+ * assets in memory. The model is loaded from the database on first use and
+ * kept up to date by refreshing single assets whenever they are created,
+ * updated or deleted. Every query mirrors the database call it replaces, so
+ * the replies built on top of it stay the same.
+ */
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include <tntdb/connection.h>
+
+namespace persist {
+
+class TopologyGraph
+{
+public:
+    //  one asset element
+    struct Node
+    {
+        a_elmnt_id_t id {0};
+        std::string iname;
+        a_elmnt_tp_id_t typeId {0};
+        a_dvc_tp_id_t subtypeId {0};
+        // name from t_bios_asset_device_type, empty if there is none
+        std::string subtypeName;
+        bool hasSubtypeName {false};
+        a_elmnt_id_t parentId {0};
+        // ext attribute 'name'
+        std::string extName;
+        bool hasExtName {false};
+        // ext attribute 'asset_order'
+        std::string assetOrder;
+        bool hasAssetOrder {false};
+        // ext attribute 'type' (group type)
+        std::string groupType;
+        bool hasGroupType {false};
+    };
+
+    //  one row of t_bios_asset_link
+    struct Link
+    {
+        a_lnk_id_t id {0};
+        a_elmnt_id_t src {0};
+        a_elmnt_id_t dest {0};
+        std::string srcOut;
+        bool hasSrcOut {false};
+        std::string destIn;
+        bool hasDestIn {false};
+        uint16_t typeId {0};
+    };
+
+    //  one level of a location_to answer
+    struct LocationStep
+    {
+        a_elmnt_id_t id;
+        a_elmnt_tp_id_t typeId;
+        std::string iname;
+        std::string typeName;
+    };
+
+    //  process wide model used by the topology requests
+    static TopologyGraph& instance ();
+
+    //  model is used only when enabled, disabled by default
+    void setEnabled (bool enabled);
+
+    //  load the model if needed, returns true if it can answer queries
+    bool ensureLoaded ();
+
+    //  reload one asset from the database, drops it when it does not exist
+    void refresh (const std::string &iname);
+
+    //  drop the model, it is loaded again on next use
+    void invalidate ();
+
+    //  DBAssets::name_to_asset_id, -1 if not found
+    int64_t nameToId (const std::string &iname) const;
+
+    //  DBAssets::id_to_name_ext_name, empty pair if not found
+    std::pair <std::string, std::string> idToNameExtName (a_elmnt_id_t id) const;
+
+    //  power topology queries, same sets as in assettopology.cc
+    //  return 0 on success, DB_ERROR_NOTFOUND or DB_ERROR_BADINPUT
+    int powerFrom (a_elmnt_id_t id, std::set <device_info_t> &devices, std::set <powerlink_info_t> &powerlinks) const;
+    int powerTo (a_elmnt_id_t id, std::set <device_info_t> &devices, std::set <powerlink_info_t> &powerlinks) const;
+    int powerGroup (a_elmnt_id_t id, std::set <device_info_t> &devices, std::set <powerlink_info_t> &powerlinks) const;
+    int powerDatacenter (a_elmnt_id_t id, std::set <device_info_t> &devices, std::set <powerlink_info_t> &powerlinks) const;
+
+    //  path from the asset up to its topmost parent
+    //  return 0 on success or DB_ERROR_NOTFOUND
+    int locationTo (a_elmnt_id_t id, std::vector <LocationStep> &path) const;
+
+    //  all assets placed anywhere under the container, ordered by id
+    //  return 0 on success or DB_ERROR_NOTFOUND
+    int descendants (a_elmnt_id_t id, std::vector <Node> &nodes) const;
+
+    //  power links with at least one end placed under the container
+    //  return 0 on success or DB_ERROR_NOTFOUND
+    int containerPowerLinks (a_elmnt_id_t id, std::set <std::pair <a_elmnt_id_t, a_elmnt_id_t>> &links) const;
+
+    //  all parents of the asset up to the topmost one and the sources
+    //  of all links ending at the asset
+    //  return 0 on success or DB_ERROR_NOTFOUND
+    int parentsAndSources (
+        a_elmnt_id_t id,
+        std::set <a_elmnt_id_t> &parents,
+        std::set <a_elmnt_id_t> &sources) const;
+
+    //  input_power_group_response
+    void inputPowerGroup (
+        a_elmnt_id_t datacenter_id,
+        std::map <std::string, std::pair <std::string, std::string>> &devices,
+        std::vector <std::tuple <std::string, std::string, std::string, std::string>> &powerchains) const;
+
+    //  topology2 queries
+    bool isPowerDevice (const std::string &iname) const;
+    std::set <std::string> feedBy (const std::string &iname) const;
+    Topology2Subtree topology2From (const std::string &from) const;
+    std::vector <Item> groups (const std::string &iname, bool recursive) const;
+    void devicesInGroup (Item &item) const;
+
+private:
+    TopologyGraph () = default;
+
+    void load (tntdb::Connection &conn);
+    void clear ();
+    void loadNode (const tntdb::Row &row);
+    void setExt (a_elmnt_id_t id, const std::string &keytag, const std::string &value);
+    void addLink (const Link &link);
+    void removeNode (a_elmnt_id_t id);
+    void removeLinksTo (a_elmnt_id_t id);
+    void removeGroupRelations (a_elmnt_id_t id);
+    void placeSubtree (a_elmnt_id_t id, a_elmnt_id_t parent_id, bool add);
+
+    const Node* node (a_elmnt_id_t id) const;
+    const Node* node (const std::string &iname) const;
+    bool isUnder (const Node &n, a_elmnt_id_t container_id) const;
+    device_info_t deviceInfo (const Node &n) const;
+    void devicesInGroupLocked (Item &item) const;
+    void buildPowerAdjacency () const;
+
+    mutable std::mutex m_mutex;
+    //  serializes refresh (), so that an older read is never applied after a newer one
+    std::mutex m_refreshMutex;
+    bool m_enabled {false};
+    bool m_loaded {false};
+
+    std::unordered_map <a_elmnt_id_t, Node> m_nodes;
+    std::unordered_map <std::string, a_elmnt_id_t> m_inames;
+    std::unordered_map <a_elmnt_id_t, std::set <a_elmnt_id_t>> m_children;
+    //  closure of the location tree, all assets placed anywhere under
+    //  the key, whatever the depth
+    std::unordered_map <a_elmnt_id_t, std::set <a_elmnt_id_t>> m_descendants;
+    // ordered by id_link, like a table scan of t_bios_asset_link
+    std::map <a_lnk_id_t, Link> m_links;
+    std::unordered_map <a_elmnt_id_t, std::set <a_lnk_id_t>> m_linksFrom;
+    std::unordered_map <a_elmnt_id_t, std::set <a_lnk_id_t>> m_linksTo;
+    std::unordered_map <a_elmnt_id_t, std::set <a_elmnt_id_t>> m_groupMembers;
+    std::unordered_map <a_elmnt_id_t, std::set <a_elmnt_id_t>> m_memberOf;
+
+    //  power links in compressed sparse row form, element ids are mapped
+    //  to dense indexes and kids of index i are
+    //  m_powerTargets [m_powerOffsets [i] .. m_powerOffsets [i+1]),
+    //  built on first feedBy after any link change
+    mutable bool m_powerValid {false};
+    mutable std::vector <a_elmnt_id_t> m_powerIds;
+    mutable std::unordered_map <a_elmnt_id_t, uint32_t> m_powerIndex;
+    mutable std::vector <uint32_t> m_powerOffsets;
+    mutable std::vector <uint32_t> m_powerTargets;
+};
+
+//  DBAssets::name_to_asset_id answered by the topology model when loaded
+int64_t
+    topology_name_to_asset_id (const std::string &iname);
+
+//  DBAssets::id_to_name_ext_name answered by the topology model when loaded
+std::pair <std::string, std::string>
+    topology_id_to_name_ext_name (a_elmnt_id_t id);
+
+} // namespace persist
+
+#endif
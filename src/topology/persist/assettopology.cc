@@ -261,6 +261,12 @@ input_power_group_response
      //                       dst-id,      dst-socket,  src-id,      src-socket
      std::vector <std::tuple <std::string, std::string, std::string, std::string>>& powerchains)
 {
+    persist::TopologyGraph &graph = persist::TopologyGraph::instance ();
+    if (graph.ensureLoaded ()) {
+        graph.inputPowerGroup (datacenter_id, devices, powerchains);
+        return 0;
+    }
+
     try {
         tntdb::Connection connection = tntdb::connect (url);
         int group_id = get_input_power_group_id (url, datacenter_id);
@@ -282,6 +288,27 @@ input_power_group_response
     return 0;
 }
 
+// marks the reply as failed
+template <typename T>
+static db_reply <T>
+s_reply_fail (db_reply <T> &ret, int errsubtype, const std::string &msg)
+{
+    ret.status     = 0;
+    ret.errtype    = DB_ERR;
+    ret.errsubtype = errsubtype;
+    ret.msg        = msg;
+    return ret;
+}
+
+// encodes the failed reply as COMMON_MSG_FAIL
+template <typename T>
+static zmsg_t*
+s_encode_fail (const db_reply <T> &ret)
+{
+    return common_msg_encode_fail (ret.errtype, ret.errsubtype,
+                                   ret.msg.c_str (), NULL);
+}
+
 // too complex to add new parametr it to the message
 // and messages are going to be deleted, so add it as normal parameter.
 zmsg_t *process_assettopology (const char *database_url,
@@ -449,152 +476,105 @@ size_t my_size(zframe_t* frame)
         return zframe_size (frame);
 }
 
-zmsg_t* select_group_elements(
-            const char*     url             , a_elmnt_id_t    element_id,
-            a_elmnt_tp_id_t element_type_id , const char*     group_name,
-            const char*     dtype_name      , a_elmnt_tp_id_t filtertype
-        )
+// fills the bins of the group with its elements
+// throws in case of database error
+static void
+s_select_group_elements (tntdb::Connection &conn, location_element_t &group,
+                         a_elmnt_tp_id_t filtertype)
 {
-    assert ( element_id );  // id of the group should be specified
-    assert ( element_type_id ); // type_id of the group
+    assert ( group.id );  // id of the group should be specified
+    assert ( group.type_id ); // type_id of the group
     assert ( ( filtertype >= persist::asset_type::GROUP ) && ( filtertype <= 7 ) );
     // it can be only 1,2,3,4,5,6.7. 7 means - take all
 
     log_info ("start");
-    log_debug ("element_id = %" PRIu32, element_id);
+    log_debug ("element_id = %" PRIu32, group.id);
     log_debug ("filter_type = %" PRIu16, filtertype);
 
-    try{
-        tntdb::Connection conn = tntdb::connect(url);
-        tntdb::Statement st = conn.prepare(
-                " SELECT"
-                "   v.id_asset_element,"
-                "   v1.name,"
-                "   v1.id_type AS id_asset_element_type,"
-                "   v3.name AS dtype_name,"
-                "   v2.name AS name_asset_element_type"
-                " FROM    t_bios_asset_group_relation v"
-                "   INNER JOIN t_bios_asset_element v1"
-                "       ON (v.id_asset_element = v1.id_asset_element )"
-                "   INNER JOIN t_bios_asset_element_type v2"
-                "       ON (v1.id_type = v2.id_asset_element_type)"
-                "   LEFT JOIN v_bios_asset_device v3"
-                "       ON v3.id_asset_element = v1.id_asset_element"
-                "       WHERE v.id_asset_group = :elementid"
-            );
-
-        // Could return more than one row
-        tntdb::Result result = st.set("elementid", element_id).
-                                  select();
-
-        log_debug("rows selected %u", result.size());
-        int i = 0;
-        int rv = 0;
-
-        _scoped_zmsg_t* dcss     = zmsg_new();
-        _scoped_zmsg_t* roomss   = zmsg_new();
-        _scoped_zmsg_t* rowss    = zmsg_new();
-        _scoped_zmsg_t* rackss   = zmsg_new();
-        _scoped_zmsg_t* devicess = zmsg_new();
-
-        for ( auto &row: result )
-        {
-            i++;
-            a_elmnt_id_t id = 0;
-            row[0].get(id);
-            assert ( id );      // required field, otherwise db is corrupted
-
-            std::string name = "";
-            row[1].get(name);
-            assert ( !name.empty() ); // otherwise db is corrupted
-
-            a_elmnt_tp_id_t id_type = 0;
-            row[2].get(id_type);
-            assert ( id_type );
+    tntdb::Statement st = conn.prepareCached(
+            " SELECT"
+            "   v.id_asset_element,"
+            "   v1.name,"
+            "   v1.id_type AS id_asset_element_type,"
+            "   v3.name AS dtype_name,"
+            "   v2.name AS name_asset_element_type"
+            " FROM    t_bios_asset_group_relation v"
+            "   INNER JOIN t_bios_asset_element v1"
+            "       ON (v.id_asset_element = v1.id_asset_element )"
+            "   INNER JOIN t_bios_asset_element_type v2"
+            "       ON (v1.id_type = v2.id_asset_element_type)"
+            "   LEFT JOIN v_bios_asset_device v3"
+            "       ON v3.id_asset_element = v1.id_asset_element"
+            "       WHERE v.id_asset_group = :elementid"
+        );
 
-            std::string dtype_name = "";
-            row[3].get(dtype_name);
+    // Could return more than one row
+    tntdb::Result result = st.set("elementid", group.id).
+                              select();
 
-            log_debug ("for");
-            log_debug ("i = %d", i);
-            log_debug ("id = %" PRIu32, id);
-            log_debug ("name = %s", name.c_str());
-            log_debug ("id_type = %" PRIu16, id_type);
-            log_debug ("dtype_name = %s", dtype_name.c_str());
-
-            // we are interested in this element if we are interested in
-            // all elements ( filtertype == 7) or if this element has
-            // exactly the type of the filter (filtertype == id_type)
-            // or we are interested in groups details
-            // ( filtertype == persist::asset_type::GROUP )
-            if ( ( filtertype == 7 ) || ( filtertype == persist::asset_type::GROUP )
-                    || ( filtertype == id_type ) )
-            {
-                // dcs, rooms, rows, racks, devices, groups are NULL
-                // because we provide only first layer of inclusion
-                _scoped_zmsg_t* el = asset_msg_encode_return_location_from
-                              (id, id_type, name.c_str(), dtype_name.c_str(),
-                               NULL, NULL, NULL, NULL, NULL, NULL);
-                assert ( el );
-
-                // we are interested in this element
-                log_debug ("created msg el for i = %d", i);
-
-                // put elements into the bins by its asset_element_type_id
-                if ( id_type == persist::asset_type::DATACENTER )
-                    rv = zmsg_addmsg (dcss, &el);
-                else if ( id_type == persist::asset_type::ROOM )
-                    rv = zmsg_addmsg (roomss, &el);
-                else if ( id_type == persist::asset_type::ROW )
-                    rv = zmsg_addmsg (rowss, &el);
-                else if ( id_type == persist::asset_type::RACK )
-                    rv = zmsg_addmsg (rackss, &el);
-                else if ( id_type == persist::asset_type::DEVICE )
-                    rv = zmsg_addmsg (devicess, &el);
-                assert ( rv != -1 );
-                assert ( el == NULL );
-                // group of groups is not allowed
-            } // end of if interested in element
-        }// end for
-
-        _scoped_zframe_t* dcs     = NULL;
-        _scoped_zframe_t* rooms   = NULL;
-        _scoped_zframe_t* rows    = NULL;
-        _scoped_zframe_t* racks   = NULL;
-        _scoped_zframe_t* devices = NULL;
-
-        // transform bins to the frames
-        rv = matryoshka2frame (&dcss, &dcs);
-        assert ( rv == 0 );
-        rv = matryoshka2frame (&roomss, &rooms);
-        assert ( rv == 0 );
-        rv = matryoshka2frame (&rowss, &rows);
-        assert ( rv == 0 );
-        rv = matryoshka2frame (&rackss, &racks);
-        assert ( rv == 0 );
-        rv = matryoshka2frame (&devicess, &devices);
-        assert ( rv == 0 );
-
-        // generate message for the group with filled elements
-        zmsg_t* el = asset_msg_encode_return_location_from
-                      (element_id, element_type_id, group_name, dtype_name,
-                       dcs, rooms, rows, racks, devices, NULL);
-        assert ( el );
-        log_info ("end");
-        return el;
-    }
-    catch (const std::exception &e) {
-        log_warning ("abort with err = '%s'", e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                        e.what(), NULL);
-    }
+    log_debug("rows selected %u", result.size());
+    int i = 0;
+    for ( auto &row: result )
+    {
+        i++;
+        location_element_t el;
+        row[0].get(el.id);
+        assert ( el.id );      // required field, otherwise db is corrupted
+
+        row[1].get(el.name);
+        assert ( !el.name.empty() ); // otherwise db is corrupted
+
+        row[2].get(el.type_id);
+        assert ( el.type_id );
+
+        row[3].get(el.dtype_name);
+
+        log_debug ("for");
+        log_debug ("i = %d", i);
+        log_debug ("id = %" PRIu32, el.id);
+        log_debug ("name = %s", el.name.c_str());
+        log_debug ("id_type = %" PRIu16, el.type_id);
+        log_debug ("dtype_name = %s", el.dtype_name.c_str());
+
+        // we are interested in this element if we are interested in
+        // all elements ( filtertype == 7) or if this element has
+        // exactly the type of the filter (filtertype == id_type)
+        // or we are interested in groups details
+        // ( filtertype == persist::asset_type::GROUP )
+        if ( ( filtertype != 7 ) && ( filtertype != persist::asset_type::GROUP )
+                && ( filtertype != el.type_id ) )
+            continue;
+
+        // sub elements stay empty because we provide only
+        // first layer of inclusion
+        // put elements into the bins by its asset_element_type_id
+        if ( el.type_id == persist::asset_type::DATACENTER )
+            group.dcs.push_back (std::move (el));
+        else if ( el.type_id == persist::asset_type::ROOM )
+            group.rooms.push_back (std::move (el));
+        else if ( el.type_id == persist::asset_type::ROW )
+            group.rows.push_back (std::move (el));
+        else if ( el.type_id == persist::asset_type::RACK )
+            group.racks.push_back (std::move (el));
+        else if ( el.type_id == persist::asset_type::DEVICE )
+            group.devices.push_back (std::move (el));
+        // group of groups is not allowed
+    }// end for
+    log_info ("end");
 }
 
-zframe_t* select_childs(
-    const char*     url             , a_elmnt_id_t element_id,
-    a_elmnt_tp_id_t element_type_id , a_elmnt_tp_id_t child_type_id,
-    bool            is_recursive    , uint32_t current_depth,
-    a_elmnt_tp_id_t     filtertype  , a_elmnt_id_t feed_by_id)
+// selects childs of specified type for the specified element
+// (element_id + element_type_id) into childs
+// To select unlockated elements need to set element_id to 0.
+// To select without the filter need to set a filtertype to 7.
+// 0 - ok, -1 - error (childs are left untouched)
+static int
+s_select_childs (
+    const char*     url             , tntdb::Connection &conn,
+    a_elmnt_id_t    element_id      , a_elmnt_tp_id_t element_type_id,
+    a_elmnt_tp_id_t child_type_id   , bool is_recursive,
+    uint32_t        current_depth   , a_elmnt_tp_id_t filtertype,
+    a_elmnt_id_t    feed_by_id      , std::vector <location_element_t> &childs)
 {
     assert ( child_type_id );   // is required
     assert ( ( filtertype >= persist::asset_type::GROUP ) && ( filtertype <= 7 ) );
@@ -608,7 +588,6 @@ zframe_t* select_childs(
     log_debug ("feed_by_id = %" PRIu32, feed_by_id);
 
     try{
-        tntdb::Connection conn = tntdb::connect(url);
         tntdb::Statement st;
         tntdb::Result result;
         if ( element_id != 0 )
@@ -617,7 +596,7 @@ zframe_t* select_childs(
             // because type of the group should be selected
             if ( child_type_id == persist::asset_type::GROUP )
             {
-                st = conn.prepare(
+                st = conn.prepareCached(
                     " SELECT"
                     "    v.id, v.name, v.id_type, v1.value as dtype_name"
                     " FROM v_bios_asset_element v"
@@ -631,7 +610,7 @@ zframe_t* select_childs(
             }
             else
             {
-                st = conn.prepare(
+                st = conn.prepareCached(
                     " SELECT"
                     "    v.id, v.name, v.id_type, v1.name as dtype_name"
                     " FROM v_bios_asset_element v"
@@ -654,7 +633,7 @@ zframe_t* select_childs(
             // because type of the group should be selected
             if ( child_type_id == persist::asset_type::GROUP )
             {
-                st = conn.prepare(
+                st = conn.prepareCached(
                     " SELECT"
                     "    v.id, v.name, v.id_type, v1.value as dtype_name"
                     " FROM v_bios_asset_element v"
@@ -667,7 +646,7 @@ zframe_t* select_childs(
             }
             else
             {
-                st = conn.prepare(
+                st = conn.prepareCached(
                     " SELECT"
                     "    v.id, v.name, v.id_type, v1.name as dtype_name"
                     " FROM v_bios_asset_element v"
@@ -682,44 +661,34 @@ zframe_t* select_childs(
                         select();
         }
         log_debug("rows selected %u", result.size());
-        int rv = 0;
-        _scoped_zmsg_t* ret = zmsg_new();
+        std::vector <location_element_t> selected;
         int i = 0;
         for ( auto &row: result )
         {
             i++;
-            uint32_t id = 0;
-            row[0].get(id);
-            assert ( id );
+            location_element_t el;
+            row[0].get(el.id);
+            assert ( el.id );
 
-            std::string name = "";
-            row[1].get(name);
-            assert ( !name.empty() );
+            row[1].get(el.name);
+            assert ( !el.name.empty() );
 
-            uint16_t id_type = 0;
-            row[2].get(id_type);
-            assert ( id_type );
+            row[2].get(el.type_id);
+            assert ( el.type_id );
 
-            std::string dtype_name = "";
-            row[3].get(dtype_name);
+            row[3].get(el.dtype_name);
 
             log_debug ("for");
             log_debug ("i = %d", i);
-            log_debug ("id = %" PRIu32, id);
-            log_debug ("name = %s", name.c_str());
-            log_debug ("id_type = %" PRIu16, id_type);
-            log_debug ("dtype_name = %s", dtype_name.c_str());
-
-            _scoped_zframe_t* dcs     = NULL;
-            _scoped_zframe_t* rooms   = NULL;
-            _scoped_zframe_t* rows    = NULL;
-            _scoped_zframe_t* racks   = NULL;
-            _scoped_zframe_t* devices = NULL;
-            _scoped_zmsg_t*   grp     = NULL;
+            log_debug ("id = %" PRIu32, el.id);
+            log_debug ("name = %s", el.name.c_str());
+            log_debug ("id_type = %" PRIu16, el.type_id);
+            log_debug ("dtype_name = %s", el.dtype_name.c_str());
 
             // Select childs only
             // 2. it is recursive search, and we didn't achive max
             // 3. recursion depth
+            // A failure on the deeper level leaves the bin empty.
             //////////////////////////
             if (    ( is_recursive ) &&
                     ( current_depth <= MAX_RECURSION_DEPTH ) )
@@ -734,9 +703,10 @@ zframe_t* select_childs(
                         ( 3 <= filtertype ) )
                 {
                     log_info ("start select_rooms");
-                    rooms = select_childs (url, id, child_type_id,
+                    s_select_childs (url, conn, el.id, child_type_id,
                                 persist::asset_type::ROOM, is_recursive,
-                                current_depth + 1, filtertype, feed_by_id);
+                                current_depth + 1, filtertype, feed_by_id,
+                                el.rooms);
                     log_info ("end select_rooms");
                 }
 
@@ -747,9 +717,10 @@ zframe_t* select_childs(
                      ( 4 <= filtertype ) )
                 {
                     log_info ("start select_rows");
-                    rows  = select_childs (url, id, child_type_id,
+                    s_select_childs (url, conn, el.id, child_type_id,
                                 persist::asset_type::ROW, is_recursive,
-                                current_depth + 1, filtertype, feed_by_id);
+                                current_depth + 1, filtertype, feed_by_id,
+                                el.rows);
                     log_info ("end select_rows");
                 }
 
@@ -761,9 +732,10 @@ zframe_t* select_childs(
                      ( 5 <= filtertype ) )
                 {
                     log_info ("start select_racks");
-                    racks   = select_childs (url, id, child_type_id,
+                    s_select_childs (url, conn, el.id, child_type_id,
                                 persist::asset_type::RACK, is_recursive,
-                                current_depth + 1, filtertype, feed_by_id);
+                                current_depth + 1, filtertype, feed_by_id,
+                                el.racks);
                     log_info ("end select_racks");
                 }
 
@@ -776,9 +748,10 @@ zframe_t* select_childs(
                      ( 6 <= filtertype ) )
                 {
                     log_info ("start select_devices");
-                    devices = select_childs (url, id, child_type_id,
+                    s_select_childs (url, conn, el.id, child_type_id,
                                 persist::asset_type::DEVICE, is_recursive,
-                                current_depth + 1, filtertype, feed_by_id);
+                                current_depth + 1, filtertype, feed_by_id,
+                                el.devices);
                     log_info ("end select_devices");
                 }
 
@@ -789,24 +762,12 @@ zframe_t* select_childs(
                      ( 6 <= filtertype ) )
                 {
                     log_info ("start select_devices FOR devices BIOS-1333");
-                    devices = select_childs (url, id, child_type_id,
+                    s_select_childs (url, conn, el.id, child_type_id,
                                 persist::asset_type::DEVICE, is_recursive,
-                                MAX_RECURSION_DEPTH, filtertype, feed_by_id);
+                                MAX_RECURSION_DEPTH, filtertype, feed_by_id,
+                                el.devices);
                     log_info ("end select_devices FOR devices BIOS-1333");
                 }
-
-                // TODO filter
-                // if it is a group, then do a special processing
-                if (    ( child_type_id == persist::asset_type::GROUP) &&
-                        (   ( persist::asset_type::GROUP == filtertype ) ||
-                            ( filtertype == 7 )
-                        ) )
-                {
-                    log_info ("start select elements of the grp");
-                    grp = select_group_elements (url, id, persist::asset_type::GROUP,
-                                name.c_str(), dtype_name.c_str(), filtertype);
-                    log_info ("end select elements of the grp");
-                }
             }
             // all sub elements selected
 
@@ -816,12 +777,10 @@ zframe_t* select_childs(
                  ( feed_by_id != 0 )
                )
             {
-                // error handling is almost ignored, as it would
-                // be legacy stuff soon and asset_msg is legacy
                 want_it = false;
                 a_lnk_tp_id_t  linktype   = INPUT_POWER_CHAIN;
                 std::pair < std::set < device_info_t >, std::set < powerlink_info_t > >  power_topology =
-                    select_power_topology_to (url, id, linktype, true);
+                    select_power_topology_to (url, el.id, linktype, true);
                 for ( const auto &one_device : power_topology.first )
                 {
                     if ( device_info_id (one_device) == feed_by_id )
@@ -836,86 +795,73 @@ zframe_t* select_childs(
             // if   selecting ALL or
             //      for this element where selected sub elements or
             //      the type of the element is a filter type
-            if ( want_it &&
-                 (
-                    !( ( filtertype < 7 ) &&
-                        ( ( my_size(dcs) == 0 ) && ( my_size(rooms) == 0 )
-                            && ( my_size(rows) == 0 ) && ( my_size(racks) == 0 )
-                            && ( my_size(devices) == 0 )
-                        ) &&
-                        ( child_type_id != filtertype )
-                    )
-                 )
-                )
+            if ( !want_it ||
+                 (  ( filtertype < 7 ) &&
+                    ( el.dcs.empty () && el.rooms.empty () &&
+                      el.rows.empty () && el.racks.empty () &&
+                      el.devices.empty () ) &&
+                    ( child_type_id != filtertype ) ) )
+                continue;
+
+            // if it is a group, then do a special processing
+            if (    ( child_type_id == persist::asset_type::GROUP ) &&
+                    ( is_recursive ) &&
+                    ( current_depth <= MAX_RECURSION_DEPTH ) &&
+                    (   ( persist::asset_type::GROUP == filtertype ) ||
+                        ( filtertype == 7 )
+                    ) )
             {
-                _scoped_zmsg_t* el;
-                if (    ( child_type_id == persist::asset_type::GROUP ) &&
-                        ( is_recursive ) )
-                    el = zmsg_dup (grp);   // because of the special group processing
-                else
-                    el = asset_msg_encode_return_location_from
-                                (id, id_type, name.c_str(),
-                                 dtype_name.c_str(), dcs, rooms,
-                                 rows, racks, devices, NULL);
-                assert ( el );
-                log_debug ("created msg el for i = %d",i);
-                rv = zmsg_addmsg ( ret, &el);
-                assert ( rv != -1 );
-                assert ( el == NULL );
-                zframe_destroy (&dcs);
-                zframe_destroy (&rooms);
-                zframe_destroy (&rows);
-                zframe_destroy (&racks);
-                zframe_destroy (&devices);
+                log_info ("start select elements of the grp");
+                s_select_group_elements (conn, el, filtertype);
+                log_info ("end select elements of the grp");
             }
+            log_debug ("selected el for i = %d", i);
+            selected.push_back (std::move (el));
         }// end for
-        zframe_t* res = NULL;
-        rv = matryoshka2frame (&ret, &res);
-        assert ( rv == 0 );
+        childs.swap (selected);
         log_info ("end");
-        return res;
+        return 0;
     }
     catch (const std::exception &e) {
         log_warning ("abort with err = '%s'", e.what());
-        return NULL;
+        return -1;
     }
 }
 
-zmsg_t* get_return_topology_from(const char* url, asset_msg_t* getmsg, a_elmnt_id_t feed_by_id)
+db_reply <location_element_t>
+    select_location_from (const char* url, a_elmnt_id_t element_id,
+                          a_elmnt_tp_id_t filter_type, bool is_recursive,
+                          a_elmnt_id_t feed_by_id)
 {
-    assert ( getmsg );
     assert ( url );
-    assert ( asset_msg_id (getmsg) == ASSET_MSG_GET_LOCATION_FROM );
     log_info ("start");
 
-    uint32_t element_id   = asset_msg_element_id  (getmsg);
-    uint8_t  filter_type  = asset_msg_filter_type (getmsg);
-    bool     is_recursive = false;
-    uint16_t type_id      = 0;
+    location_element_t element;
+    db_reply <location_element_t> ret = db_reply_new (element);
+    ret.item.id = element_id;
 
     // element_id == 0 => we are looking for unlocated elements;
     // recursive := false;
-    if (element_id != 0) {
-        is_recursive = asset_msg_recursive (getmsg);
+    if (element_id == 0) {
+        is_recursive = false;
     }
 
-    _scoped_zframe_t* dcs     = NULL;
-    _scoped_zframe_t* rooms   = NULL;
-    _scoped_zframe_t* rows    = NULL;
-    _scoped_zframe_t* racks   = NULL;
-    _scoped_zframe_t* devices = NULL;
-    _scoped_zframe_t* grps    = NULL;
-
-    std::string name = "";
-    std::string dtype_name = "";
+    tntdb::Connection conn;
+    try{
+        conn = tntdb::connectCached(url);
+    }
+    catch (const std::exception &e) {
+        log_warning ("abort with err = '%s'", e.what());
+        return s_reply_fail (ret, DB_ERROR_INTERNAL, JSONIFY(e.what()));
+    }
 
+    a_elmnt_tp_id_t type_id = 0;
     // select additional information about starting device
     if ( element_id != 0 )
     {
         // if looking for a lockated elements
         try{
-            tntdb::Connection conn = tntdb::connect(url);
-            tntdb::Statement st = conn.prepare(
+            tntdb::Statement st = conn.prepareCached(
                 " SELECT"
                 "    v.name, v.id_subtype, v.id_type"
                 " FROM v_bios_asset_element v"
@@ -925,36 +871,31 @@ zmsg_t* get_return_topology_from(const char* url, asset_msg_t* getmsg, a_elmnt_i
             tntdb::Row row = st.set("id", element_id).
                                 selectRow();
 
-            row[0].get(name);
-            assert ( !name.empty() );
+            row[0].get(ret.item.name);
+            assert ( !ret.item.name.empty() );
             a_elmnt_stp_id_t subtype_id = 0;
             row[1].get(subtype_id);
             // QWER: use c++ dictionary instead of db dictionary
-            dtype_name = persist::subtypeid_to_subtype (subtype_id);
+            ret.item.dtype_name = persist::subtypeid_to_subtype (subtype_id);
             row[2].get(type_id);
             assert ( type_id );
-
+            ret.item.type_id = type_id;
         }
         catch (const tntdb::NotFound &e) {
             // element with specified id was not found
             log_warning ("abort select element with err = '%s'", e.what());
-            std::string err = JSONIFY(e.what());
-            return common_msg_encode_fail (DB_ERR, DB_ERROR_NOTFOUND,
-                                                        err.c_str (), NULL);
+            return s_reply_fail (ret, DB_ERROR_NOTFOUND, JSONIFY(e.what()));
         }
         catch (const std::exception &e) {
             // internal error in database
             log_warning ("abort select element with err = '%s'", e.what());
-            std::string err = JSONIFY(e.what());
-            return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                        err.c_str (), NULL);
+            return s_reply_fail (ret, DB_ERROR_INTERNAL, JSONIFY(e.what()));
         }
 
         if ( type_id == persist::asset_type::GROUP )
         {
             try{
-                tntdb::Connection conn = tntdb::connect(url);
-                tntdb::Statement st = conn.prepare(
+                tntdb::Statement st = conn.prepareCached(
                     " SELECT"
                     "    v.value"
                     " FROM"
@@ -963,32 +904,25 @@ zmsg_t* get_return_topology_from(const char* url, asset_msg_t* getmsg, a_elmnt_i
                     "       v.keytag = 'type'"
                 );
                 tntdb::Row row = st.set("elementid", element_id).
-
                                     selectRow();
 
                 log_debug("element_id = %" PRIu32, element_id);
-                row[0].get(dtype_name);
-                assert ( !dtype_name.empty() ) ;
+                row[0].get(ret.item.dtype_name);
+                assert ( !ret.item.dtype_name.empty() ) ;
             }
             catch (const tntdb::NotFound &e) {
                 // atribute type for the group was not specified,
                 // but it is a mandatory
                 log_warning ("abort type for the group was not specified"
                                 " err = '%s'\n", e.what());
-                std::string err = JSONIFY(e.what());
-                return common_msg_encode_fail (DB_ERR,
-                        DB_ERROR_DBCORRUPTED, err.c_str (), NULL);
+                return s_reply_fail (ret, DB_ERROR_DBCORRUPTED, JSONIFY(e.what()));
             }
             catch (const std::exception &e) {
                 // internal error in database
                 log_warning ("abort select element with err = '%s'", e.what());
-                std::string err = JSONIFY(e.what());
-                return common_msg_encode_fail (DB_ERR,
-                        DB_ERROR_INTERNAL, err.c_str (), NULL);
+                return s_reply_fail (ret, DB_ERROR_INTERNAL, JSONIFY(e.what()));
             }
-
         }
-
     }
 
     // Select sub elements by types
@@ -1003,18 +937,14 @@ zmsg_t* get_return_topology_from(const char* url, asset_msg_t* getmsg, a_elmnt_i
     if ( ( ( type_id == persist::asset_type::DATACENTER ) ||
            ( element_id == 0 ) ) &&
          ( 3 <= filter_type ) )
-
     {
         log_info ("start select_rooms");
-        rooms = select_childs (url, element_id, type_id, persist::asset_type::ROOM,
-                        is_recursive, 1, filter_type, feed_by_id);
-        if ( rooms == NULL )
+        if ( s_select_childs (url, conn, element_id, type_id,
+                persist::asset_type::ROOM, is_recursive, 1, filter_type,
+                feed_by_id, ret.item.rooms) != 0 )
         {
-            zframe_destroy (&dcs);
             log_warning ("end abnormal");
-            std::string translated_err = TRANSLATE_ME("rooms error");
-            return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                    translated_err.c_str (), NULL);
+            return s_reply_fail (ret, DB_ERROR_INTERNAL, TRANSLATE_ME("rooms error"));
         }
         log_info ("end select_rooms");
     }
@@ -1027,16 +957,12 @@ zmsg_t* get_return_topology_from(const char* url, asset_msg_t* getmsg, a_elmnt_i
          ( 4 <= filter_type ) )
     {
         log_info ("start select_rows");
-        rows = select_childs (url, element_id, type_id, persist::asset_type::ROW,
-                        is_recursive, 1, filter_type, feed_by_id);
-        if ( rows == NULL )
+        if ( s_select_childs (url, conn, element_id, type_id,
+                persist::asset_type::ROW, is_recursive, 1, filter_type,
+                feed_by_id, ret.item.rows) != 0 )
         {
-            zframe_destroy (&dcs);
-            zframe_destroy (&rooms);
             log_warning("end abnormal");
-            std::string translated_err = TRANSLATE_ME("rows error");
-            return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                    translated_err.c_str (), NULL);
+            return s_reply_fail (ret, DB_ERROR_INTERNAL, TRANSLATE_ME("rows error"));
         }
         log_info ("end select_rows");
     }
@@ -1050,17 +976,12 @@ zmsg_t* get_return_topology_from(const char* url, asset_msg_t* getmsg, a_elmnt_i
          ( 5 <= filter_type ) )
     {
         log_info ("start select_racks");
-        racks = select_childs (url, element_id, type_id, persist::asset_type::RACK,
-                        is_recursive, 1, filter_type, feed_by_id);
-        if ( racks == NULL )
+        if ( s_select_childs (url, conn, element_id, type_id,
+                persist::asset_type::RACK, is_recursive, 1, filter_type,
+                feed_by_id, ret.item.racks) != 0 )
         {
-            zframe_destroy (&dcs);
-            zframe_destroy (&rooms);
-            zframe_destroy (&rows);
             log_warning ("end abnormal");
-            std::string translated_err = TRANSLATE_ME("racks error");
-            return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                    translated_err.c_str (), NULL);
+            return s_reply_fail (ret, DB_ERROR_INTERNAL, TRANSLATE_ME("racks error"));
         }
         log_info ("end select_racks");
     }
@@ -1075,18 +996,12 @@ zmsg_t* get_return_topology_from(const char* url, asset_msg_t* getmsg, a_elmnt_i
          ( 6 <= filter_type ) )
     {
         log_info ("start select_devices");
-        devices = select_childs (url, element_id, type_id, persist::asset_type::DEVICE,
-                        is_recursive, 1, filter_type, feed_by_id);
-        if ( devices == NULL )
+        if ( s_select_childs (url, conn, element_id, type_id,
+                persist::asset_type::DEVICE, is_recursive, 1, filter_type,
+                feed_by_id, ret.item.devices) != 0 )
         {
-            zframe_destroy (&dcs);
-            zframe_destroy (&rooms);
-            zframe_destroy (&rows);
-            zframe_destroy (&racks);
             log_warning ("end abnormal");
-            std::string translated_err = TRANSLATE_ME("devices error");
-            return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                    translated_err.c_str (), NULL);
+            return s_reply_fail (ret, DB_ERROR_INTERNAL, TRANSLATE_ME("devices error"));
         }
         log_info ("end select_devices");
     }
@@ -1097,9 +1012,10 @@ zmsg_t* get_return_topology_from(const char* url, asset_msg_t* getmsg, a_elmnt_i
             ( 6 <= filter_type ) )
     {
         log_info ("start select_devices FOR devices BIOS-1333");
-        devices = select_childs (url, element_id, type_id,
+        s_select_childs (url, conn, element_id, type_id,
                 persist::asset_type::DEVICE, is_recursive,
-                MAX_RECURSION_DEPTH, filter_type, feed_by_id);
+                MAX_RECURSION_DEPTH, filter_type, feed_by_id,
+                ret.item.devices);
         log_info ("end select_devices FOR devices BIOS-1333");
     }
     // Select groups
@@ -1113,41 +1029,86 @@ zmsg_t* get_return_topology_from(const char* url, asset_msg_t* getmsg, a_elmnt_i
           ( element_id == 0 ) )
     {
         log_info ("start select_grps");
-        grps = select_childs (url, element_id, type_id, persist::asset_type::GROUP,
-                        is_recursive, 1, filter_type, feed_by_id);
-        if ( grps == NULL )
+        if ( s_select_childs (url, conn, element_id, type_id,
+                persist::asset_type::GROUP, is_recursive, 1, filter_type,
+                feed_by_id, ret.item.grps) != 0 )
         {
-            zframe_destroy (&dcs);
-            zframe_destroy (&rooms);
-            zframe_destroy (&rows);
-            zframe_destroy (&racks);
-            zframe_destroy (&devices);
             log_warning ("end abnormal");
-            std::string translated_err = TRANSLATE_ME("groups error");
-            return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                    translated_err.c_str (), NULL);
+            return s_reply_fail (ret, DB_ERROR_INTERNAL, TRANSLATE_ME("groups error"));
         }
         log_info ("end select_grps");
     }
 
-    zmsg_t* el = NULL;
-    log_info ("creating return element");
     if ( type_id == persist::asset_type::GROUP )
     {
-        el = select_group_elements (url, element_id, type_id, name.c_str(),
-                                    dtype_name.c_str(), filter_type);
+        try{
+            s_select_group_elements (conn, ret.item, filter_type);
+        }
+        catch (const std::exception &e) {
+            log_warning ("abort with err = '%s'", e.what());
+            return s_reply_fail (ret, DB_ERROR_INTERNAL, e.what());
+        }
     }
-    else
+    log_info ("end normal");
+    return ret;
+}
+
+static zmsg_t*
+s_encode_return_location_from (const location_element_t &element);
+
+// encodes a bin of sub elements as a matryoshka frame, empty bin is NULL
+static zframe_t*
+s_encode_location_bin (const std::vector <location_element_t> &bin)
+{
+    if ( bin.empty () )
+        return NULL;
+
+    zmsg_t *matryoshka = zmsg_new ();
+    for ( const auto &element : bin )
     {
-        el = asset_msg_encode_return_location_from
-                    (element_id, type_id, name.c_str(),
-                     dtype_name.c_str(), dcs, rooms, rows,
-                     racks, devices, grps);
+        zmsg_t *el = s_encode_return_location_from (element);
+        int rv = zmsg_addmsg (matryoshka, &el);
+        assert ( rv != -1 );
+        assert ( el == NULL );
     }
-    log_info ("end normal");
+    zframe_t *frame = NULL;
+    int rv = matryoshka2frame (&matryoshka, &frame);
+    assert ( rv == 0 );
+    return frame;
+}
+
+static zmsg_t*
+s_encode_return_location_from (const location_element_t &element)
+{
+    _scoped_zframe_t *dcs     = s_encode_location_bin (element.dcs);
+    _scoped_zframe_t *rooms   = s_encode_location_bin (element.rooms);
+    _scoped_zframe_t *rows    = s_encode_location_bin (element.rows);
+    _scoped_zframe_t *racks   = s_encode_location_bin (element.racks);
+    _scoped_zframe_t *devices = s_encode_location_bin (element.devices);
+    _scoped_zframe_t *grps    = s_encode_location_bin (element.grps);
+
+    zmsg_t *el = asset_msg_encode_return_location_from
+                    (element.id, element.type_id, element.name.c_str (),
+                     element.dtype_name.c_str (), dcs, rooms, rows,
+                     racks, devices, grps);
+    assert ( el );
     return el;
 }
 
+zmsg_t* get_return_topology_from(const char* url, asset_msg_t* getmsg, a_elmnt_id_t feed_by_id)
+{
+    assert ( getmsg );
+    assert ( url );
+    assert ( asset_msg_id (getmsg) == ASSET_MSG_GET_LOCATION_FROM );
+
+    db_reply <location_element_t> ret = select_location_from (url,
+            asset_msg_element_id (getmsg), asset_msg_filter_type (getmsg),
+            asset_msg_recursive (getmsg), feed_by_id);
+    if ( ret.status == 0 )
+        return s_encode_fail (ret);
+    return s_encode_return_location_from (ret.item);
+}
+
 bool compare_start_element (asset_msg_t* rmsg, uint32_t id, uint8_t id_type,
                             const char* name, const char* dtype_name)
 {
@@ -1281,108 +1242,109 @@ void print_frame (zframe_t* frame, a_elmnt_id_t parent_id)
    zmsg_destroy (&zmsg);
 }
 
-zmsg_t* select_parents (const char* url, a_elmnt_id_t element_id,
-                        a_elmnt_tp_id_t element_type_id)
+db_reply <std::vector <location_step_t>>
+    select_location_to (const char* url, a_elmnt_id_t element_id)
 {
-    assert ( element_id );      // is required
-    assert ( element_type_id ); // is required
-
+    assert ( url );
     log_info ("start");
-    log_debug ("element_id = %" PRIu32, element_id);
-    log_debug ("element_type_id = %" PRIu16, element_type_id);
+    log_debug("element_id=%" PRIu32, element_id);
 
-    try{
-        tntdb::Connection conn = tntdb::connect(url);
-        tntdb::Statement st;
+    std::vector <location_step_t> path;
+    db_reply <std::vector <location_step_t>> ret = db_reply_new (path);
 
-        // for the groups, other select is needed
-        // because type of the group should be selected
-        if ( element_type_id != persist::asset_type::GROUP )
-        {
-            st = conn.prepare(
-                  " SELECT"
-                  "     v.id_parent, v.id_parent_type,v.name,"
-                  "     v1.name as dtype_name"
-                  " FROM"
-                  "     v_bios_asset_element v"
-                  "     LEFT JOIN v_bios_asset_device v1"
-                  "      ON (v.id = v1.id_asset_element)"
-                  " WHERE v.id = :elementid AND"
-                  "       v.id_type = :elementtypeid"
-            );
-        }
-        else
-        {
-            st = conn.prepare(
-                  " SELECT"
-                  "     v.id_parent, v.id_parent_type,v.name,"
-                  "     v1.value as dtype_name"
-                  " FROM"
-                  "     v_bios_asset_element v"
-                  "     INNER JOIN t_bios_asset_ext_attributes v1"
-                  "      ON (v.id = v1.id_asset_element AND"
-                  "          v1.keytag = 'type')"
-                  " WHERE v.id = :elementid AND "
-                  "       v.id_type = :elementtypeid"
-            );
-        }
-
-        // Could return one row or nothing
-        tntdb::Row row = st.set("elementid", element_id).
-                            set("elementtypeid", element_type_id).
-                            selectRow();
+    persist::TopologyGraph &graph = persist::TopologyGraph::instance ();
+    if ( graph.ensureLoaded () )
+    {
+        std::vector <persist::TopologyGraph::LocationStep> steps;
+        int r = graph.locationTo (element_id, steps);
+        if ( r != 0 )
+            return s_reply_fail (ret, r, TRANSLATE_ME("element not found"));
+        for ( const auto &step : steps )
+            ret.item.push_back (location_step_t {step.id, step.typeId,
+                                                 step.iname, step.typeName});
+        log_info ("end");
+        return ret;
+    }
 
-        uint32_t parent_id = 0;
-        uint16_t parent_type_id = 0;
+    try{
+        tntdb::Connection conn = tntdb::connectCached(url);
 
-        std::string dtype_name = "";
-        std::string name = "";
-        row[0].get(parent_id);
-        row[1].get(parent_type_id);
-        row[2].get(name);
-        row[3].get(dtype_name);
+        // select additional information about starting device
+        tntdb::Statement st = conn.prepareCached(
+            " SELECT"
+            "    v.id_type"
+            " FROM v_bios_asset_element v"
+            " WHERE v.id = :id"
+        );
+        a_elmnt_tp_id_t type_id = 0;
+        tntdb::Row row = st.set("id", element_id).
+                            selectRow();
+        row[0].get(type_id);
+        assert ( type_id );
+        log_debug("type_id=%" PRIu16, type_id);
 
-        log_debug("rows selected %u, parent_id = %" PRIu32 ", "
-                "parent_type_id = %" PRIu16, 1,  parent_id, parent_type_id);
+        // for the groups, other select is needed
+        // because type of the group should be selected
+        tntdb::Statement st_element = conn.prepareCached(
+              " SELECT"
+              "     v.id_parent, v.id_parent_type,v.name,"
+              "     v1.name as dtype_name"
+              " FROM"
+              "     v_bios_asset_element v"
+              "     LEFT JOIN v_bios_asset_device v1"
+              "      ON (v.id = v1.id_asset_element)"
+              " WHERE v.id = :elementid AND"
+              "       v.id_type = :elementtypeid"
+        );
+        tntdb::Statement st_group = conn.prepareCached(
+              " SELECT"
+              "     v.id_parent, v.id_parent_type,v.name,"
+              "     v1.value as dtype_name"
+              " FROM"
+              "     v_bios_asset_element v"
+              "     INNER JOIN t_bios_asset_ext_attributes v1"
+              "      ON (v.id = v1.id_asset_element AND"
+              "          v1.keytag = 'type')"
+              " WHERE v.id = :elementid AND "
+              "       v.id_type = :elementtypeid"
+        );
 
-        if ( parent_id != 0 )
-        {
-            std::string translated_err = TRANSLATE_ME("UNSUPPORTED RETURN MESSAGE TYPE");
-            _scoped_zmsg_t* parent = select_parents (url, parent_id, parent_type_id);
-            if ( is_asset_msg (parent) ) {
-                return asset_msg_encode_return_location_to (element_id,
-                            element_type_id, name.c_str(),
-                            dtype_name.c_str(), parent);
-            }
-            else if ( is_common_msg (parent) )
-                return zmsg_dup (parent);
-            else
-                return common_msg_encode_fail (DB_ERR,
-                        DB_ERROR_INTERNAL, translated_err.c_str (),
-                        NULL);
-        }
-        else
+        // go up until the top unlocated element
+        a_elmnt_id_t id = element_id;
+        while ( id != 0 )
         {
-            log_info ("but this element has no parent");
-            return asset_msg_encode_return_location_to (element_id,
-                    element_type_id, name.c_str(), dtype_name.c_str(),
-                    zmsg_new());
+            tntdb::Statement &st_parent =
+                ( type_id != persist::asset_type::GROUP ) ? st_element : st_group;
+            // Could return one row or nothing
+            tntdb::Row parent_row = st_parent.set("elementid", id).
+                                              set("elementtypeid", type_id).
+                                              selectRow();
+
+            location_step_t step;
+            step.id = id;
+            step.type_id = type_id;
+            parent_row[0].get(id);
+            parent_row[1].get(type_id);
+            parent_row[2].get(step.name);
+            parent_row[3].get(step.dtype_name);
+
+            log_debug("parent_id = %" PRIu32 ", parent_type_id = %" PRIu16,
+                      id, type_id);
+            ret.item.push_back (step);
         }
     }
     catch (const tntdb::NotFound &e) {
         // element with specified type was not found
         log_warning ("abort with err = '%s'", e.what());
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_NOTFOUND,
-                                                        err.c_str (), NULL);
+        return s_reply_fail (ret, DB_ERROR_NOTFOUND, JSONIFY(e.what()));
     }
     catch (const std::exception &e) {
         // internal error in database
         log_warning ("abort with err = '%s'", e.what());
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                        err.c_str (), NULL);
+        return s_reply_fail (ret, DB_ERROR_INTERNAL, JSONIFY(e.what()));
     }
+    log_info ("end");
+    return ret;
 }
 
 zmsg_t* get_return_topology_to(const char* url, asset_msg_t* getmsg)
@@ -1390,46 +1352,21 @@ zmsg_t* get_return_topology_to(const char* url, asset_msg_t* getmsg)
     assert ( getmsg );
     assert ( url );
     assert ( asset_msg_id (getmsg) == ASSET_MSG_GET_LOCATION_TO );
-    log_info ("start");
-    a_elmnt_id_t element_id = asset_msg_element_id (getmsg);
-    log_debug("element_id=%" PRIu32, element_id);
-    a_elmnt_tp_id_t type_id = 0;
 
-    // select additional information about starting device
-    try{
-        tntdb::Connection conn = tntdb::connect(url);
-        tntdb::Statement st = conn.prepare(
-            " SELECT"
-            "    v.id_type"
-            " FROM v_bios_asset_element v"
-            " WHERE v.id = :id"
-        );
+    db_reply <std::vector <location_step_t>> ret =
+        select_location_to (url, asset_msg_element_id (getmsg));
+    if ( ret.status == 0 )
+        return s_encode_fail (ret);
 
-        tntdb::Row row = st.set("id", element_id).
-                            selectRow();
-
-        row[0].get(type_id);
-        assert ( type_id );
-    }
-    catch (const tntdb::NotFound &e) {
-        // element with specified id was not found
-        log_warning ("abort select element with err = '%s'", e.what());
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_NOTFOUND,
-                                                    err.c_str (), NULL);
-    }
-    catch (const std::exception &e) {
-        // internal error in database
-        log_warning ("abort select element with err = '%s'", e.what());
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                    err.c_str (), NULL);
+    // the top location is the innermost message
+    zmsg_t *result = zmsg_new ();
+    for ( auto it = ret.item.rbegin (); it != ret.item.rend (); ++it )
+    {
+        zmsg_t *parent = result;
+        result = asset_msg_encode_return_location_to (it->id, it->type_id,
+                    it->name.c_str (), it->dtype_name.c_str (), parent);
+        zmsg_destroy (&parent);
     }
-
-    log_debug("type_id=%" PRIu16, type_id);
-    zmsg_t* result = select_parents (url, element_id, type_id);
-
-    log_info ("end");
     return result;
 }
 
@@ -1521,12 +1458,13 @@ zmsg_t* generate_return_power (std::set < device_info_t >    const &devices,
     return result;
 }
 
-zmsg_t* get_return_power_topology_from(const char* url, asset_msg_t* getmsg)
+// selects the start device and the devices it feeds directly
+static db_reply <power_topology_t>
+s_select_power_from (const char* url, a_elmnt_id_t element_id)
 {
-    assert ( getmsg );
-    assert ( asset_msg_id (getmsg) == ASSET_MSG_GET_POWER_FROM );
     log_info ("start");
-    a_elmnt_id_t     element_id = asset_msg_element_id  (getmsg);
+    power_topology_t topology;
+    db_reply <power_topology_t> ret = db_reply_new (topology);
     a_elmnt_tp_id_t  linktype   = INPUT_POWER_CHAIN;
     log_debug ("element_id = %" PRIu32, element_id);
     log_debug ("linktype_id = %" PRIu16, linktype);
@@ -1546,16 +1484,12 @@ zmsg_t* get_return_power_topology_from(const char* url, asset_msg_t* getmsg)
     catch (const tntdb::NotFound &e) {
         // device with specified id was not found
         log_warning ("abort with err = '%s'", e.what());
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_NOTFOUND,
-                                                        err.c_str (), NULL);
+        return s_reply_fail (ret, DB_ERROR_NOTFOUND, JSONIFY(e.what()));
     }
     catch (const std::exception &e) {
         // internal error in database
         log_warning ("abort with err = '%s'", e.what());
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                        err.c_str (), NULL);
+        return s_reply_fail (ret, DB_ERROR_INTERNAL, JSONIFY(e.what()));
     }
 
     // check, if selected element is device
@@ -1564,10 +1498,8 @@ zmsg_t* get_return_power_topology_from(const char* url, asset_msg_t* getmsg)
         log_warning ("abort with err = '%s %" PRIu32 " %s'",
                         "specified element id =", element_id,
                         " is not a device");
-        std::string translated_err = TRANSLATE_ME("specified element is not a device");
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_BADINPUT,
-                                        translated_err.c_str (),
-                                        NULL);
+        return s_reply_fail (ret, DB_ERROR_BADINPUT,
+                             TRANSLATE_ME("specified element is not a device"));
     }
 
     // select powerlinks from start device, but only first level connections
@@ -1581,7 +1513,7 @@ zmsg_t* get_return_power_topology_from(const char* url, asset_msg_t* getmsg)
                                         device_type_name, device_type_id));
 
     try{
-        tntdb::Connection conn = tntdb::connect(url);
+        tntdb::Connection conn = tntdb::connectCached(url);
 
         tntdb::Statement st = conn.prepare(
             " SELECT"
@@ -1651,15 +1583,13 @@ zmsg_t* get_return_power_topology_from(const char* url, asset_msg_t* getmsg)
     catch (const std::exception &e) {
         // internal error in database
         log_warning ("abort with err = '%s'", e.what());
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                        err.c_str (), NULL);
+        return s_reply_fail (ret, DB_ERROR_INTERNAL, JSONIFY(e.what()));
     }
 
-
-    zmsg_t* result = generate_return_power (resultdevices, resultpowers);
+    ret.item.devices.swap (resultdevices);
+    ret.item.powerlinks.swap (resultpowers);
     log_info ("end normal");
-    return result;
+    return ret;
 }
 
 void print_frame_devices (zframe_t* frame)
@@ -1716,51 +1646,54 @@ select_power_topology_to (const char* url, a_elmnt_id_t element_id,
     if ( device_type_id == persist::asset_subtype::N_A )
         throw bios::ElementIsNotDevice(); // then it is not a device
 
-    // devices that should be searched for powerlinks
-    // (used for the elimination of duplicated devices and powerlinks)
-    std::set< device_info_t > newdevices;
     // result set of found devices
     std::set< device_info_t > resultdevices;
 
-    auto adevice = std::make_tuple(element_id, device_name,
-                                            device_type_name, device_type_id);
     // start device should be included also into the result set
-    resultdevices.insert (adevice);
-    newdevices.insert (adevice);
+    resultdevices.insert (std::make_tuple(element_id, device_name,
+                                            device_type_name, device_type_id));
 
     // all powerlinks are included into "resultpowers"
     std::set< powerlink_info_t > resultpowers;
 
-    // indicates if we have devices that were not processed yet
-    bool ncontinue = true;
-    while ( ncontinue )
-    {
-        // 1. current element id we are looking powerlinks from
-        a_elmnt_id_t cur_element_id = std::get<0>(adevice);
+    // devices whose powerlinks are selected in the current step, the
+    // whole level is selected by one query
+    std::set< a_elmnt_id_t > frontier {element_id};
+    // devices already put into some frontier
+    std::set< a_elmnt_id_t > processed {element_id};
 
-        // 2. select and process process powerlinks
-        try{
-            tntdb::Connection conn = tntdb::connect(url);
+    try{
+        tntdb::Connection conn = tntdb::connectCached(url);
+
+        while ( !frontier.empty() )
+        {
+            std::string ids;
+            for ( const auto id: frontier )
+            {
+                if ( !ids.empty() )
+                    ids += ",";
+                ids += std::to_string (id);
+            }
 
             tntdb::Statement st = conn.prepare(
                 " SELECT"
                 "  v.id_asset_element_src, v.src_out, v.dest_in, v.src_name,"
-                "  v.src_type_name, v.src_type_id "
+                "  v.src_type_name, v.src_type_id, v.id_asset_element_dest "
                 " FROM"
                 "  v_bios_asset_link_topology v"
                 " WHERE"
                 "  v.id_asset_link_type = :idlinktype AND"
-                "  v.id_asset_element_dest = :id"
+                "  v.id_asset_element_dest IN (" + ids + ")"
             );
 
             // can return more than one value
-            tntdb::Result result = st.set("id", cur_element_id).
-                                      set("idlinktype", linktype).
+            tntdb::Result result = st.set("idlinktype", linktype).
                                       select();
 
-            log_debug ("for element_id= %" PRIu32 " was %u "
-                    "powerlinks selected", cur_element_id, result.size());
+            log_debug ("for %zu elements was %u powerlinks selected",
+                    frontier.size(), result.size());
 
+            std::set< a_elmnt_id_t > next;
             // Go through the selected links
             for ( auto &row: result )
             {
@@ -1792,8 +1725,14 @@ select_power_topology_to (const char* url, a_elmnt_id_t element_id,
                 row[5].get(device_type_src_id);
                 assert ( device_type_src_id );
 
+                // id_asset_element_dest, required
+                a_elmnt_id_t id_asset_element_dest = 0;
+                row[6].get(id_asset_element_dest);
+                assert ( id_asset_element_dest );
+
                 log_debug ("for");
-                log_debug ("asset_element_id_dest = %" PRIu32, cur_element_id);
+                log_debug ("asset_element_id_dest = %" PRIu32,
+                                                    id_asset_element_dest);
                 log_debug ("asset_element_id_src = %" PRIu32,
                                                     id_asset_element_src);
                 log_debug ("src_out = %s", src_out.c_str());
@@ -1803,107 +1742,82 @@ select_power_topology_to (const char* url, a_elmnt_id_t element_id,
                                                 device_type_name_src.c_str());
 
                 resultpowers.insert  (std::make_tuple(
-                    id_asset_element_src, src_out, cur_element_id, dest_in));
-                // add new devices to process
-                if ( is_recursive )
-                    newdevices.insert (std::make_tuple(
-                            id_asset_element_src, device_name_src,
-                            device_type_name_src, device_type_src_id));
-                else
-                    resultdevices.insert (std::make_tuple(
-                            id_asset_element_src, device_name_src,
-                            device_type_name_src, device_type_src_id));
+                    id_asset_element_src, src_out, id_asset_element_dest, dest_in));
+                resultdevices.insert (std::make_tuple(
+                        id_asset_element_src, device_name_src,
+                        device_type_name_src, device_type_src_id));
+                // add new devices to process in the next level
+                if ( is_recursive && processed.insert (id_asset_element_src).second )
+                    next.insert (id_asset_element_src);
             } // end for
+            frontier.swap (next);
         }
-        catch (const std::exception &e) {
-            // internal error in database
-            throw bios::InternalDBError(e.what());
-        }
-
-        // 3. find the next dest device
-        ncontinue = false;
-        // go through all found devices
-        // and select one that was not yet processed (is not in resultdevices)
-        for ( auto it = newdevices.begin(); it != newdevices.end(); ++it )
-        {
-            adevice = *it;
-            if ( resultdevices.count (adevice) == 1 )  // it could be 0 or 1
-                continue;
-            else
-            {
-                resultdevices.insert (adevice);
-                ncontinue = true;
-                break;
-            }
-        }
-    }   // end of processing one of the new devices
+    }
+    catch (const std::exception &e) {
+        // internal error in database
+        throw bios::InternalDBError(e.what());
+    }
     log_info ("end normal");
     return std::make_pair (resultdevices, resultpowers);
 }
 
-zmsg_t* get_return_power_topology_to (const char* url, asset_msg_t* getmsg)
+// selects all devices feeding the start device
+static db_reply <power_topology_t>
+s_select_power_to (const char* url, a_elmnt_id_t element_id)
 {
-    assert ( getmsg );
-    assert ( asset_msg_id (getmsg) == ASSET_MSG_GET_POWER_TO );
     log_info ("start");
-    a_elmnt_id_t element_id = asset_msg_element_id (getmsg);
+    power_topology_t topology;
+    db_reply <power_topology_t> ret = db_reply_new (topology);
     a_lnk_tp_id_t  linktype   = INPUT_POWER_CHAIN;
 
-    std::pair <std::set<device_info_t>, std::set <powerlink_info_t>> topology;
+    std::pair <std::set<device_info_t>, std::set <powerlink_info_t>> power_topology;
 
     // Always do a recursive search
     try{
-        topology = select_power_topology_to (url, element_id, linktype, true);
+        power_topology = select_power_topology_to (url, element_id, linktype, true);
     }
     catch (const bios::NotFound &e) {
         // device with specified id was not found
         log_warning ("abort with err = '%s'", e.what());
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_NOTFOUND,
-                                                        err.c_str (), NULL);
+        return s_reply_fail (ret, DB_ERROR_NOTFOUND, JSONIFY(e.what()));
     }
     catch (const bios::InternalDBError &e) {
         // internal error in database
         log_warning ("abort with err = '%s'", e.what());
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                        err.c_str (), NULL);
+        return s_reply_fail (ret, DB_ERROR_INTERNAL, JSONIFY(e.what()));
     }
     catch (const bios::ElementIsNotDevice &e) {
         // specified element is not a device
         log_warning ("abort with err = '%s %" PRIu32 " %s'",
                 "specified element id =", element_id, " is not a device");
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_BADINPUT,
-                                                        err.c_str (), NULL);
+        return s_reply_fail (ret, DB_ERROR_BADINPUT, JSONIFY(e.what()));
     }
     catch (const std::exception &e) {
         // unexpected error
         log_warning ("abort with err = '%s'", e.what());
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                        err.c_str (), NULL);
+        return s_reply_fail (ret, DB_ERROR_INTERNAL, JSONIFY(e.what()));
     }
 
-    zmsg_t* result = generate_return_power (topology.first, topology.second);
-
+    ret.item.devices.swap (power_topology.first);
+    ret.item.powerlinks.swap (power_topology.second);
     log_info ("end normal");
-    return result;
+    return ret;
 }
 
-zmsg_t* get_return_power_topology_group(const char* url, asset_msg_t* getmsg)
+// selects the devices of the group and the powerlinks between them
+static db_reply <power_topology_t>
+s_select_power_group (const char* url, a_elmnt_id_t element_id)
 {
-    assert ( getmsg );
-    assert ( asset_msg_id (getmsg) == ASSET_MSG_GET_POWER_GROUP );
     log_info ("start");
-    a_elmnt_id_t  element_id = asset_msg_element_id (getmsg);
+    power_topology_t topology;
+    db_reply <power_topology_t> ret = db_reply_new (topology);
     a_lnk_tp_id_t linktype   = INPUT_POWER_CHAIN;
 
     log_info ("start select powers");
     //  all powerlinks are included into "resultpowers"
     std::set< powerlink_info_t > resultpowers;
     try{
-        tntdb::Connection conn = tntdb::connect(url);
+        tntdb::Connection conn = tntdb::connectCached(url);
         // v_bios_asset_link are only devices,
         // so there is no need to add more constrains
         tntdb::Statement st = conn.prepare(
@@ -1972,9 +1886,7 @@ zmsg_t* get_return_power_topology_group(const char* url, asset_msg_t* getmsg)
     catch (const std::exception &e) {
         // internal error in database
         log_warning ("abort with err = '%s'", e.what());
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                        err.c_str (), NULL);
+        return s_reply_fail (ret, DB_ERROR_INTERNAL, JSONIFY(e.what()));
     }
     log_info ("end select powers");
 
@@ -1982,7 +1894,7 @@ zmsg_t* get_return_power_topology_group(const char* url, asset_msg_t* getmsg)
     // result set of found devices
     std::set< device_info_t > resultdevices;
     try{
-        tntdb::Connection conn = tntdb::connect(url);
+        tntdb::Connection conn = tntdb::connectCached(url);
         // select is done from pure t_bios_asset_element,
         // because v_bios_asset_element has unnecessary union
         // (for parents) here
@@ -2039,30 +1951,29 @@ zmsg_t* get_return_power_topology_group(const char* url, asset_msg_t* getmsg)
     catch (const std::exception &e) {
         // internal error in database
         log_warning ("abort with err = '%s'", e.what());
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                        err.c_str (), NULL);
+        return s_reply_fail (ret, DB_ERROR_INTERNAL, JSONIFY(e.what()));
     }
     log_info("end select devices");
-    zmsg_t* result = generate_return_power (resultdevices, resultpowers);
+    ret.item.devices.swap (resultdevices);
+    ret.item.powerlinks.swap (resultpowers);
     log_info ("end normal");
-    return result;
+    return ret;
 }
 
-zmsg_t* get_return_power_topology_datacenter(const char* url,
-                                    asset_msg_t* getmsg)
+// selects the devices of the datacenter and the powerlinks between them
+static db_reply <power_topology_t>
+s_select_power_datacenter (const char* url, a_elmnt_id_t element_id)
 {
-    assert ( getmsg );
-    assert ( asset_msg_id (getmsg) == ASSET_MSG_GET_POWER_DATACENTER );
     log_info ("start");
-    a_elmnt_id_t   element_id = asset_msg_element_id  (getmsg);
+    power_topology_t topology;
+    db_reply <power_topology_t> ret = db_reply_new (topology);
     a_lnk_tp_id_t  linktype   = INPUT_POWER_CHAIN;
 
     log_info ("start select devices");
     // result set of found devices
     std::set< device_info_t > resultdevices;
     try{
-        tntdb::Connection conn = tntdb::connect(url);
+        tntdb::Connection conn = tntdb::connectCached(url);
         tntdb::Statement st = conn.prepare(
             " SELECT"
             "   v.id_asset_element, v.name,"
@@ -2114,9 +2025,7 @@ zmsg_t* get_return_power_topology_datacenter(const char* url,
     catch (const std::exception &e) {
         // internal error in database
         log_warning ("abort with err = '%s'", e.what());
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                               err.c_str (), NULL);
+        return s_reply_fail (ret, DB_ERROR_INTERNAL, JSONIFY(e.what()));
     }
     log_info("end select devices");
 
@@ -2124,7 +2033,7 @@ zmsg_t* get_return_power_topology_datacenter(const char* url,
     //      all powerlinks are included into "resultpowers"
     std::set< powerlink_info_t > resultpowers;
     try{
-        tntdb::Connection conn = tntdb::connect(url);
+        tntdb::Connection conn = tntdb::connectCached(url);
         // v_bios_asset_link are only devices,
         // so there is no need to add more constrains
         tntdb::Statement st = conn.prepare(
@@ -2191,13 +2100,100 @@ zmsg_t* get_return_power_topology_datacenter(const char* url,
     catch (const std::exception &e) {
         // internal error in database
         log_warning ("abort with err = '%s'", e.what());
-        std::string err = JSONIFY(e.what());
-        return common_msg_encode_fail (DB_ERR, DB_ERROR_INTERNAL,
-                                                        err.c_str (), NULL);
+        return s_reply_fail (ret, DB_ERROR_INTERNAL, JSONIFY(e.what()));
     }
     log_info ("end select powers");
-    zmsg_t* result = generate_return_power (resultdevices, resultpowers);
+    ret.item.devices.swap (resultdevices);
+    ret.item.powerlinks.swap (resultpowers);
     log_info ("end normal");
-    return result;
+    return ret;
 }
 
+
+db_reply <power_topology_t>
+    select_power_topology (const char* url, a_elmnt_id_t element_id,
+                           power_topology_request_t request)
+{
+    persist::TopologyGraph &graph = persist::TopologyGraph::instance ();
+    if ( graph.ensureLoaded () )
+    {
+        power_topology_t topology;
+        db_reply <power_topology_t> ret = db_reply_new (topology);
+        int r = 0;
+        switch ( request ) {
+            case POWER_TOPOLOGY_FROM:
+                r = graph.powerFrom (element_id, ret.item.devices, ret.item.powerlinks);
+                break;
+            case POWER_TOPOLOGY_TO:
+                r = graph.powerTo (element_id, ret.item.devices, ret.item.powerlinks);
+                break;
+            case POWER_TOPOLOGY_GROUP:
+                r = graph.powerGroup (element_id, ret.item.devices, ret.item.powerlinks);
+                break;
+            case POWER_TOPOLOGY_DATACENTER:
+                r = graph.powerDatacenter (element_id, ret.item.devices, ret.item.powerlinks);
+                break;
+        }
+        if ( r == DB_ERROR_NOTFOUND )
+            return s_reply_fail (ret, DB_ERROR_NOTFOUND,
+                                 TRANSLATE_ME("element not found"));
+        if ( r == DB_ERROR_BADINPUT )
+            return s_reply_fail (ret, DB_ERROR_BADINPUT,
+                                 TRANSLATE_ME("specified element is not a device"));
+        return ret;
+    }
+
+    switch ( request ) {
+        case POWER_TOPOLOGY_FROM:
+            return s_select_power_from (url, element_id);
+        case POWER_TOPOLOGY_TO:
+            return s_select_power_to (url, element_id);
+        case POWER_TOPOLOGY_GROUP:
+            return s_select_power_group (url, element_id);
+        case POWER_TOPOLOGY_DATACENTER:
+        default:
+            return s_select_power_datacenter (url, element_id);
+    }
+}
+
+// encodes the reply as ASSET_MSG_RETURN_POWER or COMMON_MSG_FAIL
+static zmsg_t*
+s_encode_return_power (const db_reply <power_topology_t> &ret)
+{
+    if ( ret.status == 0 )
+        return s_encode_fail (ret);
+    return generate_return_power (ret.item.devices, ret.item.powerlinks);
+}
+
+zmsg_t* get_return_power_topology_from(const char* url, asset_msg_t* getmsg)
+{
+    assert ( getmsg );
+    assert ( asset_msg_id (getmsg) == ASSET_MSG_GET_POWER_FROM );
+    return s_encode_return_power (select_power_topology (url,
+                asset_msg_element_id (getmsg), POWER_TOPOLOGY_FROM));
+}
+
+zmsg_t* get_return_power_topology_to (const char* url, asset_msg_t* getmsg)
+{
+    assert ( getmsg );
+    assert ( asset_msg_id (getmsg) == ASSET_MSG_GET_POWER_TO );
+    return s_encode_return_power (select_power_topology (url,
+                asset_msg_element_id (getmsg), POWER_TOPOLOGY_TO));
+}
+
+zmsg_t* get_return_power_topology_group(const char* url, asset_msg_t* getmsg)
+{
+    assert ( getmsg );
+    assert ( asset_msg_id (getmsg) == ASSET_MSG_GET_POWER_GROUP );
+    return s_encode_return_power (select_power_topology (url,
+                asset_msg_element_id (getmsg), POWER_TOPOLOGY_GROUP));
+}
+
+zmsg_t* get_return_power_topology_datacenter(const char* url,
+                                    asset_msg_t* getmsg)
+{
+    assert ( getmsg );
+    assert ( asset_msg_id (getmsg) == ASSET_MSG_GET_POWER_DATACENTER );
+    return s_encode_return_power (select_power_topology (url,
+                asset_msg_element_id (getmsg), POWER_TOPOLOGY_DATACENTER));
+}
@@ -23,6 +23,8 @@
 #define TOPOLOGY_POWER_PERSIST_ASSETTOPOLOGY_H_INCLUDED
 
 #include <set>
+#include <string>
+#include <vector>
 #include <inttypes.h>
 
 // 0 ok, -1 error
@@ -35,6 +37,104 @@ input_power_group_response
      //                       dst-id,      dst-socket,  src-id,      src-socket
      std::vector <std::tuple <std::string, std::string, std::string, std::string>>& powerchains);
 
+// ===============================================================
+// Native topology results
+// ===============================================================
+
+/**
+ * \brief An asset element of the location topology with its selected
+ * sub elements, the in-process form of ASSET_MSG_RETURN_LOCATION_FROM.
+ */
+struct location_element_t {
+    a_elmnt_id_t    id {0};
+    a_elmnt_tp_id_t type_id {0};
+    std::string     name;
+    std::string     dtype_name;
+    std::vector <location_element_t> dcs;
+    std::vector <location_element_t> rooms;
+    std::vector <location_element_t> rows;
+    std::vector <location_element_t> racks;
+    std::vector <location_element_t> devices;
+    std::vector <location_element_t> grps;
+};
+
+/**
+ * \brief One element on the way to the top of the location topology,
+ * the in-process form of ASSET_MSG_RETURN_LOCATION_TO.
+ */
+struct location_step_t {
+    a_elmnt_id_t    id {0};
+    a_elmnt_tp_id_t type_id {0};
+    std::string     name;
+    std::string     dtype_name;
+};
+
+/**
+ * \brief Devices and powerlinks of the power topology,
+ * the in-process form of ASSET_MSG_RETURN_POWER.
+ */
+struct power_topology_t {
+    std::set <device_info_t>    devices;
+    std::set <powerlink_info_t> powerlinks;
+};
+
+enum power_topology_request_t {
+    POWER_TOPOLOGY_FROM,
+    POWER_TOPOLOGY_TO,
+    POWER_TOPOLOGY_GROUP,
+    POWER_TOPOLOGY_DATACENTER
+};
+
+/**
+ * \brief Selects the location topology from the specified element.
+ *
+ * To select unlockated elements need to set element_id to 0.
+ * For unlockated elements only a non recursive search is provided.
+ * To select without the filter need to set a filtertype to 7.
+ *
+ * \param url          - the connection to database.
+ * \param element_id   - the start element.
+ * \param filter_type  - id of the type of the searched elements.
+ * \param is_recursive - if the search is recursive.
+ * \param feed_by_id   - an id of the asset element that must apear in
+ *                       the power chain for every returned device.
+ *
+ * \return db_reply with the start element and its sub elements.
+ */
+db_reply <location_element_t>
+    select_location_from (const char* url, a_elmnt_id_t element_id,
+                          a_elmnt_tp_id_t filter_type, bool is_recursive,
+                          a_elmnt_id_t feed_by_id = 0);
+
+/**
+ * \brief Selects the parents of the element until the top unlocated
+ * element.
+ *
+ * \param url        - the connection to database.
+ * \param element_id - the element id.
+ *
+ * \return db_reply with the path, the specified element is the first one
+ *         and the top location is the last one.
+ */
+db_reply <std::vector <location_step_t>>
+    select_location_to (const char* url, a_elmnt_id_t element_id);
+
+/**
+ * \brief Selects the power topology of the requested kind.
+ *
+ * Errors are reported with the same errsubtypes as the COMMON_MSG_FAIL
+ * of the matching ASSET_MSG_GET_POWER_* message.
+ *
+ * \param url        - the connection to database.
+ * \param element_id - the device, group or datacenter.
+ * \param request    - kind of the power topology.
+ *
+ * \return db_reply with devices and powerlinks.
+ */
+db_reply <power_topology_t>
+    select_power_topology (const char* url, a_elmnt_id_t element_id,
+                           power_topology_request_t request);
+
 // ===============================================================
 // Functions for processing a special message type
 // ===============================================================
@@ -280,74 +380,6 @@ bool compare_start_element (asset_msg_t* rmsg, uint32_t id, uint8_t id_type,
 // Helper functions for direct interacting with database
 // ===============================================================
 
-/**
- * \brief Selects group elements of specified type for the specified group.
- *
- *  Paramenters "element_type_id" and "group_name" are used only in the
- *  returned zmsg_t message.
- *
- *  In case of success it generates ASEET_MSG_RETURN_LOCATION_FROM message.
- *  In case of failure returns COMMON_MSG_FAIL message.
- *
- * \param url             - connection to database.
- * \param element_id      - asset element id of the group.
- * \param element_type_id - asset_element_type_id of the group.
- * \param group_name      - name of the group.
- * \param filter_type     - id of the type of the searched elements
- *                          (from the table t_bios_asset_element_type).
- *
- * \return zmsg_t  - encoded ASEET_MSG_RETURN_LOCATION_FROM or
- *                           COMMON_MSG_FAIL message.
-*/
-zmsg_t* select_group_elements(
-            const char*     url             , a_elmnt_id_t    element_id,
-            a_elmnt_tp_id_t element_type_id , const char* group_name,
-            const char*     dtype_name      , a_elmnt_tp_id_t     filtertype
-        );
-
-/**
- * \brief Select childs of specified type for the specified element
- *  (element_id + element_type_id).
- *
- *  To select unlockated elements need to set element_id to 0.
- *  To select without the filter need to set a filtertype to 7.
- *
- * \param url             - connection to database.
- * \param element_id      - id of the asset element.
- * \param element_type_id - id of the type of the asset element.
- * \param child_type_id   - type id of the child asset elements.
- * \param is_recursive    - if the search recursive or not.
- * \param current_depth   - a recursion parameter, started from 1.
- * \param filter_type     - id of the type of the searched elements.
- *
- * \return zframe_t - list of the childs of secified type according
- *                    to the filter filter_type. (it is a Matryoshka).
- */
-zframe_t* select_childs(
-    const char*     url             , a_elmnt_id_t element_id,
-    a_elmnt_tp_id_t element_type_id , a_elmnt_tp_id_t child_type_id,
-    bool            is_recursive    , uint32_t current_depth,
-    a_elmnt_tp_id_t     filtertype  , a_elmnt_id_t feed_by_id);
-
-
-/*
- \brief Recursivly selects the parents of the element until the top
- *  unlocated element.
- *
- * Generates the ASSET_MSG_RETURN_TOPOLOGY_TO message, but in inverse
- * order (the specified element would be on the top level, but the top
- * location would be at the bottom level).
- *
- * \param url             - the connection to database.
- * \param element_id      - the element id.
- * \param element_type_id - id of the element's type.
- *
- * \return zmsg_t - an encoded COMMON_MSG_FAIL or
- *                      ASSET_MSG_RETURN_TOPOLOGY_TO message.
- */
-zmsg_t* select_parents (const char* url, a_elmnt_id_t element_id,
-                        a_elmnt_tp_id_t element_type_id);
-
 /**
  * \brief Selects a name of the specified asset element, in case of device
  * additionally selects device type name.
@@ -36,7 +36,7 @@ extern "C" {
  */
 
 FTY_ASSET_PRIVATE int
-    asset_location_r(asset_msg_t** asset_msg, std::string& json);
+    asset_location_r(const location_element_t& element, std::string& json);
 
 //  @end
 
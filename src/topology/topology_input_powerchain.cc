@@ -112,7 +112,7 @@ s_fill_array_devices (const std::map <std::string,
     for (const auto& device : _map_devices)
     {
         array_devices.id = device.second.first;
-        std::pair<std::string, std::string> device_names = DBAssets::id_to_name_ext_name (atoi (device.first.c_str()));
+        std::pair<std::string, std::string> device_names = persist::topology_id_to_name_ext_name (atoi (device.first.c_str()));
         if (device_names.first.empty () && device_names.second.empty ())
             return -1;
         array_devices.name = device_names.second;
@@ -139,15 +139,15 @@ s_fill_array_powerchains (
         array_powerchains.src_socket = std::get <3> (chain).c_str();
         array_powerchains.dst_socket = std::get <1> (chain).c_str();
 
-        array_powerchains.src_id = DBAssets::id_to_name_ext_name (atoi (std::get <2> (chain).c_str())).first;
-        array_powerchains.dst_id = DBAssets::id_to_name_ext_name (atoi (std::get <0> (chain).c_str ())).first;
+        array_powerchains.src_id = persist::topology_id_to_name_ext_name (atoi (std::get <2> (chain).c_str())).first;
+        array_powerchains.dst_id = persist::topology_id_to_name_ext_name (atoi (std::get <0> (chain).c_str ())).first;
 
-        std::pair<std::string, std::string> src_names = DBAssets::id_to_name_ext_name (atoi (std::get <2> (chain).c_str()));
+        std::pair<std::string, std::string> src_names = persist::topology_id_to_name_ext_name (atoi (std::get <2> (chain).c_str()));
         if (src_names.first.empty () && src_names.second.empty ())
             return -1;
         array_powerchains.src_id = src_names.first;
 
-        std::pair<std::string, std::string> dst_names = DBAssets::id_to_name_ext_name (atoi (std::get <0> (chain).c_str ()));
+        std::pair<std::string, std::string> dst_names = persist::topology_id_to_name_ext_name (atoi (std::get <0> (chain).c_str ()));
         if (dst_names.first.empty () && dst_names.second.empty ())
             return -2;
         array_powerchains.dst_id = dst_names.first;
@@ -176,7 +176,7 @@ int topology_input_powerchain (std::map<std::string, std::string> & param, std::
         return -1;
     }
 
-    int64_t dbid = DBAssets::name_to_asset_id (dc_id);
+    int64_t dbid = persist::topology_name_to_asset_id (dc_id);
     if (dbid == -1) {
         //http_die ("element-not-found", "dc_id ", dc_id.c_str ());
         log_error ("element-not-found (dc_id: '%s')", dc_id.c_str ());
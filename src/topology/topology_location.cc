@@ -69,7 +69,12 @@ int s_topology_location_from2 (std::map<std::string, std::string> & param, std::
 {
     json = "";
 
-    tntdb::Connection conn = tntdb::connect (DBConn::url);
+    // answer from the topology model if available, from database otherwise
+    persist::TopologyGraph &graph = persist::TopologyGraph::instance ();
+    bool use_graph = graph.ensureLoaded ();
+    tntdb::Connection conn;
+    if (!use_graph)
+        conn = tntdb::connect (DBConn::url);
 
     // ##################################################
     // BLOCK 1
@@ -138,7 +143,10 @@ int s_topology_location_from2 (std::map<std::string, std::string> & param, std::
                 log_error("parameter-conflict, with 'feed_by', variable 'from' can not be 'none'");
                 return -5;
             }
-            if (!persist::is_power_device (conn, feed_by)) {
+            bool power_device = use_graph ?
+                graph.isPowerDevice (feed_by) :
+                persist::is_power_device (conn, feed_by);
+            if (!power_device) {
                 //std::string expected = TRANSLATE_ME("must be a power device.");
                 //http_die("request-param-bad", "feed_by", feed_by.c_str (), expected.c_str ());
                 log_error("request-param-bad, 'feed_by' must be a power device");
@@ -164,7 +172,9 @@ int s_topology_location_from2 (std::map<std::string, std::string> & param, std::
     std::set <std::string> fed_by;
     if (!checked_feed_by.empty ())
     {
-        fed_by = persist::topology2_feed_by (conn, checked_feed_by);
+        fed_by = use_graph ?
+            graph.feedBy (checked_feed_by) :
+            persist::topology2_feed_by (conn, checked_feed_by);
         if (fed_by.empty ()) {
             //std::string expected = TRANSLATE_ME("must be a device.");
             //http_die("request-param-bad", "feed_by", checked_feed_by.c_str(), expected.c_str ());
@@ -174,7 +184,9 @@ int s_topology_location_from2 (std::map<std::string, std::string> & param, std::
         }
     }
 
-    auto result = persist::topology2_from (conn, checked_from);
+    persist::Topology2Subtree result = use_graph ?
+        graph.topology2From (checked_from) :
+        persist::topology2_from (conn, checked_from);
 
     if (result.empty () && checked_from != "none") {
         //std::string expected = TRANSLATE_ME("valid asset name");
@@ -184,15 +196,23 @@ int s_topology_location_from2 (std::map<std::string, std::string> & param, std::
         return -9;
     }
 
-    auto groups = persist::topology2_groups (conn, checked_from, checked_recursive);
+    auto groups = use_graph ?
+        graph.groups (checked_from, checked_recursive) :
+        persist::topology2_groups (conn, checked_from, checked_recursive);
 
     std::ostringstream out;
 
     if (checked_recursive) {
+        std::function <void (persist::Item&)> devices_in_group;
+        if (use_graph)
+            devices_in_group = [&graph] (persist::Item &it) { graph.devicesInGroup (it); };
+        else
+            devices_in_group = [&conn] (persist::Item &it) { persist::topology2_devices_in_groups (conn, it); };
+
         persist::topology2_from_json_recursive (
             out,
-            conn,
-            result, checked_from, checked_filter, fed_by, groups
+            result, checked_from, checked_filter, fed_by, groups,
+            devices_in_group
         );
     }
     else {
@@ -337,7 +357,7 @@ int s_topology_location_from (std::map<std::string, std::string> & param, std::s
             //    return -8;
             //}
 
-            int64_t checked_id = DBAssets::name_to_asset_id (from);
+            int64_t checked_id = persist::topology_name_to_asset_id (from);
             if (checked_id == -1) {
                 //std::string expected = TRANSLATE_ME("existing asset name");
                 //http_die ("request-param-bad", "id", asset_id.c_str (), expected.c_str ());
@@ -361,7 +381,7 @@ int s_topology_location_from (std::map<std::string, std::string> & param, std::s
             //    return -9;
             //}
 
-            int64_t checked_id = DBAssets::name_to_asset_id (feed_by);
+            int64_t checked_id = persist::topology_name_to_asset_id (feed_by);
             if (checked_id == -1) {
                 //std::string expected = TRANSLATE_ME("existing asset name");
                 //http_die ("request-param-bad", "id", asset_id.c_str (), expected.c_str ());
@@ -409,83 +429,32 @@ int s_topology_location_from (std::map<std::string, std::string> & param, std::s
     // ##################################################
     // BLOCK 2
     // Call persistence layer
-    _scoped_asset_msg_t *input_msg = asset_msg_new (ASSET_MSG_GET_LOCATION_FROM);
-    assert (input_msg);
-    asset_msg_set_element_id (input_msg, (uint32_t) checked_from);
-    asset_msg_set_recursive (input_msg, (byte) checked_recursive);
-    asset_msg_set_filter_type (input_msg, (byte) checked_filter);
-
-    _scoped_zmsg_t *return_msg = process_assettopology (DBConn::url.c_str(), &input_msg, checked_feed_by);
-    if (return_msg == NULL) {
-        log_error ("Function process_assettopology() returned a null pointer");
-        //http_die("internal-error", "");
-        param["error"] = TRANSLATE_ME("Internal error");
-        return -20;
+    db_reply <location_element_t> ret = select_location_from (DBConn::url.c_str(),
+            checked_from, (a_elmnt_tp_id_t) checked_filter, checked_recursive != 0,
+            checked_feed_by);
+    if (ret.status == 0) {
+        log_error ("select_location_from failed: %s", ret.msg.c_str ());
+        switch(ret.errsubtype) {
+            case(DB_ERROR_NOTFOUND):
+                //http_die("element-not-found", std::to_string(checked_from).c_str());
+                log_error("element-not-found %s", std::to_string(checked_from).c_str());
+                param["error"] = TRANSLATE_ME("Asset not found (%s)", param["from"].c_str());
+                return -22;
+            case(DB_ERROR_BADINPUT): // this should never be returned
+            default:
+                //http_die("internal-error", "");
+                log_error("internal-error");
+                param["error"] = TRANSLATE_ME("Internal error");
+        }
+        return -23;
     }
 
-    if (is_common_msg (return_msg)) {
-        _scoped_common_msg_t *common_msg = common_msg_decode (&return_msg);
-        zmsg_destroy (&return_msg);
-        if (common_msg == NULL) {
-            log_error ("common_msg_decode() failed");
-            //http_die("internal-error", "");
-            param["error"] = TRANSLATE_ME("Internal error");
-            return -21;
-        }
-
-        if (common_msg_id (common_msg) == COMMON_MSG_FAIL) {
-            log_error ("common_msg is COMMON_MSG_FAIL");
-            switch(common_msg_errorno(common_msg)) {
-                case(DB_ERROR_NOTFOUND):
-                    //http_die("element-not-found", std::to_string(checked_from).c_str());
-                    log_error("element-not-found %s", std::to_string(checked_from).c_str());
-                    param["error"] = TRANSLATE_ME("Asset not found (%s)", param["from"].c_str());
-                    return -22;
-                case(DB_ERROR_BADINPUT): // this should never be returned
-                default:
-                    //http_die("internal-error", "");
-                    log_error("internal-error");
-                    param["error"] = TRANSLATE_ME("Internal error");
-            }
-            return -23;
-        }
-        else {
-            log_error ("Unexpected common_msg received. ID = %" PRIu32 , common_msg_id (common_msg));
-            //http_die("internal-error", "");
-            param["error"] = TRANSLATE_ME("Internal error");
-            return -24;
-        }
-    }
-    else if (is_asset_msg (return_msg)) {
-        _scoped_asset_msg_t *asset_msg = asset_msg_decode (&return_msg);
-        zmsg_destroy (&return_msg);
-        if (asset_msg == NULL) {
-            log_error ("asset_msg_decode() failed");
-            //http_die("internal-error", "");
-            param["error"] = TRANSLATE_ME("Internal error");
-            return -25;
-        }
-        if (asset_msg_id (asset_msg) != ASSET_MSG_RETURN_LOCATION_FROM) {
-            log_error ("Unexpected asset_msg received. ID = %" PRIu32 , asset_msg_id (asset_msg));
-            //http_die("internal-error", "");
-            param["error"] = TRANSLATE_ME("Internal error");
-            return -26;
-        }
-        if (asset_location_r(&asset_msg, json) != 0) {
-            log_error ("unexpected error, during the reply parsing");
-            //http_die("internal-error", "");
-            param["error"] = TRANSLATE_ME("Internal error");
-            return -27;
-        }
-    }
-    else {
-        zmsg_destroy (&return_msg);
-        log_error ("Unknown protocol");
+    if (asset_location_r(ret.item, json) != 0) {
+        log_error ("unexpected error, during the json generation");
         //http_die("internal-error", "");
         param["error"] = TRANSLATE_ME("Internal error");
-        return -28;
+        return -27;
     }
-    zmsg_destroy (&return_msg);
 
     return 0; // ok
 }
@@ -565,7 +534,7 @@ int s_topology_location_to (std::map<std::string, std::string> & param, std::str
     }
     // Sanity check end
 
-    int64_t checked_to_num = DBAssets::name_to_asset_id (checked_to);
+    int64_t checked_to_num = persist::topology_name_to_asset_id (checked_to);
     if (checked_to_num == -1) {
         //std::string expected = TRANSLATE_ME("existing asset name");
         //http_die ("request-param-bad", "to", checked_to.c_str (), expected.c_str ());
@@ -584,238 +553,149 @@ int s_topology_location_to (std::map<std::string, std::string> & param, std::str
     // ##################################################
     // BLOCK 2
     // Call persistence layer
-    _scoped_asset_msg_t *input_msg = asset_msg_new (ASSET_MSG_GET_LOCATION_TO);
-    assert (input_msg);
-    asset_msg_set_element_id (input_msg, checked_to_num);
-    _scoped_zmsg_t *return_msg = process_assettopology (DBConn::url.c_str(), &input_msg);
-    asset_msg_destroy(&input_msg);
-
-    if (return_msg == NULL) {
-        log_error ("Function process_assettopology() returned a null pointer");
+    db_reply <std::vector <location_step_t>> ret = select_location_to (DBConn::url.c_str(), checked_to_num);
+    if (ret.status == 0) {
+        log_error ("select_location_to failed: %s", ret.msg.c_str ());
+        switch(ret.errsubtype) {
+            case(DB_ERROR_NOTFOUND):
+                //http_die("element-not-found", checked_to.c_str());
+                log_error("element-not-found (%s)", checked_to.c_str());
+                param["error"] = TRANSLATE_ME("Asset not found (%s)", checked_to.c_str());
+                return -10;
+            case(DB_ERROR_BADINPUT):
+            default:;
+        }
         //http_die("internal-error", "");
         log_error("internal-error");
         param["error"] = TRANSLATE_ME("Internal error");
-        return -8;
+        return -11;
     }
 
-    if (is_common_msg (return_msg)) {
-        _scoped_common_msg_t *common_msg = common_msg_decode (&return_msg);
-        zmsg_destroy (&return_msg);
-
-        if (common_msg == NULL) {
-            log_error ("common_msg_decode() failed");
-            //http_die("internal-error", "");
-            log_error("internal-error");
-            param["error"] = TRANSLATE_ME("Internal error");
-            return -9;
-        }
-
-        if (common_msg_id (common_msg) == COMMON_MSG_FAIL) {
-            log_error ("common_msg is COMMON_MSG_FAIL");
-            switch(common_msg_errorno(common_msg)) {
-                case(DB_ERROR_NOTFOUND):
-                    //http_die("element-not-found", checked_to.c_str());
-                    log_error("element-not-found (%s)", checked_to.c_str());
-                    param["error"] = TRANSLATE_ME("Asset not found (%s)", checked_to.c_str());
-                    common_msg_destroy(&common_msg);
-                    return -10;
-                case(DB_ERROR_BADINPUT):
-                default:;
+    // <checked_to_num, type, contains, name, type_name>
+    std::stack<std::tuple <int, int, std::string, std::string, std::string>> stack;
+    std::string contains; // empty
+
+    for (const auto &step : ret.item) {
+        stack.push (make_tuple(step.id, step.type_id, contains, step.name, step.dtype_name));
+
+        // I deliberately didn't want to use asset manager (unknown / ""; suffix s)
+        // TODO use special function
+        switch (step.type_id) {
+            case persist::asset_type::DATACENTER:
+                contains = "datacenters";
+                break;
+            case persist::asset_type::ROOM:
+                contains = "rooms";
+                break;
+            case persist::asset_type::ROW:
+                contains = "rows";
+                break;
+            case persist::asset_type::RACK:
+                contains = "racks";
+                break;
+            case persist::asset_type::GROUP:
+                contains = "groups";
+                break;
+            case persist::asset_type::DEVICE:
+                contains = "devices";
+                break;
+            default: {
+                log_error ("Unexpected asset type received in the response");
+                //http_die("internal-error", "");
+                param["error"] = TRANSLATE_ME("Internal error");
+                return -14;
             }
-            //http_die("internal-error", "");
-            log_error("internal-error");
-            common_msg_destroy(&common_msg);
-            param["error"] = TRANSLATE_ME("Internal error");
-            return -11;
-        }
-        else {
-            log_error ("Unexpected common_msg received. ID = %" PRIu32 , common_msg_id (common_msg));
-            //http_die("internal-error", "");
-            common_msg_destroy(&common_msg);
-            param["error"] = TRANSLATE_ME("Internal error");
-            return -12;
         }
     }
-    else if (is_asset_msg (return_msg)) {
-        _scoped_asset_msg_t *asset_msg = asset_msg_decode (&return_msg);
-        zmsg_destroy (&return_msg);
 
-        if (asset_msg == NULL) {
-            log_error ("asset_msg_decode() failed");
-            //http_die("internal-error", "");
-            param["error"] = TRANSLATE_ME("Internal error");
-            return -13;
-        }
+    // Now go from top -> down, build json payload
 
-        if (asset_msg_id (asset_msg) == ASSET_MSG_RETURN_LOCATION_TO)
-        {
-            // <checked_to_num, type, contains, name, type_name>
-            std::stack<std::tuple <int, int, std::string, std::string, std::string>> stack;
-            std::string contains; // empty
-
-            while (1) {
-                int64_t checked_to_num = asset_msg_element_id (asset_msg);
-                int type_id = asset_msg_type (asset_msg);
-                std::string name = asset_msg_name (asset_msg);
-                std::string type_name = asset_msg_type_name (asset_msg);
-
-                stack.push (make_tuple(checked_to_num, type_id, contains, name, type_name));
-
-                // I deliberately didn't want to use asset manager (unknown / ""; suffix s)
-                // TODO use special function
-                switch (type_id) {
-                    case persist::asset_type::DATACENTER:
-                        contains = "datacenters";
-                        break;
-                    case persist::asset_type::ROOM:
-                        contains = "rooms";
-                        break;
-                    case persist::asset_type::ROW:
-                        contains = "rows";
-                        break;
-                    case persist::asset_type::RACK:
-                        contains = "racks";
-                        break;
-                    case persist::asset_type::GROUP:
-                        contains = "groups";
-                        break;
-                    case persist::asset_type::DEVICE:
-                        contains = "devices";
-                        break;
-                    default: {
-                        log_error ("Unexpected asset type received in the response");
-                        //http_die("internal-error", "");
-                        asset_msg_destroy (&asset_msg);
-                        param["error"] = TRANSLATE_ME("Internal error");
-                        return -14;
-                    }
-                }
+    int counter = 0; // for 'contains'
+    int indent = 0;
+    std::string ext_name;
 
-                if (zmsg_size (asset_msg_msg (asset_msg)) == 0) {
-                    break; // while
-                }
+    json = "{\n";
 
-                // next
-                _scoped_zmsg_t *inner = asset_msg_get_msg (asset_msg);
-                asset_msg_destroy (&asset_msg);
-                asset_msg = asset_msg_decode (&inner);
-                zmsg_destroy (&inner);
-
-                if (asset_msg == NULL) {
-                    log_error ("asset_msg_decode() failed");
-                    //http_die("internal-error", "");
-                    param["error"] = TRANSLATE_ME("Internal error");
-                    return -15;
-                }
-            }
-            asset_msg_destroy (&asset_msg); // useless
-
-            // Now go from top -> down, build json payload
-
-            int counter = 0; // for 'contains'
-            int indent = 0;
-            std::string ext_name;
+    while (!stack.empty()) {
+        // <checked_to_num, type, contains, name, type_name>
+        std::tuple<int, int, std::string, std::string, std::string> row = stack.top();
+        stack.pop();
 
-            json = "{\n";
-
-            while (!stack.empty()) {
-                // <checked_to_num, type, contains, name, type_name>
-                std::tuple<int, int, std::string, std::string, std::string> row = stack.top();
-                stack.pop();
+        std::pair <std::string,std::string> asset_names = persist::topology_id_to_name_ext_name (std::get<0>(row));
+        if (asset_names.first.empty () && asset_names.second.empty ()) {
+            //std::string err =  TRANSLATE_ME("Database failure");
+            //http_die ("internal-error", err.c_str ());
+            log_error("Database failure");
+            param["error"] = TRANSLATE_ME("Database access failed");
+            return -16;
+        }
+        ext_name = asset_names.second;
 
-                std::pair <std::string,std::string> asset_names = DBAssets::id_to_name_ext_name (std::get<0>(row));
-                if (asset_names.first.empty () && asset_names.second.empty ()) {
-                    //std::string err =  TRANSLATE_ME("Database failure");
-                    //http_die ("internal-error", err.c_str ());
-                    log_error("Database failure");
-                    param["error"] = TRANSLATE_ME("Database access failed");
-                    return -16;
-                }
-                ext_name = asset_names.second;
-
-                indent++;
-                if (!std::get<2>(row).empty()) {
-                    for (int i = 0; i < indent; i++) {
-                        json.append ("\t");
-                    }
-                    json.append("\"name\" : \"")
-                        .append(UTF8::escape (ext_name))
-                        .append("\",\n");
-                    for (int i = 0; i < indent; i++) {
-                        json.append ("\t");
-                    }
-                    json.append("\"id\" : \"")
-                        .append(std::get<3>(row))
-                        .append("\",\n");
-                    if (std::get<4>(row) != "N_A") { // magic constant from initdb.sql
-                        for (int i = 0; i < indent; i++) {
-                            json.append ("\t");
-                        }
-                        json.append("\"type\" : \"")
-                            .append(std::get<4>(row))
-                            .append("\"\n");
-                    }
-                    for (int i = 0; i < indent; i++) {
-                        json.append ("\t");
-                    }
-
-                    counter++;
-                    json.append("\"contains\" : { \"")
-                        .append(std::get<2>(row))
-                        .append("\" : [{\n");
-                }
-                else {
-                    for (int i = 0; i < indent; i++) {
-                        json.append ("\t");
-                    }
-                    json.append("\"name\" : \"")
-                        .append(UTF8::escape (ext_name))
-                        .append("\",\n");
-                    for (int i = 0; i < indent; i++) {
-                        json.append ("\t");
-                    }
-                    json.append("\"id\" : \"")
-                        .append(UTF8::escape (std::get<3>(row)))
-                        .append("\"");
-                    json.append(",\n");
-                    json += "\"type\" : \"" + persist::typeid_to_type(std::get<1>(row)) + "\",";
-                    for (int i = 0; i < indent; i++) {
-                        json.append ("\t");
-                    }
-                    json.append("\"sub_type\" : \"")
-                        .append(utils::strip (std::get<4>(row)))
-                        .append("\"\n");
-                }
+        indent++;
+        if (!std::get<2>(row).empty()) {
+            for (int i = 0; i < indent; i++) {
+                json.append ("\t");
             }
-
-            // close contains objects
-            for (int i = counter; i > 0; i--) {
-                indent--;
-                for (int j = 0; j < indent; j++) {
+            json.append("\"name\" : \"")
+                .append(UTF8::escape (ext_name))
+                .append("\",\n");
+            for (int i = 0; i < indent; i++) {
+                json.append ("\t");
+            }
+            json.append("\"id\" : \"")
+                .append(std::get<3>(row))
+                .append("\",\n");
+            if (std::get<4>(row) != "N_A") { // magic constant from initdb.sql
+                for (int i = 0; i < indent; i++) {
                     json.append ("\t");
                 }
-                json.append ("}]}\n");
+                json.append("\"type\" : \"")
+                    .append(std::get<4>(row))
+                    .append("\"\n");
+            }
+            for (int i = 0; i < indent; i++) {
+                json.append ("\t");
             }
 
-            json.append ("}");
+            counter++;
+            json.append("\"contains\" : { \"")
+                .append(std::get<2>(row))
+                .append("\" : [{\n");
         }
         else {
-            log_error ("Unexpected asset_msg received. ID = %" PRIu32 , asset_msg_id (asset_msg));
-            //http_die("internal-error", "");
-            asset_msg_destroy (&asset_msg);
-            param["error"] = TRANSLATE_ME("Internal error");
-            return -17;
+            for (int i = 0; i < indent; i++) {
+                json.append ("\t");
+            }
+            json.append("\"name\" : \"")
+                .append(UTF8::escape (ext_name))
+                .append("\",\n");
+            for (int i = 0; i < indent; i++) {
+                json.append ("\t");
+            }
+            json.append("\"id\" : \"")
+                .append(UTF8::escape (std::get<3>(row)))
+                .append("\"");
+            json.append(",\n");
+            json += "\"type\" : \"" + persist::typeid_to_type(std::get<1>(row)) + "\",";
+            for (int i = 0; i < indent; i++) {
+                json.append ("\t");
+            }
+            json.append("\"sub_type\" : \"")
+                .append(utils::strip (std::get<4>(row)))
+                .append("\"\n");
         }
-        asset_msg_destroy (&asset_msg);
     }
-    else {
-        zmsg_destroy (&return_msg);
-        log_error ("Unknown protocol");
-        //http_die("internal-error", "");
-        param["error"] = TRANSLATE_ME("Internal error");
-        return -18;
+
+    // close contains objects
+    for (int i = counter; i > 0; i--) {
+        indent--;
+        for (int j = 0; j < indent; j++) {
+            json.append ("\t");
+        }
+        json.append ("}]}\n");
     }
-    zmsg_destroy (&return_msg);
+
+    json.append ("}");
 
     return 0; // ok
 }
@@ -46,7 +46,6 @@
  */
 
 #include <string>
-#include <sstream>
 #include <vector>
 #include <czmq.h>
 #include <fty_common_db_dbpath.h>
@@ -61,9 +60,66 @@ int topology_power (std::map<std::string, std::string> & param, std::string & js
 {
     json = "";
 
+    PowerTopology topology;
+    int r = topology_power_native (param, topology);
+    if (r != 0)
+        return r;
+
+    topology_power_to_json (topology, json);
+    return 0; //ok
+}
+
+void topology_power_to_json (const PowerTopology & topology, std::string & json)
+{
+    json = "{";
+
+    if (topology.has_devices) {
+        json.append ("\"devices\" : [");
+        bool first = true;
+        for (const auto &device : topology.devices) {
+            if (first) first = false;
+            else json.append (", ");
+
+            json.append("{ \"name\" : \"").append(device.name).append("\",");
+            json.append("\"id\" : \"").append(device.id).append("\",");
+            json.append("\"sub_type\" : \"").append(device.sub_type).append("\"}");
+        }
+        json.append ("] ");
+    }
+
+    if (topology.has_powerchains) {
+        if (json != "{") {
+            json.append (", ");
+        }
+        json.append ("\"powerchains\" : [");
+        bool first = true;
+        for (const auto &link : topology.powerchains) {
+            if (first) first = false;
+            else json.append (", ");
+
+            json.append ("{");
+            json.append("\"src-id\" : \"").append(link.src_id).append("\",");
+            if (!link.src_socket.empty ()) {
+                json.append("\"src-socket\" : \"").append(link.src_socket).append("\",");
+            }
+            json.append("\"dst-id\" : \"").append(link.dst_id).append("\"");
+            if (!link.dst_socket.empty ()) {
+                json.append(",\"dst-socket\" : \"").append(link.dst_socket).append("\"");
+            }
+            json.append ("}");
+        }
+        json.append ("] ");
+    }
+    json.append ("}");
+}
+
+int topology_power_native (std::map<std::string, std::string> & param, PowerTopology & topology)
+{
+    topology = PowerTopology {};
+
     // checked parameters
     int64_t checked_id;
-    int request_type = 0;
+    power_topology_request_t request_type = POWER_TOPOLOGY_FROM;
     std::string asset_id;
     std::string parameter_name;
 
@@ -86,22 +142,22 @@ int topology_power (std::map<std::string, std::string> & param, std::string & js
         }
 
         if (!from.empty()) {
-            request_type = ASSET_MSG_GET_POWER_FROM;
+            request_type = POWER_TOPOLOGY_FROM;
             asset_id = from;
             parameter_name = "from";
         }
         else if (!to.empty()) {
-            request_type = ASSET_MSG_GET_POWER_TO;
+            request_type = POWER_TOPOLOGY_TO;
             asset_id = to;
             parameter_name = "to";
         }
         else if (!filter_dc.empty()) {
-            request_type = ASSET_MSG_GET_POWER_DATACENTER;
+            request_type = POWER_TOPOLOGY_DATACENTER;
             asset_id = filter_dc;
             parameter_name = "filter_dc";
         }
         else if (!filter_group.empty()) {
-            request_type = ASSET_MSG_GET_POWER_GROUP;
+            request_type = POWER_TOPOLOGY_GROUP;
             asset_id = filter_group;
             parameter_name = "filter_group";
         }
@@ -119,7 +175,7 @@ int topology_power (std::map<std::string, std::string> & param, std::string & js
             return -3;
         }
 
-        checked_id = DBAssets::name_to_asset_id (asset_id);
+        checked_id = persist::topology_name_to_asset_id (asset_id);
 
         if (checked_id == -1) {
             //std::string expected = TRANSLATE_ME("existing asset name");
@@ -140,220 +196,83 @@ int topology_power (std::map<std::string, std::string> & param, std::string & js
 
     // ##################################################
     // BLOCK 2
-    _scoped_asset_msg_t *input_msg = asset_msg_new (request_type);
-    if ( !input_msg ) {
-        //std::string err =  TRANSLATE_ME("Cannot allocate memory");
-        //http_die ("internal-error", err.c_str ());
-        log_error("malloc-failed");
-        param["error"] = TRANSLATE_ME("Allocation failed");
-        return -10;
+    // Call persistence layer
+    db_reply <power_topology_t> ret = select_power_topology (DBConn::url.c_str(),
+                                        (a_elmnt_id_t) checked_id, request_type);
+    if (ret.status == 0) {
+        log_error ("select_power_topology failed: %s", ret.msg.c_str ());
+        switch(ret.errsubtype) {
+            case DB_ERROR_BADINPUT:
+                //std::string received = TRANSLATE_ME("id of the asset, that is not a device");
+                //std::string expected = TRANSLATE_ME("id of the asset, that is a device");
+                //http_die("request-param-bad", parameter_name.c_str(), received.c_str (), expected.c_str ());
+                log_error("request-param-bad parameter_name: %s", parameter_name.c_str());
+                param["error"] = TRANSLATE_ME("Asset is not a device (%s)", asset_id.c_str());
+                break;
+            case DB_ERROR_NOTFOUND:
+                //http_die("element-not-found", asset_id.c_str());
+                log_error("element-not-found %s", asset_id.c_str());
+                param["error"] = TRANSLATE_ME("Asset not found (%s)", asset_id.c_str());
+                break;
+            default:
+                //http_die("internal-error", "");
+                log_error("internal-error err: %d", ret.errsubtype);
+                param["error"] = TRANSLATE_ME("Internal error");
+        }
+        return -21;
     }
 
-   // Call persistence layer
-    asset_msg_set_element_id (input_msg,  (uint32_t) checked_id);
-    _scoped_zmsg_t *return_msg = process_assettopology (DBConn::url.c_str(), &input_msg);
-    asset_msg_destroy (&input_msg);
-    if (return_msg == NULL) {
-        //log_error ("Function process_assettopology() returned a null pointer");
-        //http_die("internal-error", "");
-        log_error("process_assettopology-failed return null");
-        param["error"] = TRANSLATE_ME("Internal error");
-        return -11;
+    topology.has_devices = true;
+    for (const auto &device : ret.item.devices) {
+        std::pair<std::string,std::string> asset_names = persist::topology_id_to_name_ext_name (device_info_id (device));
+        if (asset_names.first.empty () && asset_names.second.empty ()) {
+            //std::string err =  TRANSLATE_ME("Database failure");
+            //http_die ("internal-error", err.c_str ());
+            log_error ("database-failure");
+            param["error"] = TRANSLATE_ME("Database access failed");
+            return -34;
+        }
+
+        topology.devices.push_back (PowerTopologyDevice {
+            asset_names.second,
+            device_info_name (device),
+            utils::strip (device_info_type_name (device))});
     }
 
-    if (is_common_msg (return_msg)) {
-        _scoped_common_msg_t *common_msg = common_msg_decode (&return_msg);
-        zmsg_destroy (&return_msg);
-        if (common_msg == NULL) {
-            //log_error ("common_msg_decode() failed");
-            //http_die("internal-error", "");
-            log_error("common_msg_decode-failed");
-            param["error"] = TRANSLATE_ME("Internal error");
-            return -20;
+    // powerchains are listed in the reverse order of the set,
+    // as it used to be with the encoded list of the powerlinks
+    topology.has_powerchains = true;
+    for (auto it = ret.item.powerlinks.rbegin (); it != ret.item.powerlinks.rend (); ++it) {
+        PowerTopologyLink link;
+        std::pair<std::string,std::string> src_names = persist::topology_id_to_name_ext_name (std::get<0> (*it));
+        if (src_names.first.empty () && src_names.second.empty ()) {
+            //std::string err =  TRANSLATE_ME("Database failure");
+            //http_die ("internal-error", err.c_str ());
+            log_error ("database-failure");
+            param["error"] = TRANSLATE_ME("Database access failed");
+            return -35;
         }
+        link.src_id = src_names.first;
 
-        if (common_msg_id (common_msg) == COMMON_MSG_FAIL) {
-            log_error ("common_msg is COMMON_MSG_FAIL");
-            uint32_t err = common_msg_errorno(common_msg);
-            switch(err) {
-                case DB_ERROR_BADINPUT:
-                    //std::string received = TRANSLATE_ME("id of the asset, that is not a device");
-                    //std::string expected = TRANSLATE_ME("id of the asset, that is a device");
-                    //http_die("request-param-bad", parameter_name.c_str(), received.c_str (), expected.c_str ());
-                    log_error("request-param-bad parameter_name: %s", parameter_name.c_str());
-                    param["error"] = TRANSLATE_ME("Asset is not a device (%s)", asset_id.c_str());
-                    break;
-                case DB_ERROR_NOTFOUND:
-                    //http_die("element-not-found", asset_id.c_str());
-                    log_error("element-not-found %s", asset_id.c_str());
-                    param["error"] = TRANSLATE_ME("Asset not found (%s)", asset_id.c_str());
-                    break;
-                default:
-                    //http_die("internal-error", "");
-                    log_error("internal-error err: %" PRIu32, err);
-                    param["error"] = TRANSLATE_ME("Internal error");
-            }
-            common_msg_destroy(&common_msg);
-            return -21;
+        const std::string &src_socket = std::get<1> (*it);
+        if (!src_socket.empty() && src_socket != SRCOUT_DESTIN_IS_NULL) {
+            link.src_socket = src_socket;
         }
-        else {
-            log_error ("Unexpected common_msg received. ID = %" PRIu32 , common_msg_id (common_msg));
-            //http_die("internal-error", "");
-            common_msg_destroy(&common_msg);
-            param["error"] = TRANSLATE_ME("Internal error");
-            return -22;
-        }
-    }
-    else if (is_asset_msg (return_msg)) {
-        _scoped_asset_msg_t *asset_msg = asset_msg_decode (&return_msg);
-        zmsg_destroy (&return_msg);
-
-        if (asset_msg == NULL) {
-            //log_error ("asset_msg_decode() failed");
-            //http_die("internal-error", "");
-            log_error("common_msg_decode-failed");
-            param["error"] = TRANSLATE_ME("Internal error");
-            return -30;
+        std::pair<std::string,std::string> dst_names = persist::topology_id_to_name_ext_name (std::get<2> (*it));
+        if (dst_names.first.empty () && dst_names.second.empty ()) {
+            //http_die ("internal-error", err.c_str ());
+            log_error ("database-failure");
+            param["error"] = TRANSLATE_ME("Database access failed");
+            return -36;
         }
+        link.dst_id = dst_names.first;
 
-        if (asset_msg_id (asset_msg) == ASSET_MSG_RETURN_POWER) {
-            _scoped_zlist_t *powers = asset_msg_get_powers (asset_msg);
-            _scoped_zframe_t *devices = asset_msg_get_devices (asset_msg);
-            asset_msg_destroy (&asset_msg);
-
-            json = "{";
-
-            if (devices) {
-#if CZMQ_VERSION_MAJOR == 3
-                byte *buffer = zframe_data (devices);
-                assert (buffer);
-                _scoped_zmsg_t *zmsg = zmsg_decode ( buffer, zframe_size (devices));
-#else
-                _scoped_zmsg_t *zmsg = zmsg_decode (devices);
-#endif
-                if (zmsg == NULL || !zmsg_is (zmsg)) {
-                    zframe_destroy (&devices);
-                    log_error ("zmsg_decode() failed");
-                    //http_die("internal-error", "");
-                    param["error"] = TRANSLATE_ME("Internal error");
-                    return -31;
-                }
-                zframe_destroy (&devices);
-
-                json.append ("\"devices\" : [");
-                _scoped_zmsg_t *pop = NULL;
-                bool first = true;
-                while ((pop = zmsg_popmsg (zmsg)) != NULL) { // caller owns zmgs_t
-                    if (!is_asset_msg (pop)) {
-                        zmsg_destroy (&zmsg);
-                        log_error ("malformed internal structure of returned message");
-                        //http_die("internal-error", "");
-                        param["error"] = TRANSLATE_ME("Internal error");
-                        return -32;
-                    }
-                    _scoped_asset_msg_t *item = asset_msg_decode (&pop); // _scoped_zmsg_t is freed
-                    if (item == NULL) {
-                        if (pop != NULL) {
-                            zmsg_destroy (&pop);
-                        }
-                        log_error ("asset_smg_decode() failed for internal messages");
-                        //http_die("internal-error", "");
-                        param["error"] = TRANSLATE_ME("Internal error");
-                        return -33;
-                    }
-
-                    if (first) first = false;
-                    else json.append (", ");
-
-                    std::pair<std::string,std::string> asset_names = DBAssets::id_to_name_ext_name (asset_msg_element_id (item));
-                    if (asset_names.first.empty () && asset_names.second.empty ()) {
-                        //std::string err =  TRANSLATE_ME("Database failure");
-                        //http_die ("internal-error", err.c_str ());
-                        log_error ("database-failure");
-                        param["error"] = TRANSLATE_ME("Database access failed");
-                        return -34;
-                    }
-
-                    json.append("{ \"name\" : \"").append(asset_names.second).append("\",");
-                    json.append("\"id\" : \"").append(asset_msg_name (item)).append("\",");
-                    json.append("\"sub_type\" : \"").append(utils::strip (asset_msg_type_name (item))).append("\"}");
-
-                    asset_msg_destroy (&item);
-                }
-                zmsg_destroy (&zmsg);
-                json.append ("] ");
-            }
-
-            if (powers) {
-                if (json != "{") {
-                    json.append (", ");
-                }
-                json.append ("\"powerchains\" : [");
-
-                const char *item = (const char*) zlist_first (powers);
-                bool first = true;
-                while (item) {
-                    if (first) first = false;
-                    else json.append (", ");
-
-                    json.append ("{");
-                    std::vector<std::string> tokens;
-                    std::istringstream f(item);
-                    std::string tmp;
-                    // "src_socket:src_id:dst_socket:dst_id"
-                    while (getline(f, tmp, ':')) {
-                        tokens.push_back(tmp);
-                    }
-                    std::pair<std::string,std::string> src_names = DBAssets::id_to_name_ext_name (std::stoi (tokens[1]));
-                    if (src_names.first.empty () && src_names.second.empty ()) {
-                        //std::string err =  TRANSLATE_ME("Database failure");
-                        //http_die ("internal-error", err.c_str ());
-                        log_error ("database-failure");
-                        param["error"] = TRANSLATE_ME("Database access failed");
-                        return -35;
-                    }
-                    json.append("\"src-id\" : \"").append(src_names.first).append("\",");
-
-                    if (!tokens[0].empty() && tokens[0] != "999") {
-                        json.append("\"src-socket\" : \"").append(tokens[0]).append("\",");
-                    }
-                    std::pair<std::string,std::string> dst_names = DBAssets::id_to_name_ext_name (std::stoi (tokens[3]));
-                    if (dst_names.first.empty () && dst_names.second.empty ()) {
-                        std::string err =  TRANSLATE_ME("Database failure");
-                        //http_die ("internal-error", err.c_str ());
-                        log_error ("database-failure");
-                        param["error"] = TRANSLATE_ME("Database access failed");
-                        return -36;
-                    }
-                    json.append("\"dst-id\" : \"").append(dst_names.first).append("\"");
-
-                    if (!tokens[2].empty() && tokens[2] != "999") {
-                        json.append(",\"dst-socket\" : \"").append(tokens[2]).append("\"");
-                    }
-                    json.append ("}");
-                    item = (const char*) zlist_next (powers);
-                }
-                json.append ("] ");
-            }
-            json.append ("}");
+        const std::string &dst_socket = std::get<3> (*it);
+        if (!dst_socket.empty() && dst_socket != SRCOUT_DESTIN_IS_NULL) {
+            link.dst_socket = dst_socket;
         }
-        else {
-            log_error ("Unexpected asset_msg received. ID = %" PRIu32 , asset_msg_id (asset_msg));
-            //http_die("internal-error", "");
-            asset_msg_destroy (&asset_msg);
-            param["error"] = TRANSLATE_ME("Internal error");
-            return -37;
-        }
-    }
-    else {
-        log_error ("Unknown protocol");
-        //LOG_END;
-        //http_die("internal-error", "");
-        zmsg_destroy (&return_msg);
-        param["error"] = TRANSLATE_ME("Internal error");
-        return -38;
+        topology.powerchains.push_back (link);
     }
 
-    zmsg_destroy (&return_msg);
     return 0; //ok
 }
@@ -28,6 +28,32 @@ extern "C" {
 
 //  @interface
 
+//  one device of a power topology, as written to JSON
+struct PowerTopologyDevice
+{
+    std::string name;       // ext name
+    std::string id;         // iname
+    std::string sub_type;
+};
+
+//  one powerchain of a power topology, empty socket is not written
+struct PowerTopologyLink
+{
+    std::string src_id;
+    std::string src_socket;
+    std::string dst_id;
+    std::string dst_socket;
+};
+
+//  power topology reply, has_* tell whether the member is present
+struct PowerTopology
+{
+    bool has_devices {false};
+    std::vector <PowerTopologyDevice> devices;
+    bool has_powerchains {false};
+    std::vector <PowerTopologyLink> powerchains;
+};
+
 //  topology_power main entry
 //  PARAM map keys in from/to/filter_dc/filter_group
 //  attempt: from/to: assetID, filter_dc/filter_group:<to be completed>
@@ -37,6 +63,17 @@ extern "C" {
 FTY_ASSET_PRIVATE int
     topology_power (std::map<std::string, std::string> & param, std::string & json);
 
+//  same as topology_power, result is not serialized
+//  returns 0 if success (topology is valid), else <0
+
+FTY_ASSET_PRIVATE int
+    topology_power_native (std::map<std::string, std::string> & param, PowerTopology & topology);
+
+//  serialize power topology to the topology_power json payload
+
+FTY_ASSET_PRIVATE void
+    topology_power_to_json (const PowerTopology & topology, std::string & json);
+
 //  @end
 
 #ifdef __cplusplus
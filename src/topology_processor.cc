@@ -27,12 +27,152 @@
 */
 
 #include "fty_asset_classes.h"
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 // fwd decl.
 static int json_string_beautify (std::string & s);
 static int si_to_string (const cxxtools::SerializationInfo & si, std::string & s, bool beautify);
 static int string_to_si (const std::string & s, cxxtools::SerializationInfo & si);
 static int si_member_value (const cxxtools::SerializationInfo & si, const std::string & member, std::string & value);
+static int s_topology_power_process (const std::string & command, const std::string & assetName, std::string & result, std::string & errorMsg, bool beautify);
+static int s_topology_power_to (const std::string & assetName, std::string & result, std::string & errorMsg, bool beautify);
+static int s_topology_location_process (const std::string & command, const std::string & assetName, const std::string & options, std::string & result, std::string & errorMsg, bool beautify);
+static int s_topology_input_powerchain_process (const std::string & assetName, std::string & result, std::string & errorMsg, bool beautify);
+
+// --------------------------------------------------------------------------
+// Cache of the TOPOLOGY results
+// Results are keyed by the request and tagged with the topology generation
+// they were computed at. Any change of the topology bumps the generation, so
+// a result computed before the change is never served. Least recently used
+// results are dropped when the cache exceeds its size.
+
+class TopologyResultCache
+{
+public:
+    explicit TopologyResultCache (size_t maxBytes) : m_maxBytes (maxBytes) {}
+
+    // returns true and sets RESULT on hit, sets GENERATION to tag a new result
+    bool lookup (const std::string & key, std::string & result, uint64_t & generation)
+    {
+        std::unique_lock<std::mutex> lock (m_lock);
+        generation = m_generation;
+
+        auto found = m_entries.find (key);
+        if (found != m_entries.end ()) {
+            m_hits++;
+            m_lru.splice (m_lru.begin (), m_lru, found->second.lru);
+            result = found->second.result;
+            return true;
+        }
+        m_misses++;
+        return false;
+    }
+
+    void insert (const std::string & key, const std::string & result, uint64_t generation)
+    {
+        size_t bytes = key.size () + result.size ();
+
+        std::unique_lock<std::mutex> lock (m_lock);
+        // topology changed while the result was computed
+        if (generation != m_generation || bytes > m_maxBytes || m_entries.count (key) != 0)
+            return;
+
+        while (m_bytes + bytes > m_maxBytes) {
+            auto oldest = m_entries.find (m_lru.back ());
+            m_bytes -= oldest->first.size () + oldest->second.result.size ();
+            m_entries.erase (oldest);
+            m_lru.pop_back ();
+        }
+        m_lru.push_front (key);
+        m_entries.emplace (key, Entry{result, m_lru.begin ()});
+        m_bytes += bytes;
+    }
+
+    void invalidate ()
+    {
+        std::unique_lock<std::mutex> lock (m_lock);
+        m_generation++;
+        m_entries.clear ();
+        m_lru.clear ();
+        m_bytes = 0;
+    }
+
+    void stats (uint64_t & hits, uint64_t & misses, size_t & bytes) const
+    {
+        std::unique_lock<std::mutex> lock (m_lock);
+        hits = m_hits;
+        misses = m_misses;
+        bytes = m_bytes;
+    }
+
+private:
+    using LruList = std::list<std::string>;
+
+    struct Entry
+    {
+        std::string result;
+        LruList::iterator lru;
+    };
+
+    mutable std::mutex m_lock;
+    size_t m_maxBytes;
+    size_t m_bytes = 0;
+    uint64_t m_generation = 0;
+    std::unordered_map<std::string, Entry> m_entries;
+    LruList m_lru;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+};
+
+static TopologyResultCache s_cache (16 * 1024 * 1024);
+
+// serves the request KEY from the cache, COMPUTE is called on miss only
+static int s_cached (const std::string & key, std::string & result, std::string & errorMsg,
+    const std::function<int (std::string &, std::string &)> & compute)
+{
+    uint64_t generation = 0;
+    if (s_cache.lookup (key, result, generation)) {
+        log_debug ("topology cache hit: %s", key.c_str ());
+        return 0;
+    }
+
+    int r = compute (result, errorMsg);
+    if (r == 0)
+        s_cache.insert (key, result, generation);
+    return r;
+}
+
+// request key, fields are separated by a char which can't be part of them
+static std::string s_key (const char * kind, const std::string & command, const std::string & assetName,
+    const std::string & options, bool beautify)
+{
+    std::string key (kind);
+    for (const std::string * field : {&command, &assetName, &options}) {
+        key.push_back ('\x1f');
+        key.append (*field);
+    }
+    key.push_back ('\x1f');
+    key.push_back (beautify ? '1' : '0');
+    return key;
+}
+
+void topology_processor_invalidate ()
+{
+    uint64_t hits, misses;
+    size_t bytes;
+    s_cache.stats (hits, misses, bytes);
+    log_debug ("topology cache invalidated, hits: %" PRIu64 ", misses: %" PRIu64 ", bytes: %zu",
+        hits, misses, bytes);
+    s_cache.invalidate ();
+}
+
+void topology_processor_cache_stats (uint64_t & hits, uint64_t & misses, size_t & bytes)
+{
+    s_cache.stats (hits, misses, bytes);
+}
 
 // --------------------------------------------------------------------------
 // Retrieve the powerchains which powers a requested target asset
@@ -44,6 +184,14 @@ static int si_member_value (const cxxtools::SerializationInfo & si, const std::s
 // Returns 0 if success, else <0
 
 int topology_power_process (const std::string & command, const std::string & assetName, std::string & result, std::string & errorMsg, bool beautify)
+{
+    return s_cached (s_key ("power", command, assetName, "", beautify), result, errorMsg,
+        [&] (std::string & out, std::string & reason) {
+            return s_topology_power_process (command, assetName, out, reason, beautify);
+        });
+}
+
+static int s_topology_power_process (const std::string & command, const std::string & assetName, std::string & result, std::string & errorMsg, bool beautify)
 {
     result = "";
 
@@ -83,75 +231,51 @@ int topology_power_process (const std::string & command, const std::string & ass
 // Returns 0 if success, else <0
 
 int topology_power_to (const std::string & assetName, std::string & result, std::string & errorMsg, bool beautify)
+{
+    return s_cached (s_key ("power_to", "to", assetName, "", beautify), result, errorMsg,
+        [&] (std::string & out, std::string & reason) {
+            return s_topology_power_to (assetName, out, reason, beautify);
+        });
+}
+
+static int s_topology_power_to (const std::string & assetName, std::string & result, std::string & errorMsg, bool beautify)
 {
     result = "";
 
-    int r = topology_power_process("to", assetName, result, errorMsg, beautify);
-    if (r != 0) {
-        log_error("topology_power_process 'to' failed, r: %d", r);
-        return -1;
-    }
+    std::map<std::string, std::string> param;
+    param["to"] = assetName;
 
-    // deserialize result to si
-    cxxtools::SerializationInfo si;
-    r = string_to_si(result, si);
+    PowerTopology topology;
+    int r = topology_power_native (param, topology);
     if (r != 0) {
-        errorMsg = TRANSLATE_ME("JSON deserialization failed"); // reason
-        log_error("json deserialize failed (exception reached), payload:\n%s", result.c_str());
-        return -2;
+        errorMsg = param["error"]; // reason
+        log_error("topology_power_native() failed, r: %d, assetName: %s", r, assetName.c_str());
+        return -1;
     }
-
-    // check si structure
-    cxxtools::SerializationInfo *si_powerchains = si.findMember("powerchains");
-    if (si_powerchains == 0) {
+    if (!topology.has_powerchains) {
         errorMsg = TRANSLATE_ME("Internal error"); // reason
-        log_error("powerchains member not defined, payload:\n%s", result.c_str());
+        log_error("powerchains member not defined, assetName: %s", assetName.c_str());
         return -3;
     }
-    if (si_powerchains->category() != cxxtools::SerializationInfo::Category::Array) {
-        errorMsg = TRANSLATE_ME("Internal error"); // reason
-        log_error("powerchains member category != Array, payload:\n%s", result.c_str());
-        return -4;
-    }
-
-    result = ""; // useless, we work now on siResult
 
     // prepare siResult (asset-id member + powerchains array member)
     cxxtools::SerializationInfo siResult;
     siResult.addMember("asset-id") <<= assetName;
-    siResult.addMember("powerchains").setCategory(cxxtools::SerializationInfo::Array);
-    cxxtools::SerializationInfo *siResulPowerchains = siResult.findMember("powerchains");
-    if (siResulPowerchains == 0) {
-        errorMsg = TRANSLATE_ME("Internal error"); // reason
-        log_error("powerchains member creation failed");
-        return -5;
-    }
+    cxxtools::SerializationInfo & siResulPowerchains = siResult.addMember("powerchains");
+    siResulPowerchains.setCategory(cxxtools::SerializationInfo::Array);
 
-    // powerchains member is defined (array), loop on si_powerchains items...
-    // filter on dst-id == assetName, check src-id & src-socket,
-    // keep entries in siResulPowerchains
-    cxxtools::SerializationInfo::Iterator it;
-    for (it = si_powerchains->begin(); it != si_powerchains->end(); ++it) {
-        cxxtools::SerializationInfo *xsi = &(*it);
-        if (xsi == 0) continue; //
-
-        cxxtools::SerializationInfo *si_dstId = xsi->findMember("dst-id");
-        if (si_dstId == 0 || si_dstId->isNull())
-            { log_error("dst-id member is missing"); continue; }
-        std::string dstId;
-        si_dstId->getValue(dstId);
-        if (dstId != assetName) continue; // filtered
-
-        cxxtools::SerializationInfo *si_srcId, *si_srcSock;
-        si_srcId = xsi->findMember("src-id");
-        if (si_srcId == 0 || si_srcId->isNull())
-            { log_error("src-id member is missing"); continue; }
-        si_srcSock = xsi->findMember("src-socket");
-        if (si_srcSock == 0 || si_srcSock->isNull())
+    // filter on dst-id == assetName, keep entries with src-socket
+    for (const auto & link : topology.powerchains) {
+        if (link.dst_id != assetName) continue; // filtered
+        if (link.src_socket.empty())
             { log_error("src-socket member is missing"); continue; }
 
-        // keep that entry
-        siResulPowerchains->addMember("") <<= (*xsi);
+        cxxtools::SerializationInfo & xsi = siResulPowerchains.addMember("");
+        xsi.addMember("src-id") <<= link.src_id;
+        xsi.addMember("src-socket") <<= link.src_socket;
+        xsi.addMember("dst-id") <<= link.dst_id;
+        if (!link.dst_socket.empty())
+            xsi.addMember("dst-socket") <<= link.dst_socket;
     }
 
     // dump siResult to result
@@ -184,6 +308,14 @@ int topology_power_to (const std::string & assetName, std::string & result, std:
 // Returns 0 if success, else <0
 
 int topology_location_process (const std::string & command, const std::string & assetName, const std::string & options, std::string & result, std::string & errorMsg, bool beautify)
+{
+    return s_cached (s_key ("location", command, assetName, options, beautify), result, errorMsg,
+        [&] (std::string & out, std::string & reason) {
+            return s_topology_location_process (command, assetName, options, out, reason, beautify);
+        });
+}
+
+static int s_topology_location_process (const std::string & command, const std::string & assetName, const std::string & options, std::string & result, std::string & errorMsg, bool beautify)
 {
     result = "";
 
@@ -267,6 +399,14 @@ int topology_location_process (const std::string & command, const std::string &
 // Returns 0 if success, else <0
 
 int topology_input_powerchain_process (const std::string & assetName, std::string & result, std::string & errorMsg, bool beautify)
+{
+    return s_cached (s_key ("input_powerchain", "id", assetName, "", beautify), result, errorMsg,
+        [&] (std::string & out, std::string & reason) {
+            return s_topology_input_powerchain_process (assetName, out, reason, beautify);
+        });
+}
+
+static int s_topology_input_powerchain_process (const std::string & assetName, std::string & result, std::string & errorMsg, bool beautify)
 {
     result = "";
 
@@ -395,6 +535,65 @@ topology_processor_test (bool verbose)
     printf (" * topology_processor: \n");
 
     //  @selftest
+    // results are served from the cache until the topology changes
+    {
+        int computed = 0;
+        auto compute = [&computed] (std::string & result, std::string & errorMsg) {
+            computed++;
+            result = "{ \"computed\" : " + std::to_string (computed) + " }";
+            return 0;
+        };
+        auto failure = [] (std::string & result, std::string & errorMsg) {
+            errorMsg = "failed";
+            return -1;
+        };
+
+        uint64_t hits0, misses0;
+        size_t bytes;
+        topology_processor_cache_stats (hits0, misses0, bytes);
+
+        std::string result, errorMsg;
+        std::string key = s_key ("location", "from", "datacenter-3", "{\"recursive\" : true}", true);
+        assert (s_cached (key, result, errorMsg, compute) == 0 && computed == 1);
+        assert (s_cached (key, result, errorMsg, compute) == 0 && computed == 1);
+        assert (result == "{ \"computed\" : 1 }");
+
+        // beautify is part of the key
+        assert (s_key ("location", "from", "datacenter-3", "", true) != s_key ("location", "from", "datacenter-3", "", false));
+        assert (s_cached (s_key ("location", "from", "datacenter-3", "{\"recursive\" : true}", false), result, errorMsg, compute) == 0);
+        assert (computed == 2);
+
+        // failures are not cached
+        std::string failing = s_key ("power", "from", "ups-4", "", true);
+        assert (s_cached (failing, result, errorMsg, failure) == -1);
+        assert (s_cached (failing, result, errorMsg, compute) == 0 && computed == 3);
+
+        topology_processor_invalidate ();
+        assert (s_cached (key, result, errorMsg, compute) == 0 && computed == 4);
+        assert (result == "{ \"computed\" : 4 }");
+
+        uint64_t hits, misses;
+        topology_processor_cache_stats (hits, misses, bytes);
+        assert (hits - hits0 == 1 && misses - misses0 == 5);
+        assert (bytes == key.size () + result.size ());
+
+        // result computed before a change is dropped
+        uint64_t generation;
+        assert (!s_cache.lookup ("stale", result, generation));
+        topology_processor_invalidate ();
+        s_cache.insert ("stale", "{}", generation);
+        assert (!s_cache.lookup ("stale", result, generation));
+
+        // the least recently used results are dropped first
+        TopologyResultCache small (10);
+        small.insert ("a", "1234", 0);
+        small.insert ("b", "1234", 0);
+        assert (small.lookup ("a", result, generation));
+        small.insert ("c", "1234", 0);
+        assert (small.lookup ("a", result, generation));
+        assert (!small.lookup ("b", result, generation));
+        assert (small.lookup ("c", result, generation));
+    }
     //  @end
 
     printf ("topology_processor: OK\n");
@@ -76,6 +76,18 @@ FTY_ASSET_PRIVATE int
 FTY_ASSET_PRIVATE int
     topology_input_powerchain_process (const std::string & assetName, std::string & result, std::string & errorMsg, bool beautify = true);
 
+// Drop every cached TOPOLOGY result
+// To be called on any asset, link or location change
+
+FTY_ASSET_PRIVATE void
+    topology_processor_invalidate ();
+
+// Statistics of the TOPOLOGY results cache
+// HITS and MISSES count the requests, BYTES is the size of the cached results
+
+FTY_ASSET_PRIVATE void
+    topology_processor_cache_stats (uint64_t & hits, uint64_t & misses, size_t & bytes);
+
 //  Self test of this class
 
 FTY_ASSET_PRIVATE void
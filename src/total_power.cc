@@ -32,6 +32,9 @@
 #include <tntdb/result.h>
 #include <tntdb/error.h>
 #include <exception>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 class ShortAssetInfo {
 public:
@@ -84,33 +87,47 @@ static bool
     }
 }
 
+// source device id -> ids of the devices it powers
+typedef std::unordered_map<uint32_t, std::vector<uint32_t> > PowerDests;
+
 /**
- *  \brief For the specified asset it derives a set of powered devices
- *
- *  From set of links derives set of elements that at least once were
- *              in a role of a destination device in a link.
- *  Link is: from to
+ *  \brief Indexes the links of a container by their source
  *
  *  \param[in] links - information about all links, where at least one end
  *                          belongs to the devices in the container
+ *
+ *  \return for each source device, its powered devices
+ */
+static PowerDests
+    index_dests (
+        const std::set <std::pair<uint32_t, uint32_t> > &links
+    )
+{
+    PowerDests dests;
+    // links are unique, so are the destinations of a source
+    for ( auto &one_link: links )
+        dests [one_link.first].push_back (one_link.second);
+    return dests;
+}
+
+/**
+ *  \brief For the specified asset it derives a set of powered devices
+ *
+ *  \param[in] dests - links of the container indexed by source
  *  \param[in] element_id - powering device id
  *
- *  \return a set of powered devices. It can be empty.
+ *  \return the powered devices. It can be empty.
  */
-static std::set<uint32_t>
+static const std::vector<uint32_t> &
     find_dests (
-        const std::set <std::pair<uint32_t, uint32_t> > &links,
+        const PowerDests &dests,
         uint32_t element_id
     )
 {
-    std::set<uint32_t> dests;
+    static const std::vector<uint32_t> none;
 
-    for ( auto &one_link: links )
-    {
-        if ( one_link.first == element_id )
-            dests.insert(one_link.second);
-    }
-    return dests;
+    auto it = dests.find (element_id);
+    return it == dests.end () ? none : it->second;
 }
 /**
  *  \brief Checks if some power device is directly powering devices
@@ -119,8 +136,7 @@ static std::set<uint32_t>
  *  \param[in] device - device to check
  *  \param[in] devices_in_container - information about all devices in the
  *                          asset container
- *  \param[in] links - information about all links, where at least one end
- *                          belongs to the devices in the container
+ *  \param[in] dests - links of the container indexed by source
  *
  *  \return true or false
  */
@@ -128,10 +144,10 @@ static bool
     is_powering_other_rack (
         const ShortAssetInfo &device,
         const std::map <uint32_t, ShortAssetInfo> &devices_in_container,
-        const std::set <std::pair<uint32_t, uint32_t> > &links
+        const PowerDests &dests
     )
 {
-    auto adevice_dests = find_dests (links, device.asset_id);
+    const auto &adevice_dests = find_dests (dests, device.asset_id);
     for ( auto &adevice: adevice_dests )
     {
         auto it = devices_in_container.find(adevice);
@@ -153,21 +169,20 @@ static bool
  *
  *  \param[in] devices_in_container - information about all devices in the
  *                          asset container
- *  \param[in] links - information about all links, where at least one end
- *                          belongs to the devices in the container
+ *  \param[in] dests - links of the container indexed by source
  *  \param[in][out] border_devices - list of border devices to be updated
  */
 static void
     update_border_devices (
         const std::map <uint32_t, ShortAssetInfo> &container_devices,
-        const std::set <std::pair<uint32_t, uint32_t> > &links,
+        const PowerDests &dests,
         std::set <ShortAssetInfo> &border_devices
     )
 {
     std::set<ShortAssetInfo> new_border_devices;
     for ( auto &border_device: border_devices )
     {
-        auto adevice_dests = find_dests (links, border_device.asset_id);
+        const auto &adevice_dests = find_dests (dests, border_device.asset_id);
         for ( auto &adevice: adevice_dests )
         {
             auto it = container_devices.find(adevice);
@@ -262,13 +277,15 @@ static std::vector<std::string>
     if ( border_devices.empty() ) {
         return dvc;
     }
+    // built once, the chains are walked many times
+    PowerDests dests = index_dests (links);
     // it is not a good idea to delete from collection while iterating it
     std::set <ShortAssetInfo> todelete{};
     while ( !border_devices.empty() ) {
         for ( auto &border_device: border_devices ) {
             if ( ( is_epdu(border_device) ) ||
                  ( ( is_ups(border_device) ) &&
-                   ( !is_powering_other_rack (border_device, devices_in_container, links) ) ) )
+                   ( !is_powering_other_rack (border_device, devices_in_container, dests) ) ) )
             {
                 dvc.push_back(border_device.asset_name);
                 // remove from border
@@ -285,7 +302,7 @@ static std::vector<std::string>
         for (auto &todel: todelete) {
             border_devices.erase(todel);
         }
-        update_border_devices(devices_in_container, links, border_devices);
+        update_border_devices(devices_in_container, dests, border_devices);
     }
     return dvc;
 }
@@ -300,6 +317,9 @@ static std::vector<std::string>
  *                       used for total power computation.
  *                       It's content would be cleared every time
  *                       at the beginning.
+ *  \param[out] members - ids of all assets in the container and of all
+ *                       the ends of the selected links, a change of any
+ *                       of them can change the result
  *
  *  \return  0 - in case of success
  *          -1 - in case of internal error
@@ -309,16 +329,22 @@ static int
     select_total_power_by_id (
         tntdb::Connection &conn,
         uint32_t assetId,
-        std::vector<std::string> &powerDevices
+        std::vector<std::string> &powerDevices,
+        std::unordered_set<uint32_t> &members
     )
 {
     // at the beginning clear
     powerDevices.clear();
+    members.clear();
     // select all devices in the container
     std::map <uint32_t, ShortAssetInfo> container_devices{};
     std::function<void(const tntdb::Row&)> func = \
-                [&container_devices](const tntdb::Row& row)
+                [&container_devices, &members](const tntdb::Row& row)
                 {
+                    uint32_t member_id = 0;
+                    row["asset_id"].get(member_id);
+                    members.insert(member_id);
+
                     uint16_t type_id = 0;
                     row["type_id"].get(type_id);
 
@@ -383,10 +409,107 @@ static int
         return 0;
     }
 
+    for ( const auto &link : links ) {
+        members.insert (link.first);
+        members.insert (link.second);
+    }
+    powerDevices = total_power_v2 (container_devices, links);
+    return 0;
+}
+
+/**
+ *  \brief select_total_power_by_id answered by the resident topology model
+ *
+ *  Devices and links of the container are taken from its closure index,
+ *  without scanning all the assets.
+ *
+ *  \return  0 - in case of success
+ *          -2 - in case the requested asset was not found
+ */
+static int
+    select_total_power_from_graph (
+        const persist::TopologyGraph &graph,
+        uint32_t assetId,
+        std::vector<std::string> &powerDevices,
+        std::unordered_set<uint32_t> &members
+    )
+{
+    powerDevices.clear();
+    members.clear();
+
+    std::vector <persist::TopologyGraph::Node> nodes;
+    if ( graph.descendants (assetId, nodes) != 0 )
+        return -2;
+
+    std::map <uint32_t, ShortAssetInfo> container_devices{};
+    for ( const auto &n : nodes ) {
+        members.insert (n.id);
+        if ( n.typeId == persist::asset_type::DEVICE )
+            container_devices.emplace (n.id,
+                    ShortAssetInfo(n.id, n.iname, n.subtypeId));
+    }
+    if ( container_devices.empty() ) {
+        log_debug ("asset_id='%" PRIu32 "': has no devices", assetId);
+        return 0;
+    }
+
+    std::set <std::pair<uint32_t ,uint32_t> > links;
+    if ( graph.containerPowerLinks (assetId, links) != 0 )
+        return -2;
+    if ( links.empty() ) {
+        log_debug ("asset_id='%" PRIu32 "': has no power links", assetId);
+        return 0;
+    }
+
+    for ( const auto &link : links ) {
+        members.insert (link.first);
+        members.insert (link.second);
+    }
     powerDevices = total_power_v2 (container_devices, links);
     return 0;
 }
 
+/**
+ *  \brief Cached result of select_total_power_by_id
+ */
+struct TotalPowerCacheEntry {
+    uint32_t asset_id;
+    std::vector<std::string> powerDevices;
+    std::unordered_set<uint32_t> members;
+};
+
+// asset name -> total power devices, see total_power_invalidate
+static std::mutex s_cache_mutex;
+static std::unordered_map<std::string, TotalPowerCacheEntry> s_cache;
+// bumped on every invalidation, a result computed before is not cached
+static uint64_t s_cache_generation = 0;
+
+/**
+ *  \brief Drops the cached results depending on the changed assets
+ *
+ *  \param[in] changed - ids of the changed assets
+ *  \param[in] containers - ids of all the current parents of the changed assets
+ */
+static void
+    cache_drop (
+        const std::set<uint32_t> &changed,
+        const std::set<uint32_t> &containers
+    )
+{
+    for ( auto it = s_cache.begin (); it != s_cache.end (); ) {
+        bool drop = containers.count (it->second.asset_id) != 0;
+        for ( auto id : changed ) {
+            if ( drop )
+                break;
+            drop = ( it->second.asset_id == id ) || it->second.members.count (id) != 0;
+        }
+        if ( drop )
+            it = s_cache.erase (it);
+        else
+            ++it;
+    }
+}
+
 int
     select_devices_total_power(
         const std::string &assetName,
@@ -397,17 +520,348 @@ int
     if (test)
         return 0;
 
-    tntdb::Connection conn = tntdb::connectCached (DBConn::url);
-    int64_t assetId = DBAssets::name_to_asset_id (assetName);
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock (s_cache_mutex);
+        auto it = s_cache.find (assetName);
+        if ( it != s_cache.end () ) {
+            powerDevices = it->second.powerDevices;
+            return 0;
+        }
+        generation = s_cache_generation;
+    }
+
+    // computed without the lock, other requests are not blocked meanwhile
+    int64_t assetId = persist::topology_name_to_asset_id (assetName);
     if ( assetId < 0 ) {
         return assetId;
     }
-    return select_total_power_by_id (conn, assetId, powerDevices);
+    TotalPowerCacheEntry entry {static_cast<uint32_t> (assetId), {}, {}};
+    int r = 0;
+    persist::TopologyGraph &graph = persist::TopologyGraph::instance ();
+    if ( graph.ensureLoaded () )
+        r = select_total_power_from_graph (graph, assetId, entry.powerDevices, entry.members);
+    else {
+        tntdb::Connection conn = tntdb::connectCached (DBConn::url);
+        r = select_total_power_by_id (conn, assetId, entry.powerDevices, entry.members);
+    }
+    if ( r != 0 ) {
+        powerDevices.clear ();
+        return r;
+    }
+    powerDevices = entry.powerDevices;
+
+    std::lock_guard<std::mutex> lock (s_cache_mutex);
+    if ( generation == s_cache_generation )
+        s_cache.emplace (assetName, std::move (entry));
+    return 0;
+}
+
+/**
+ *  \brief Ids of the parents of an asset and of the sources of its links
+ *
+ *  \return 0 on success, -1 if the asset does not exist
+ */
+static int
+    select_parents_and_sources (
+        const std::string &assetName,
+        std::set<uint32_t> &containers,
+        std::set<uint32_t> &sources
+    )
+{
+    int64_t assetId = persist::topology_name_to_asset_id (assetName);
+    if ( assetId < 0 )
+        return -1;
+    sources.insert (static_cast<uint32_t> (assetId));
+
+    persist::TopologyGraph &graph = persist::TopologyGraph::instance ();
+    if ( graph.ensureLoaded () )
+        return graph.parentsAndSources (assetId, containers, sources) == 0 ? 0 : -1;
+
+    tntdb::Connection conn = tntdb::connectCached (DBConn::url);
+    tntdb::Statement st = conn.prepareCached (
+        " SELECT id_asset_device_src"
+        " FROM t_bios_asset_link"
+        " WHERE id_asset_device_dest = :id"
+    );
+    for ( const auto &row : st.set ("id", assetId).select () ) {
+        uint32_t src = 0;
+        row[0].get (src);
+        sources.insert (src);
+    }
+
+    // whole chain of parents in one go
+    st = conn.prepareCached (
+        " WITH RECURSIVE parents (id) AS ( "
+        "     SELECT id_parent FROM t_bios_asset_element "
+        "     WHERE id_asset_element = :id AND id_parent IS NOT NULL "
+        "   UNION "
+        "     SELECT e.id_parent FROM t_bios_asset_element AS e "
+        "     INNER JOIN parents AS p ON e.id_asset_element = p.id "
+        "     WHERE e.id_parent IS NOT NULL "
+        " ) "
+        " SELECT id FROM parents"
+    );
+    for ( const auto &row : st.set ("id", assetId).select () ) {
+        uint32_t parent_id = 0;
+        row[0].get (parent_id);
+        containers.insert (parent_id);
+    }
+    return 0;
+}
+
+void
+    total_power_invalidate(
+        const std::string &assetName
+    )
+{
+    {
+        std::lock_guard<std::mutex> lock (s_cache_mutex);
+        ++s_cache_generation;
+        if ( s_cache.empty () )
+            return;
+    }
+
+    // new links of the asset can make its power sources power some other
+    // container and the asset can be placed into a new container
+    std::set<uint32_t> changed;
+    std::set<uint32_t> containers;
+    int r = -1;
+    try {
+        r = select_parents_and_sources (assetName, containers, changed);
+        if ( r != 0 ) {
+            // deleted asset, its id is not known anymore
+            log_debug ("total power cache: '%s' not found, drop all", assetName.c_str ());
+        }
+    }
+    catch (const std::exception &e) {
+        log_error ("total power cache: cannot invalidate '%s': %s, drop all",
+                assetName.c_str (), e.what ());
+    }
+
+    std::lock_guard<std::mutex> lock (s_cache_mutex);
+    if ( r == 0 )
+        cache_drop (changed, containers);
+    else
+        s_cache.clear ();
+}
+
+/**
+ *  \brief Location and type of one asset, as needed by the bulk selection
+ */
+struct TotalPowerAsset {
+    uint32_t asset_id;
+    std::string asset_name;
+    uint16_t type_id;
+    uint16_t subtype_id;
+    uint32_t parent_id;
+};
+
+static bool
+    is_container (
+        uint16_t type_id
+    )
+{
+    return ( type_id == persist::asset_type::DATACENTER ) ||
+           ( type_id == persist::asset_type::ROOM ) ||
+           ( type_id == persist::asset_type::ROW ) ||
+           ( type_id == persist::asset_type::RACK );
+}
+
+/**
+ *  \brief Computes the total power devices for every container at once.
+ *
+ *  Devices of the containers are collected bottom-up over the location
+ *  tree, so every asset is visited once. Every container is then evaluated
+ *  with the links that have at least one end among its devices, the same
+ *  input select_total_power_by_id gets from the database.
+ *
+ *  \param[in] assets - all assets with their parents
+ *  \param[in] links - all power links
+ *
+ *  \return container name -> list of power devices names
+ */
+static std::map<std::string, std::vector<std::string>>
+    total_power_all (
+        const std::vector <TotalPowerAsset> &assets,
+        const std::set <std::pair<uint32_t, uint32_t> > &links
+    )
+{
+    std::unordered_map <uint32_t, const TotalPowerAsset*> by_id;
+    for ( const auto &asset : assets )
+        by_id.emplace (asset.asset_id, &asset);
+
+    std::unordered_map <uint32_t, std::vector<uint32_t>> children;
+    std::vector <uint32_t> order;
+    order.reserve (assets.size ());
+    for ( const auto &asset : assets ) {
+        if ( asset.parent_id != 0 && by_id.count (asset.parent_id) )
+            children[asset.parent_id].push_back (asset.asset_id);
+        else
+            order.push_back (asset.asset_id);
+    }
+    // top-down order, parents always precede their children
+    for ( size_t i = 0; i < order.size (); i++ ) {
+        auto it = children.find (order[i]);
+        if ( it != children.end () )
+            order.insert (order.end (), it->second.begin (), it->second.end ());
+    }
+
+    // devices placed anywhere under the asset, children first
+    std::unordered_map <uint32_t, std::vector<uint32_t>> subtree_devices;
+    for ( auto it = order.rbegin (); it != order.rend (); ++it ) {
+        auto chit = children.find (*it);
+        if ( chit == children.end () )
+            continue;
+        std::vector<uint32_t> &devices = subtree_devices[*it];
+        for ( uint32_t child : chit->second ) {
+            if ( by_id[child]->type_id == persist::asset_type::DEVICE )
+                devices.push_back (child);
+            auto dit = subtree_devices.find (child);
+            if ( dit != subtree_devices.end () )
+                devices.insert (devices.end (), dit->second.begin (), dit->second.end ());
+        }
+    }
+
+    // links touching every device
+    std::unordered_map <uint32_t, std::vector<const std::pair<uint32_t, uint32_t>*>> device_links;
+    for ( const auto &link : links ) {
+        device_links[link.first].push_back (&link);
+        if ( link.second != link.first )
+            device_links[link.second].push_back (&link);
+    }
+
+    std::map<std::string, std::vector<std::string>> result;
+    for ( const auto &asset : assets ) {
+        if ( !is_container (asset.type_id) )
+            continue;
+        std::vector<std::string> &powerDevices = result[asset.asset_name];
+
+        auto dit = subtree_devices.find (asset.asset_id);
+        if ( dit == subtree_devices.end () || dit->second.empty () )
+            continue;
+
+        std::map <uint32_t, ShortAssetInfo> container_devices{};
+        std::set <std::pair<uint32_t ,uint32_t> > container_links{};
+        for ( uint32_t device_id : dit->second ) {
+            const TotalPowerAsset *device = by_id[device_id];
+            container_devices.emplace (device_id,
+                    ShortAssetInfo(device_id, device->asset_name,
+                        device->subtype_id));
+            auto lit = device_links.find (device_id);
+            if ( lit == device_links.end () )
+                continue;
+            for ( const auto *link : lit->second )
+                container_links.insert (*link);
+        }
+        if ( container_links.empty() )
+            continue;
+
+        powerDevices = total_power_v2 (container_devices, container_links);
+    }
+    return result;
+}
+
+int
+    select_devices_total_power_all(
+        std::map<std::string, std::vector<std::string>> &powerDevices,
+        bool test
+    )
+{
+    // at the beginning clear
+    powerDevices.clear();
+    if (test)
+        return 0;
+
+    std::vector <TotalPowerAsset> assets;
+    std::set <std::pair<uint32_t ,uint32_t> > links;
+    try {
+        tntdb::Connection conn = tntdb::connectCached (DBConn::url);
+        tntdb::Statement st = conn.prepareCached (
+            " SELECT id_asset_element, name, id_type, id_subtype, id_parent"
+            " FROM t_bios_asset_element"
+        );
+        for ( const auto &row : st.select () ) {
+            TotalPowerAsset asset {0, "", 0, 0, 0};
+            row[0].get (asset.asset_id);
+            row[1].get (asset.asset_name);
+            row[2].get (asset.type_id);
+            row[3].get (asset.subtype_id);
+            row[4].get (asset.parent_id);
+            assets.push_back (asset);
+        }
+
+        st = conn.prepareCached (
+            " SELECT id_asset_device_src, id_asset_device_dest"
+            " FROM t_bios_asset_link"
+            " WHERE id_asset_link_type = :linktype"
+        );
+        for ( const auto &row : st.set ("linktype", INPUT_POWER_CHAIN).select () ) {
+            uint32_t src = 0, dest = 0;
+            row[0].get (src);
+            row[1].get (dest);
+            links.emplace (src, dest);
+        }
+    }
+    catch (const std::exception &e) {
+        log_error ("problems appeared in selecting devices and links: %s", e.what ());
+        return -1;
+    }
+
+    powerDevices = total_power_all (assets, links);
+    return 0;
 }
 
 void
 total_power_test (bool verbose)
 {
     printf (" * total_power: ");
+
+    //  @selftest
+    // DC <- ROW <- RACK1 <- { ups1, epdu1 }, ups1 -> epdu1
+    //           <- RACK2 <- { epdu2 }, ups1 -> epdu2
+    {
+        std::vector <TotalPowerAsset> assets {
+            { 1, "datacenter-1", persist::asset_type::DATACENTER, 0, 0 },
+            { 2, "row-2", persist::asset_type::ROW, 0, 1 },
+            { 3, "rack-3", persist::asset_type::RACK, 0, 2 },
+            { 4, "rack-4", persist::asset_type::RACK, 0, 2 },
+            { 5, "ups-5", persist::asset_type::DEVICE, persist::asset_subtype::UPS, 3 },
+            { 6, "epdu-6", persist::asset_type::DEVICE, persist::asset_subtype::EPDU, 3 },
+            { 7, "epdu-7", persist::asset_type::DEVICE, persist::asset_subtype::EPDU, 4 },
+        };
+        std::set <std::pair<uint32_t, uint32_t> > links { {5, 6}, {5, 7} };
+
+        auto result = total_power_all (assets, links);
+        assert ( result.size () == 4 );
+        // ups powers the other rack, so take its epdu
+        assert ( result["rack-3"] == std::vector<std::string> {"epdu-6"} );
+        assert ( result["rack-4"] == std::vector<std::string> {"epdu-7"} );
+        assert ( result["row-2"] == std::vector<std::string> {"ups-5"} );
+        assert ( result["datacenter-1"] == std::vector<std::string> {"ups-5"} );
+    }
+
+    // cached results are dropped only when they depend on the change
+    {
+        s_cache.clear ();
+        s_cache["rack-3"] = TotalPowerCacheEntry {3, {"epdu-6"}, {5, 6, 7}};
+        s_cache["rack-4"] = TotalPowerCacheEntry {4, {"epdu-7"}, {5, 7}};
+        s_cache["row-2"] = TotalPowerCacheEntry {2, {"ups-5"}, {3, 4, 5, 6, 7}};
+        s_cache["rack-8"] = TotalPowerCacheEntry {8, {}, {}};
+
+        // epdu-6 updated in rack-3
+        cache_drop ({6}, {3, 2, 1});
+        assert ( s_cache.size () == 2 );
+        assert ( s_cache.count ("rack-4") == 1 );
+        assert ( s_cache.count ("rack-8") == 1 );
+
+        // new device in rack-8
+        cache_drop ({9}, {8, 2, 1});
+        assert ( s_cache.size () == 1 );
+        assert ( s_cache.count ("rack-4") == 1 );
+        s_cache.clear ();
+    }
+    //  @end
+
     printf ("OK\n");
 }
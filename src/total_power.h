@@ -22,6 +22,7 @@
 #ifndef TOTAL_POWER_H_INCLUDED
 #define TOTAL_POWER_H_INCLUDED
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -36,12 +37,13 @@
  *                      It's content would be cleared every time
  *                      at the beginning.
  *
+ * Results are cached until total_power_invalidate is called for
+ * an asset they depend on.
+ *
  * \return  0 - in case of success
  *         -1 - in case of internal error
  *         -2 - in case the requested asset was not found
  */
-//  Self test of this class
-
 FTY_ASSET_PRIVATE int
     select_devices_total_power(
         const std::string &assetName,
@@ -49,6 +51,42 @@ FTY_ASSET_PRIVATE int
         bool test
     );
 
+/*
+ * \brief Drops the cached results of select_devices_total_power that
+ *        can be changed by a change of the specified asset
+ *
+ * Must be called whenever an asset or its power links are created,
+ * updated or deleted.
+ *
+ * \param[in] assetName - name of the changed asset
+ */
+FTY_ASSET_PRIVATE void
+    total_power_invalidate(
+        const std::string &assetName
+    );
+
+/*
+ * \brief For every container (datacenter, room, row, rack) finds out
+ *        the devices that are used for total power computation
+ *
+ * All devices and power links are selected only once.
+ *
+ * \param[out] powerDevices - container name -> list of devices
+ *                      used for total power computation.
+ *                      It's content would be cleared every time
+ *                      at the beginning.
+ *
+ * \return  0 - in case of success
+ *         -1 - in case of internal error
+ */
+FTY_ASSET_PRIVATE int
+    select_devices_total_power_all(
+        std::map<std::string, std::vector<std::string>> &powerDevices,
+        bool test
+    );
+
+//  Self test of this class
+
 FTY_ASSET_PRIVATE void
     total_power_test (bool verbose);
 